@@ -15,6 +15,8 @@
 
 #include "extensions/common/context.h"
 
+#include <cstring>
+
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "extensions/common/util.h"
@@ -26,16 +28,16 @@
 
 #else  // NULL_PLUGIN
 
-#include "absl/strings/str_split.h"
 #include "extensions/common/wasm/null/null_plugin.h"
 
 using Envoy::Extensions::Common::Wasm::HeaderMapType;
 using Envoy::Extensions::Common::Wasm::WasmResult;
 using Envoy::Extensions::Common::Wasm::Null::Plugin::getCurrentTimeNanoseconds;
 using Envoy::Extensions::Common::Wasm::Null::Plugin::getHeaderMapValue;
-using Envoy::Extensions::Common::Wasm::Null::Plugin::getStringValue;
 using Envoy::Extensions::Common::Wasm::Null::Plugin::getStructValue;
 using Envoy::Extensions::Common::Wasm::Null::Plugin::getValue;
+using Envoy::Extensions::Common::Wasm::Null::Plugin::proxy_get_property;
+using Envoy::Extensions::Common::Wasm::Null::Plugin::WasmData;
 
 #endif  // NULL_PLUGIN
 
@@ -44,32 +46,120 @@ using Envoy::Extensions::Common::Wasm::Null::Plugin::getValue;
 namespace Wasm {
 namespace Common {
 
-const char kRbacFilterName[] = "envoy.filters.http.rbac";
-const char kRbacPermissivePolicyIDField[] = "shadow_effective_policy_id";
-const char kRbacPermissiveEngineResultField[] = "shadow_engine_result";
+constexpr StringView kRbacFilterName = "envoy.filters.http.rbac";
+constexpr StringView kRbacPermissivePolicyIDField =
+    "shadow_effective_policy_id";
+constexpr StringView kRbacPermissiveEngineResultField = "shadow_engine_result";
 
 namespace {
 
-// Extract fqdn from Istio cluster name, e.g.
-// inbound|9080|http|productpage.default.svc.cluster.local. If cluster name does
-// not follow Istio convention, fqdn will be left as empty string.
-void extractFqdn(const std::string& cluster_name, std::string* fqdn) {
-  const std::vector<std::string>& parts = absl::StrSplit(cluster_name, '|');
-  if (parts.size() == 4) {
-    *fqdn = parts[3];
-  }
+// Fetches the raw bytes of a property with one proxy_get_property call. The
+// bytes are handed to a WasmData on the caller's stack. Returns false if the
+// property is not found.
+bool getPropertyData(const PropertyPath& path, const char** value_ptr,
+                     size_t* value_size) {
+  const auto encoded = path.encoded();
+  return proxy_get_property(encoded.data(), encoded.size(), value_ptr,
+                            value_size) == WasmResult::Ok;
 }
 
-// Extract service name from service fqdn.
-void extractServiceName(const std::string& fqdn, std::string* service_name) {
-  const std::vector<std::string>& parts = absl::StrSplit(fqdn, '.');
-  if (parts.size() > 0) {
-    *service_name = parts[0];
+template <typename T>
+bool getFixedSizeProperty(const PropertyPath& path, T* out) {
+  const char* value_ptr = nullptr;
+  size_t value_size = 0;
+  if (!getPropertyData(path, &value_ptr, &value_size)) {
+    return false;
+  }
+  WasmData data(value_ptr, value_size);
+  if (data.size() != sizeof(T)) {
+    return false;
   }
+  // The host buffer carries no alignment guarantee for T.
+  memcpy(out, data.data(), sizeof(T));
+  return true;
+}
+
+// Host properties read by populateHTTPRequestInfo. Paths are encoded once and
+// shared by all requests.
+struct HTTPRequestProperties {
+  const PropertyPath response_code{"response", "code"};
+  const PropertyPath response_flags{"response", "flags"};
+  const PropertyPath cluster_name{"cluster_name"};
+  const PropertyPath rbac_permissive_policy_id{
+      "metadata", kRbacFilterName, kRbacPermissivePolicyIDField};
+  const PropertyPath rbac_permissive_engine_result{
+      "metadata", kRbacFilterName, kRbacPermissiveEngineResultField};
+  const PropertyPath url_path{"request", "url_path"};
+  const PropertyPath upstream_port{"upstream", "port"};
+  const PropertyPath upstream_peer_principal{"upstream",
+                                             "uri_san_peer_certificate"};
+  const PropertyPath upstream_local_principal{"upstream",
+                                              "uri_san_local_certificate"};
+  const PropertyPath destination_port{"destination", "port"};
+  const PropertyPath connection_mtls{"connection", "mtls"};
+  const PropertyPath connection_local_principal{"connection",
+                                                "uri_san_local_certificate"};
+  const PropertyPath connection_peer_principal{"connection",
+                                               "uri_san_peer_certificate"};
+};
+
+const HTTPRequestProperties& httpRequestProperties() {
+  static const auto* properties = new HTTPRequestProperties();
+  return *properties;
 }
 
 }  // namespace
 
+PropertyPath::PropertyPath(std::initializer_list<StringView> parts) {
+  size_t size = 0;
+  for (const auto& part : parts) {
+    size += part.size() + 1;
+  }
+  encoded_.reserve(size);
+  for (const auto& part : parts) {
+    encoded_.append(part.data(), part.size());
+    encoded_.push_back('\0');
+  }
+}
+
+bool getStringProperty(const PropertyPath& path, std::string* out) {
+  const char* value_ptr = nullptr;
+  size_t value_size = 0;
+  if (!getPropertyData(path, &value_ptr, &value_size)) {
+    return false;
+  }
+  WasmData data(value_ptr, value_size);
+  out->assign(data.data(), data.size());
+  return true;
+}
+
+bool getIntProperty(const PropertyPath& path, int64_t* out) {
+  return getFixedSizeProperty(path, out);
+}
+
+bool getBoolProperty(const PropertyPath& path, bool* out) {
+  return getFixedSizeProperty(path, out);
+}
+
+StringView extractFqdn(StringView cluster_name) {
+  size_t separators = 0;
+  size_t last_separator = StringView::npos;
+  for (size_t i = 0; i < cluster_name.size(); i++) {
+    if (cluster_name[i] == '|') {
+      separators++;
+      last_separator = i;
+    }
+  }
+  if (separators != 3) {
+    return {};
+  }
+  return cluster_name.substr(last_separator + 1);
+}
+
+StringView extractServiceName(StringView fqdn) {
+  return fqdn.substr(0, fqdn.find('.'));
+}
+
 StringView AuthenticationPolicyString(ServiceAuthenticationPolicy policy) {
   switch (policy) {
     case ServiceAuthenticationPolicy::None:
@@ -161,9 +251,11 @@ void populateHTTPRequestInfo(bool outbound, bool use_host_header_fallback,
   // TODO: switch to stream_info.requestComplete() to avoid extra compute.
   request_info->end_timestamp = getCurrentTimeNanoseconds();
 
+  const auto& properties = httpRequestProperties();
+
   // Fill in request info.
   int64_t response_code = 0;
-  if (getValue({"response", "code"}, &response_code)) {
+  if (getIntProperty(properties.response_code, &response_code)) {
     request_info->response_code = response_code;
   }
 
@@ -180,12 +272,14 @@ void populateHTTPRequestInfo(bool outbound, bool use_host_header_fallback,
   // Try to get fqdn of destination service from cluster name. If not found, use
   // host header instead.
   std::string cluster_name = "";
-  getStringValue({"cluster_name"}, &cluster_name);
-  extractFqdn(cluster_name, &request_info->destination_service_host);
-  if (!request_info->destination_service_host.empty()) {
+  getStringProperty(properties.cluster_name, &cluster_name);
+  const auto fqdn = extractFqdn(cluster_name);
+  if (!fqdn.empty()) {
     // cluster name follows Istio convention, so extract out service name.
-    extractServiceName(request_info->destination_service_host,
-                       &request_info->destination_service_name);
+    request_info->destination_service_host.assign(fqdn.data(), fqdn.size());
+    const auto service_name = extractServiceName(fqdn);
+    request_info->destination_service_name.assign(service_name.data(),
+                                                  service_name.size());
   } else if (use_host_header_fallback) {
     // fallback to host header if requested.
     request_info->destination_service_host =
@@ -195,44 +289,44 @@ void populateHTTPRequestInfo(bool outbound, bool use_host_header_fallback,
   }
 
   // Get rbac labels from dynamic metadata.
-  getStringValue({"metadata", kRbacFilterName, kRbacPermissivePolicyIDField},
-                 &request_info->rbac_permissive_policy_id);
-  getStringValue(
-      {"metadata", kRbacFilterName, kRbacPermissiveEngineResultField},
-      &request_info->rbac_permissive_engine_result);
+  getStringProperty(properties.rbac_permissive_policy_id,
+                    &request_info->rbac_permissive_policy_id);
+  getStringProperty(properties.rbac_permissive_engine_result,
+                    &request_info->rbac_permissive_engine_result);
 
   request_info->request_operation =
       getHeaderMapValue(HeaderMapType::RequestHeaders, kMethodHeaderKey)
           ->toString();
 
-  getStringValue({"request", "url_path"}, &request_info->request_url_path);
+  getStringProperty(properties.url_path, &request_info->request_url_path);
 
   int64_t destination_port = 0;
 
   if (outbound) {
-    getValue({"upstream", "port"}, &destination_port);
-    getStringValue({"upstream", "uri_san_peer_certificate"},
-                   &request_info->destination_principal);
-    getStringValue({"upstream", "uri_san_local_certificate"},
-                   &request_info->source_principal);
+    getIntProperty(properties.upstream_port, &destination_port);
+    getStringProperty(properties.upstream_peer_principal,
+                      &request_info->destination_principal);
+    getStringProperty(properties.upstream_local_principal,
+                      &request_info->source_principal);
   } else {
-    getValue({"destination", "port"}, &destination_port);
+    getIntProperty(properties.destination_port, &destination_port);
     bool mtls = false;
-    if (getValue({"connection", "mtls"}, &mtls)) {
+    if (getBoolProperty(properties.connection_mtls, &mtls)) {
       request_info->service_auth_policy =
           mtls ? ::Wasm::Common::ServiceAuthenticationPolicy::MutualTLS
                : ::Wasm::Common::ServiceAuthenticationPolicy::None;
     }
-    getStringValue({"connection", "uri_san_local_certificate"},
-                   &request_info->destination_principal);
-    getStringValue({"connection", "uri_san_peer_certificate"},
-                   &request_info->source_principal);
+    getStringProperty(properties.connection_local_principal,
+                      &request_info->destination_principal);
+    getStringProperty(properties.connection_peer_principal,
+                      &request_info->source_principal);
   }
   request_info->destination_port = destination_port;
 
-  uint64_t response_flags = 0;
-  getValue({"response", "flags"}, &response_flags);
-  request_info->response_flag = parseResponseFlag(response_flags);
+  int64_t response_flags = 0;
+  getIntProperty(properties.response_flags, &response_flags);
+  request_info->response_flag =
+      parseResponseFlag(static_cast<uint64_t>(response_flags));
 }
 
 google::protobuf::util::Status extractNodeMetadataValue(
@@ -257,10 +351,12 @@ google::protobuf::util::Status extractNodeMetadataValue(
         "metadata exchange key is not a string");
   }
 
-  // select keys from the metadata using the keys
-  const std::set<std::string> keys =
-      absl::StrSplit(keys_value.string_value(), ',', absl::SkipWhitespace());
-  for (auto key : keys) {
+  // select keys from the metadata using the keys. The split is lazy, so no
+  // intermediate container is built; duplicated keys overwrite the same entry.
+  std::string key;
+  for (StringView key_view :
+       absl::StrSplit(keys_value.string_value(), ',', absl::SkipWhitespace())) {
+    key.assign(key_view.data(), key_view.size());
     const auto entry_it = node_metadata.fields().find(key);
     if (entry_it == node_metadata.fields().end()) {
       continue;
@@ -15,7 +15,9 @@
 
 #pragma once
 
+#include <initializer_list>
 #include <set>
+#include <string>
 
 #include "absl/strings/string_view.h"
 #include "extensions/common/node_info.pb.h"
@@ -148,11 +150,41 @@ google::protobuf::util::Status extractNodeMetadataGeneric(
 google::protobuf::util::Status extractLocalNodeMetadata(
     wasm::common::NodeInfo* node_info);
 
+// PropertyPath is a host property path pre-encoded in the null-separated form
+// expected by proxy_get_property. Paths that are read on every request should
+// be built once, so that each read does not re-encode (and allocate) the path.
+class PropertyPath {
+ public:
+  PropertyPath(std::initializer_list<StringView> parts);
+
+  StringView encoded() const { return encoded_; }
+
+ private:
+  std::string encoded_;
+};
+
+// Fetches properties from the host with pre-encoded paths. Both return false if
+// the property is not found or has an unexpected size.
+bool getStringProperty(const PropertyPath& path, std::string* out);
+bool getIntProperty(const PropertyPath& path, int64_t* out);
+bool getBoolProperty(const PropertyPath& path, bool* out);
+
 // populateHTTPRequestInfo populates the RequestInfo struct. It needs access to
-// the request context.
+// the request context. Each property is still one host call; their paths are
+// encoded once per process rather than on every request.
 void populateHTTPRequestInfo(bool outbound, bool use_host_header,
                              RequestInfo* request_info);
 
+// Extracts fqdn from Istio cluster name, e.g.
+// inbound|9080|http|productpage.default.svc.cluster.local. Returns an empty
+// view if the cluster name does not follow Istio convention. The result points
+// into cluster_name.
+StringView extractFqdn(StringView cluster_name);
+
+// Extracts service name, i.e. the first DNS label, from service fqdn. The
+// result points into fqdn.
+StringView extractServiceName(StringView fqdn);
+
 // Extracts node metadata value. It looks for values of all the keys
 // corresponding to EXCHANGE_KEYS in node_metadata and populates it in
 // google::protobuf::Value pointer that is passed in.
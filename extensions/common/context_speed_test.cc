@@ -13,9 +13,21 @@
  * limitations under the License.
  */
 
+#include <cstring>
+#include <unordered_map>
+
 #include "benchmark/benchmark.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/stats/isolated_store_impl.h"
 #include "extensions/common/context.h"
+#include "extensions/common/util.h"
+#include "extensions/common/wasm/null/null.h"
+#include "extensions/common/wasm/null/null_plugin.h"
+#include "extensions/common/wasm/wasm.h"
 #include "google/protobuf/util/json_util.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
 
 // WASM_PROLOG
 #ifdef NULL_PLUGIN
@@ -103,6 +115,255 @@ static void BM_MessageParser(benchmark::State& state) {
 }
 BENCHMARK(BM_MessageParser);
 
+static void BM_ExtractServiceName(benchmark::State& state) {
+  const std::string cluster_name =
+      "outbound|9080|http|productpage.default.svc.cluster.local";
+  for (auto _ : state) {
+    auto fqdn = extractFqdn(cluster_name);
+    benchmark::DoNotOptimize(fqdn);
+    auto service_name = extractServiceName(fqdn);
+    benchmark::DoNotOptimize(service_name);
+  }
+}
+BENCHMARK(BM_ExtractServiceName);
+
+static void BM_ExtractNodeMetadataValue(benchmark::State& state) {
+  google::protobuf::Struct metadata_struct;
+  JsonParseOptions json_parse_options;
+  JsonStringToMessage(std::string(node_metadata_json), &metadata_struct,
+                      json_parse_options);
+  (*metadata_struct.mutable_fields())["EXCHANGE_KEYS"].set_string_value(
+      "NAME,NAMESPACE,LABELS,OWNER,WORKLOAD_NAME,PLATFORM_METADATA,"
+      "ISTIO_VERSION,MESH_ID");
+
+  for (auto _ : state) {
+    google::protobuf::Struct metadata;
+    extractNodeMetadataValue(metadata_struct, &metadata);
+    benchmark::DoNotOptimize(metadata);
+  }
+}
+BENCHMARK(BM_ExtractNodeMetadataValue);
+
+namespace {
+
+namespace HostWasm = Envoy::Extensions::Common::Wasm;
+
+constexpr char kNullVmPluginName[] = "envoy.wasm.context_speed_test";
+
+// The null VM has to load a plugin before the host can copy property values
+// into it; an empty root registry is enough for that.
+class SpeedTestPluginFactory : public HostWasm::Null::NullVmPluginFactory {
+ public:
+  const std::string name() const override { return kNullVmPluginName; }
+  std::unique_ptr<HostWasm::Null::NullVmPlugin> create() const override {
+    static auto* registry = new HostWasm::Null::NullPluginRootRegistry();
+    return std::make_unique<HostWasm::Null::NullPlugin>(registry);
+  }
+};
+
+Envoy::Registry::RegisterFactory<SpeedTestPluginFactory,
+                                 HostWasm::Null::NullVmPluginFactory>
+    register_;
+
+// Serves the properties and headers of an inbound mTLS gRPC request from
+// memory, so populateHTTPRequestInfo goes through the real host calls
+// without a live stream.
+class RequestContext : public HostWasm::Context {
+ public:
+  explicit RequestContext(HostWasm::Wasm* wasm) : HostWasm::Context(wasm) {
+    setInt({"response", "code"}, 200);
+    setInt({"response", "flags"}, 0);
+    setInt({"destination", "port"}, 9080);
+    setString({"cluster_name"},
+              "inbound|9080|http|productpage.default.svc.cluster.local");
+    setString({"request", "url_path"}, "/productpage");
+    setString({"connection", "uri_san_local_certificate"},
+              "spiffe://cluster.local/ns/default/sa/bookinfo-productpage");
+    setString({"connection", "uri_san_peer_certificate"},
+              "spiffe://cluster.local/ns/istio-system/sa/ingressgateway");
+    properties_[std::string(PropertyPath{"connection", "mtls"}.encoded())] =
+        std::string(1, '\x01');
+
+    headers_[":authority"] = "productpage:9080";
+    headers_[":method"] = "GET";
+    headers_["content-type"] = "application/grpc";
+  }
+
+  HostWasm::WasmResult getProperty(absl::string_view path,
+                                   std::string* result) override {
+    const auto it = properties_.find(std::string(path));
+    if (it == properties_.end()) {
+      return HostWasm::WasmResult::NotFound;
+    }
+    *result = it->second;
+    return HostWasm::WasmResult::Ok;
+  }
+
+  absl::string_view getHeaderMapValue(HostWasm::HeaderMapType,
+                                      absl::string_view key) override {
+    const auto it = headers_.find(std::string(key));
+    if (it == headers_.end()) {
+      return {};
+    }
+    return it->second;
+  }
+
+ private:
+  void setInt(std::initializer_list<StringView> parts, int64_t value) {
+    std::string bytes(sizeof(value), '\0');
+    memcpy(&bytes[0], &value, sizeof(value));
+    properties_[std::string(PropertyPath(parts).encoded())] = bytes;
+  }
+
+  void setString(std::initializer_list<StringView> parts, StringView value) {
+    properties_[std::string(PropertyPath(parts).encoded())] =
+        std::string(value);
+  }
+
+  std::unordered_map<std::string, std::string> properties_;
+  std::unordered_map<std::string, std::string> headers_;
+};
+
+// Sets up a null VM whose current context serves an inbound request.
+class PopulateHTTPRequestInfoFixture {
+ public:
+  PopulateHTTPRequestInfoFixture()
+      : api_(Envoy::Api::createApiForTest(stats_store_)),
+        dispatcher_(api_->allocateDispatcher()),
+        plugin_(std::make_shared<HostWasm::Plugin>(
+            "", "", "", envoy::api::v2::core::TrafficDirection::INBOUND,
+            local_info_, nullptr)),
+        wasm_(std::make_shared<HostWasm::Wasm>(
+            "envoy.wasm.runtime.null", "", "", plugin_,
+            Envoy::Stats::ScopeSharedPtr(stats_store_.createScope("wasm.")),
+            cluster_manager_, *dispatcher_)) {
+    wasm_->initialize(kNullVmPluginName, false);
+    context_ = std::make_unique<RequestContext>(wasm_.get());
+  }
+
+  RequestContext* context() { return context_.get(); }
+
+ private:
+  Envoy::Stats::IsolatedStoreImpl stats_store_;
+  Envoy::Api::ApiPtr api_;
+  Envoy::Event::DispatcherPtr dispatcher_;
+  testing::NiceMock<Envoy::Upstream::MockClusterManager> cluster_manager_;
+  testing::NiceMock<Envoy::LocalInfo::MockLocalInfo> local_info_;
+  std::shared_ptr<HostWasm::Plugin> plugin_;
+  std::shared_ptr<HostWasm::Wasm> wasm_;
+  std::unique_ptr<RequestContext> context_;
+};
+
+// populateHTTPRequestInfo as it was before property paths were pre-encoded:
+// every read builds its path from a list of parts and copies the value out of
+// a heap-allocated WasmData.
+void populateHTTPRequestInfoBaseline(bool outbound,
+                                     bool use_host_header_fallback,
+                                     RequestInfo* request_info) {
+  using HostWasm::HeaderMapType;
+  using HostWasm::Null::Plugin::getCurrentTimeNanoseconds;
+  using HostWasm::Null::Plugin::getHeaderMapValue;
+  using HostWasm::Null::Plugin::getStringValue;
+  using HostWasm::Null::Plugin::getValue;
+
+  request_info->end_timestamp = getCurrentTimeNanoseconds();
+
+  int64_t response_code = 0;
+  if (getValue({"response", "code"}, &response_code)) {
+    request_info->response_code = response_code;
+  }
+
+  if (kGrpcContentTypes.count(getHeaderMapValue(HeaderMapType::RequestHeaders,
+                                                kContentTypeHeaderKey)
+                                  ->toString()) != 0) {
+    request_info->request_protocol = kProtocolGRPC;
+  } else {
+    request_info->request_protocol = kProtocolHTTP;
+  }
+
+  std::string cluster_name = "";
+  getStringValue({"cluster_name"}, &cluster_name);
+  const auto fqdn = extractFqdn(cluster_name);
+  if (!fqdn.empty()) {
+    request_info->destination_service_host.assign(fqdn.data(), fqdn.size());
+    const auto service_name = extractServiceName(fqdn);
+    request_info->destination_service_name.assign(service_name.data(),
+                                                  service_name.size());
+  } else if (use_host_header_fallback) {
+    request_info->destination_service_host =
+        getHeaderMapValue(HeaderMapType::RequestHeaders, kAuthorityHeaderKey)
+            ->toString();
+  }
+
+  getStringValue({"metadata", "envoy.filters.http.rbac",
+                  "shadow_effective_policy_id"},
+                 &request_info->rbac_permissive_policy_id);
+  getStringValue(
+      {"metadata", "envoy.filters.http.rbac", "shadow_engine_result"},
+      &request_info->rbac_permissive_engine_result);
+
+  request_info->request_operation =
+      getHeaderMapValue(HeaderMapType::RequestHeaders, kMethodHeaderKey)
+          ->toString();
+
+  getStringValue({"request", "url_path"}, &request_info->request_url_path);
+
+  int64_t destination_port = 0;
+  if (outbound) {
+    getValue({"upstream", "port"}, &destination_port);
+    getStringValue({"upstream", "uri_san_peer_certificate"},
+                   &request_info->destination_principal);
+    getStringValue({"upstream", "uri_san_local_certificate"},
+                   &request_info->source_principal);
+  } else {
+    getValue({"destination", "port"}, &destination_port);
+    bool mtls = false;
+    if (getValue({"connection", "mtls"}, &mtls)) {
+      request_info->service_auth_policy =
+          mtls ? ServiceAuthenticationPolicy::MutualTLS
+               : ServiceAuthenticationPolicy::None;
+    }
+    getStringValue({"connection", "uri_san_local_certificate"},
+                   &request_info->destination_principal);
+    getStringValue({"connection", "uri_san_peer_certificate"},
+                   &request_info->source_principal);
+  }
+  request_info->destination_port = destination_port;
+
+  uint64_t response_flags = 0;
+  getValue({"response", "flags"}, &response_flags);
+  request_info->response_flag = parseResponseFlag(response_flags);
+}
+
+}  // namespace
+
+// Fills the request info of one inbound request per iteration, as the stats
+// and stackdriver filters do on every log call.
+static void BM_PopulateHTTPRequestInfo(benchmark::State& state) {
+  PopulateHTTPRequestInfoFixture fixture;
+  HostWasm::SaveRestoreContext saved_context(fixture.context());
+
+  for (auto _ : state) {
+    RequestInfo request_info;
+    populateHTTPRequestInfo(false, false, &request_info);
+    benchmark::DoNotOptimize(request_info);
+  }
+}
+BENCHMARK(BM_PopulateHTTPRequestInfo);
+
+// The same request read through the baseline path, for comparison.
+static void BM_PopulateHTTPRequestInfoBaseline(benchmark::State& state) {
+  PopulateHTTPRequestInfoFixture fixture;
+  HostWasm::SaveRestoreContext saved_context(fixture.context());
+
+  for (auto _ : state) {
+    RequestInfo request_info;
+    populateHTTPRequestInfoBaseline(false, false, &request_info);
+    benchmark::DoNotOptimize(request_info);
+  }
+}
+BENCHMARK(BM_PopulateHTTPRequestInfoBaseline);
+
 }  // namespace Common
 
 // WASM_EPILOG
@@ -134,6 +134,54 @@ TEST(ContextTest, extractNodeMetadataValue) {
   EXPECT_EQ(label_iter->second.string_value(), "{app, details}");
 }
 
+// Test extractNodeMetadataValue with duplicated and empty keys.
+TEST(ContextTest, extractNodeMetadataValueDuplicatedKeys) {
+  google::protobuf::Struct metadata_struct;
+  auto node_metadata_map = metadata_struct.mutable_fields();
+  (*node_metadata_map)["EXCHANGE_KEYS"].set_string_value(
+      "NAMESPACE,,NAMESPACE, ,MISSING");
+  (*node_metadata_map)["NAMESPACE"].set_string_value("default");
+  google::protobuf::Struct value_struct;
+  const auto status = extractNodeMetadataValue(metadata_struct, &value_struct);
+  EXPECT_EQ(status, Status::OK);
+  EXPECT_EQ(value_struct.fields().size(), 1);
+  EXPECT_EQ(value_struct.fields().at("NAMESPACE").string_value(), "default");
+}
+
+// Test extractFqdn with Istio and non-Istio cluster names.
+TEST(ContextTest, extractFqdn) {
+  EXPECT_EQ(
+      extractFqdn("inbound|9080|http|productpage.default.svc.cluster.local"),
+      "productpage.default.svc.cluster.local");
+  EXPECT_EQ(extractFqdn("outbound|9080||reviews.default.svc.cluster.local"),
+            "reviews.default.svc.cluster.local");
+  EXPECT_EQ(extractFqdn("outbound|80|v1|reviews"), "reviews");
+  EXPECT_EQ(extractFqdn("inbound|9080|http|"), "");
+  EXPECT_EQ(extractFqdn("BlackHoleCluster"), "");
+  EXPECT_EQ(extractFqdn("outbound|9080|reviews.default"), "");
+  EXPECT_EQ(extractFqdn("a|b|c|d|e"), "");
+  EXPECT_EQ(extractFqdn(""), "");
+}
+
+// Test extractServiceName with different host formats.
+TEST(ContextTest, extractServiceName) {
+  EXPECT_EQ(extractServiceName("productpage.default.svc.cluster.local"),
+            "productpage");
+  EXPECT_EQ(extractServiceName("productpage.default"), "productpage");
+  EXPECT_EQ(extractServiceName("productpage"), "productpage");
+  EXPECT_EQ(extractServiceName(".default"), "");
+  EXPECT_EQ(extractServiceName(""), "");
+}
+
+// Test PropertyPath encoding.
+TEST(ContextTest, PropertyPathEncoding) {
+  PropertyPath single{"cluster_name"};
+  EXPECT_EQ(single.encoded(), absl::string_view("cluster_name\0", 13));
+  PropertyPath nested{"connection", "uri_san_peer_certificate"};
+  EXPECT_EQ(nested.encoded(),
+            absl::string_view("connection\0uri_san_peer_certificate\0", 36));
+}
+
 }  // namespace Common
 
 // WASM_EPILOG
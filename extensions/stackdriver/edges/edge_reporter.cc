@@ -15,6 +15,8 @@
 
 #include "extensions/stackdriver/edges/edge_reporter.h"
 
+#include <algorithm>
+
 #include "extensions/stackdriver/common/constants.h"
 #include "extensions/stackdriver/edges/edges.pb.h"
 
@@ -42,6 +44,12 @@ using google::cloud::meshtelemetry::v1alpha1::WorkloadInstance;
 
 constexpr char kUnknown[] = "unknown";
 
+// Retry policy for failed ReportTrafficAssertions rpcs. The backoff doubles
+// after every failed attempt.
+constexpr int kMaxReportAttempts = 5;
+constexpr int64_t kInitialRetryBackoffNanos = 10000000000;  // 10s
+constexpr int64_t kMaxRetryBackoffNanos = 300000000000;     // 5m
+
 std::string valueOrUnknown(const std::string& value) {
   if (value.length() == 0) {
     return kUnknown;
@@ -115,8 +123,7 @@ EdgeReporter::~EdgeReporter() {
 void EdgeReporter::addEdge(const ::Wasm::Common::RequestInfo& request_info,
                            const std::string& peer_metadata_id_key,
                            const ::wasm::common::NodeInfo& peer_node_info) {
-  const auto& peer = current_peers_.emplace(peer_metadata_id_key);
-  if (!peer.second) {
+  if (!current_peers_.insert(peer_metadata_id_key).second) {
     // peer edge already exists
     return;
   }
@@ -126,7 +133,8 @@ void EdgeReporter::addEdge(const ::Wasm::Common::RequestInfo& request_info,
 
   edge->set_destination_service_name(request_info.destination_service_name);
   edge->set_destination_service_namespace(node_instance_.workload_namespace());
-  instanceFromMetadata(peer_node_info, edge->mutable_source());
+  edge->mutable_source()->CopyFrom(
+      peerInstance(peer_metadata_id_key, peer_node_info));
   edge->mutable_destination()->CopyFrom(node_instance_);
 
   auto protocol = request_info.request_protocol;
@@ -146,14 +154,106 @@ void EdgeReporter::addEdge(const ::Wasm::Common::RequestInfo& request_info,
   }
 };  // namespace Edges
 
+const WorkloadInstance& EdgeReporter::peerInstance(
+    const std::string& peer_metadata_id_key,
+    const ::wasm::common::NodeInfo& peer_node_info) {
+  auto it = peer_instance_index_.find(peer_metadata_id_key);
+  if (it != peer_instance_index_.end()) {
+    peer_instances_.splice(peer_instances_.begin(), peer_instances_,
+                           it->second);
+    return it->second->instance;
+  }
+
+  // Do not let the cache grow beyond max_peer_instances_.
+  if (peer_instances_.size() >= max_peer_instances_) {
+    peer_instance_index_.erase(peer_instances_.back().peer_id);
+    peer_instances_.pop_back();
+  }
+  peer_instances_.emplace_front();
+  auto& peer = peer_instances_.front();
+  peer.peer_id = peer_metadata_id_key;
+  instanceFromMetadata(peer_node_info, &peer.instance);
+  peer_instance_index_.emplace(peer.peer_id, peer_instances_.begin());
+  return peer.instance;
+}
+
+size_t EdgeReporter::estimatedMemoryUsage() const {
+  size_t bytes = current_request_->SpaceUsedLong();
+  for (const auto& request : queued_requests_) {
+    bytes += request->SpaceUsedLong();
+  }
+  for (const auto& pending : *failed_requests_) {
+    bytes += pending.request->SpaceUsedLong();
+  }
+  for (const auto& peer : peer_instances_) {
+    // A list node holds the entry and two links.
+    bytes += sizeof(PeerInstance) + 2 * sizeof(void*) + peer.peer_id.size() +
+             peer.instance.SpaceUsedLong() - sizeof(WorkloadInstance);
+  }
+  // Swiss tables keep one control byte per slot.
+  bytes += peer_instance_index_.capacity() *
+           (sizeof(decltype(peer_instance_index_)::value_type) + 1);
+  bytes += current_peers_.capacity() * (sizeof(std::string) + 1);
+  for (const auto& peer_id : current_peers_) {
+    bytes += peer_id.size();
+  }
+  return bytes;
+}
+
 void EdgeReporter::reportEdges() {
   flush();
-  for (auto& req : queued_requests_) {
-    edges_client_->reportTrafficAssertions(*req.get());
+  while (!queued_requests_.empty()) {
+    PendingRequest pending;
+    pending.request = std::move(queued_requests_.front());
+    queued_requests_.pop_front();
+    send(std::move(pending));
   }
-  queued_requests_.clear();
 };
 
+void EdgeReporter::retryFailedRequests() {
+  if (failed_requests_->empty()) {
+    return;
+  }
+  const int64_t now = TimeUtil::TimestampToNanoseconds(now_());
+  std::deque<PendingRequest> due;
+  for (auto it = failed_requests_->begin(); it != failed_requests_->end();) {
+    if (it->next_attempt_nanos == 0) {
+      const int64_t backoff =
+          std::min(kInitialRetryBackoffNanos << (it->attempts - 1),
+                   kMaxRetryBackoffNanos);
+      it->next_attempt_nanos = now + backoff;
+    }
+    if (it->next_attempt_nanos > now) {
+      ++it;
+      continue;
+    }
+    due.emplace_back(std::move(*it));
+    it = failed_requests_->erase(it);
+  }
+  for (auto& pending : due) {
+    pending.next_attempt_nanos = 0;
+    send(std::move(pending));
+  }
+}
+
+void EdgeReporter::send(PendingRequest pending) {
+  pending.attempts++;
+  std::weak_ptr<std::deque<PendingRequest>> weak_failed_requests =
+      failed_requests_;
+  const size_t max_queued_requests = max_queued_requests_;
+  edges_client_->reportTrafficAssertions(
+      *pending.request, [weak_failed_requests, pending, max_queued_requests]() {
+        auto failed_requests = weak_failed_requests.lock();
+        if (!failed_requests || pending.attempts >= kMaxReportAttempts) {
+          return;
+        }
+        if (failed_requests->size() >= max_queued_requests) {
+          failed_requests->pop_front();
+        }
+        failed_requests->push_back(pending);
+      });
+}
+
 void EdgeReporter::flush() {
   if (current_request_->traffic_assertions_size() == 0) {
     return;
@@ -167,8 +267,12 @@ void EdgeReporter::flush() {
   current_peers_.clear();
   current_request_.swap(queued_request);
 
-  // set the timestamp and then send the queued request
+  // set the timestamp and then send the queued request. Drop the oldest
+  // request if too many are waiting.
   *queued_request->mutable_timestamp() = now_();
+  if (queued_requests_.size() >= max_queued_requests_) {
+    queued_requests_.pop_front();
+  }
   queued_requests_.emplace_back(std::move(queued_request));
 }
 
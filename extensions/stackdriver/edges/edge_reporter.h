@@ -15,9 +15,14 @@
 
 #pragma once
 
+#include <deque>
+#include <list>
+#include <memory>
 #include <string>
-#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "extensions/common/context.h"
 #include "extensions/stackdriver/edges/edges.pb.h"
 #include "extensions/stackdriver/edges/mesh_edges_service_client.h"
@@ -67,11 +72,50 @@ class EdgeReporter {
   // service via the supplied client.
   void reportEdges();
 
+  // retryFailedRequests resends requests whose rpc failed once their backoff
+  // has expired. It is meant to be called more often than reportEdges.
+  void retryFailedRequests();
+
+  // Number of peers whose workload instance is cached.
+  size_t peerInstanceCacheSize() const { return peer_instances_.size(); }
+
+  // Number of failed requests waiting for a retry.
+  size_t failedRequestsSize() const { return failed_requests_->size(); }
+
+  // Estimated bytes held by buffered requests and per peer state.
+  size_t estimatedMemoryUsage() const;
+
  private:
+  // A request handed to the client, with its retry state.
+  struct PendingRequest {
+    std::shared_ptr<const ReportTrafficAssertionsRequest> request;
+    // Number of times the request has been sent.
+    int attempts = 0;
+    // Time after which a failed request may be retried. Zero until the
+    // failure is first seen by retryFailedRequests.
+    int64_t next_attempt_nanos = 0;
+  };
+
+  // A workload instance built from the metadata of a peer.
+  struct PeerInstance {
+    std::string peer_id;
+    WorkloadInstance instance;
+  };
+
   // builds a full request out of the current traffic assertions (edges),
   // adds that request to the queue, and resets the current request and state.
   void flush();
 
+  // sends a request via the client. Failed requests are put in
+  // failed_requests_.
+  void send(PendingRequest pending);
+
+  // returns the workload instance of a peer, building it from the peer
+  // metadata only when the peer is not cached.
+  const WorkloadInstance &peerInstance(
+      const std::string &peer_metadata_id_key,
+      const ::wasm::common::NodeInfo &peer_node_info);
+
   // client used to send requests to the edges service
   std::unique_ptr<MeshEdgesServiceClient> edges_client_;
 
@@ -84,14 +128,35 @@ class EdgeReporter {
   // represents the workload instance for the current proxy
   WorkloadInstance node_instance_;
 
-  // current peers for which edges have been created in current_request_;
-  std::unordered_set<std::string> current_peers_;
+  // ids of current peers for which edges have been created in
+  // current_request_.
+  absl::flat_hash_set<std::string> current_peers_;
+
+  // workload instances built from peer metadata, from the most to the least
+  // recently used.
+  std::list<PeerInstance> peer_instances_;
+
+  // entries of peer_instances_ by peer id. Keys point into the entries.
+  absl::flat_hash_map<absl::string_view, std::list<PeerInstance>::iterator>
+      peer_instance_index_;
 
   // requests waiting to be sent to backend
-  std::vector<std::unique_ptr<ReportTrafficAssertionsRequest>> queued_requests_;
+  std::deque<std::unique_ptr<ReportTrafficAssertionsRequest>> queued_requests_;
+
+  // requests that failed and wait to be retried. It is shared with the
+  // failure callbacks of requests in flight.
+  std::shared_ptr<std::deque<PendingRequest>> failed_requests_ =
+      std::make_shared<std::deque<PendingRequest>>();
 
   // TODO(douglas-reid): make adjustable.
   const int max_assertions_per_request_ = 1000;
+
+  // bound of queued_requests_ and failed_requests_ each. The oldest requests
+  // are dropped first.
+  const size_t max_queued_requests_ = 10;
+
+  // bound of peer_instances_. The least recently used peer is evicted first.
+  const size_t max_peer_instances_ = 1000;
 };
 
 }  // namespace Edges
@@ -0,0 +1,94 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "extensions/stackdriver/common/constants.h"
+#include "extensions/stackdriver/edges/edge_reporter.h"
+#include "google/protobuf/util/time_util.h"
+
+namespace Extensions {
+namespace Stackdriver {
+namespace Edges {
+
+using google::protobuf::util::TimeUtil;
+
+namespace {
+
+// Accepts every request, like a healthy edges service.
+class NoopMeshEdgesServiceClient : public MeshEdgesServiceClient {
+ public:
+  void reportTrafficAssertions(const ReportTrafficAssertionsRequest&,
+                               FailureFn) const override {}
+};
+
+wasm::common::NodeInfo nodeInfo(const std::string& name) {
+  wasm::common::NodeInfo node_info;
+  node_info.set_name(name);
+  node_info.set_namespace_("test_namespace");
+  node_info.set_workload_name("test_workload");
+  node_info.set_owner("kubernetes://test_owner");
+  node_info.set_mesh_id("test-mesh");
+  auto& platform_metadata = *node_info.mutable_platform_metadata();
+  platform_metadata[Common::kGCPProjectKey] = "test_project";
+  platform_metadata[Common::kGCPClusterNameKey] = "test_cluster";
+  platform_metadata[Common::kGCPLocationKey] = "test_location";
+  return node_info;
+}
+
+}  // namespace
+
+// One reporting period with an edge from each of state.range(0) distinct
+// peers. Beyond 1000 peers, workload instances no longer fit in the peer
+// cache and are rebuilt from metadata every period.
+static void BM_ReportPeriod(benchmark::State& state) {
+  EdgeReporter edges(nodeInfo("test_pod"),
+                     std::make_unique<NoopMeshEdgesServiceClient>(),
+                     TimeUtil::GetCurrentTime);
+  ::Wasm::Common::RequestInfo request_info;
+  request_info.destination_service_name = "httpbin";
+  request_info.request_protocol = "HTTP";
+  const auto peer_node_info = nodeInfo("test_peer_pod");
+  std::vector<std::string> peer_ids;
+  for (int i = 0; i < state.range(0); i++) {
+    peer_ids.push_back("peer-" + std::to_string(i));
+  }
+
+  for (auto _ : state) {
+    for (const auto& peer_id : peer_ids) {
+      edges.addEdge(request_info, peer_id, peer_node_info);
+    }
+    edges.reportEdges();
+  }
+  state.SetItemsProcessed(state.iterations() * peer_ids.size());
+}
+BENCHMARK(BM_ReportPeriod)->Arg(100)->Arg(1000)->Arg(10000);
+
+}  // namespace Edges
+}  // namespace Stackdriver
+}  // namespace Extensions
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -15,7 +15,10 @@
 
 #include "extensions/stackdriver/edges/edge_reporter.h"
 
+#include <algorithm>
+#include <iostream>
 #include <memory>
+#include <vector>
 
 #include "extensions/stackdriver/common/constants.h"
 #include "google/protobuf/text_format.h"
@@ -52,13 +55,34 @@ class TestMeshEdgesServiceClient : public MeshEdgesServiceClient {
   TestMeshEdgesServiceClient(TestFn test_func)
       : request_callback_(std::move(test_func)){};
 
-  void reportTrafficAssertions(
-      const ReportTrafficAssertionsRequest& request) const override {
+  void reportTrafficAssertions(const ReportTrafficAssertionsRequest& request,
+                               FailureFn on_failure) const override {
     request_callback_(request);
+    if (failures_ > 0) {
+      failures_--;
+      on_failure();
+    }
   };
 
+  // Fails the next n calls.
+  void failNext(int n) { failures_ = n; }
+
  private:
   TestFn request_callback_;
+  mutable int failures_ = 0;
+};
+
+// FakeClock is a settable time source for the reporter.
+class FakeClock {
+ public:
+  google::protobuf::Timestamp now() const {
+    return TimeUtil::NanosecondsToTimestamp(now_nanos_);
+  }
+
+  void advance(int64_t seconds) { now_nanos_ += seconds * 1000000000; }
+
+ private:
+  int64_t now_nanos_ = 1000000000;
 };
 
 const char kNodeInfo[] = R"(
@@ -305,6 +329,134 @@ TEST(EdgeReporterTest, TestMissingPeerMetadata) {
                      "ERROR: addEdge() produced unexpected result.");
 }
 
+TEST(EdgeReporterTest, TestRetryWithBackoff) {
+  int calls = 0;
+  FakeClock clock;
+
+  auto test_client = std::make_unique<TestMeshEdgesServiceClient>(
+      [&calls](const ReportTrafficAssertionsRequest&) { calls++; });
+  auto client_ptr = test_client.get();
+  auto edges = std::make_unique<EdgeReporter>(
+      nodeInfo(), std::move(test_client), [&clock]() { return clock.now(); });
+
+  client_ptr->failNext(2);
+  edges->addEdge(requestInfo(), "test", peerNodeInfo());
+  edges->reportEdges();
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(1, edges->failedRequestsSize());
+
+  // The first retry waits for 10s.
+  edges->retryFailedRequests();
+  clock.advance(5);
+  edges->retryFailedRequests();
+  EXPECT_EQ(1, calls);
+  clock.advance(5);
+  edges->retryFailedRequests();
+  EXPECT_EQ(2, calls);
+  EXPECT_EQ(1, edges->failedRequestsSize());
+
+  // The second retry waits for 20s, and then succeeds.
+  edges->retryFailedRequests();
+  clock.advance(10);
+  edges->retryFailedRequests();
+  EXPECT_EQ(2, calls);
+  clock.advance(10);
+  edges->retryFailedRequests();
+  EXPECT_EQ(3, calls);
+  EXPECT_EQ(0, edges->failedRequestsSize());
+}
+
+TEST(EdgeReporterTest, TestRetryGivesUp) {
+  int calls = 0;
+  FakeClock clock;
+
+  auto test_client = std::make_unique<TestMeshEdgesServiceClient>(
+      [&calls](const ReportTrafficAssertionsRequest&) { calls++; });
+  auto client_ptr = test_client.get();
+  auto edges = std::make_unique<EdgeReporter>(
+      nodeInfo(), std::move(test_client), [&clock]() { return clock.now(); });
+
+  client_ptr->failNext(100);
+  edges->addEdge(requestInfo(), "test", peerNodeInfo());
+  edges->reportEdges();
+  for (int i = 0; i < 100; i++) {
+    edges->retryFailedRequests();
+    clock.advance(60);
+  }
+  EXPECT_EQ(5, calls);
+  EXPECT_EQ(0, edges->failedRequestsSize());
+}
+
+TEST(EdgeReporterTest, TestFailedRequestsBounded) {
+  int calls = 0;
+
+  auto test_client = std::make_unique<TestMeshEdgesServiceClient>(
+      [&calls](const ReportTrafficAssertionsRequest&) { calls++; });
+  auto client_ptr = test_client.get();
+  auto edges = std::make_unique<EdgeReporter>(
+      nodeInfo(), std::move(test_client), TimeUtil::GetCurrentTime);
+
+  client_ptr->failNext(100);
+  for (int i = 0; i < 50; i++) {
+    edges->addEdge(requestInfo(), std::to_string(i), peerNodeInfo());
+    edges->reportEdges();
+    EXPECT_LE(edges->failedRequestsSize(), 10);
+  }
+  EXPECT_EQ(50, calls);
+  EXPECT_EQ(10, edges->failedRequestsSize());
+}
+
+TEST(EdgeReporterTest, TestManyDistinctPeers) {
+  int calls = 0;
+  int num_assertions = 0;
+
+  auto test_client = std::make_unique<TestMeshEdgesServiceClient>(
+      [&calls, &num_assertions](const ReportTrafficAssertionsRequest& request) {
+        calls++;
+        num_assertions += request.traffic_assertions_size();
+      });
+  auto edges = std::make_unique<EdgeReporter>(
+      nodeInfo(), std::move(test_client), TimeUtil::GetCurrentTime);
+
+  const auto peer_node_info = peerNodeInfo();
+  std::vector<std::string> peer_ids;
+  for (int i = 0; i < 10000; i++) {
+    peer_ids.push_back("peer-" + std::to_string(i));
+  }
+
+  // The first 1000 peers fill the peer instance cache.
+  for (int i = 0; i < 1000; i++) {
+    edges->addEdge(requestInfo(), peer_ids[i], peer_node_info);
+  }
+  edges->reportEdges();
+  const size_t full_cache_bytes = edges->estimatedMemoryUsage();
+  EXPECT_EQ(1000, edges->peerInstanceCacheSize());
+
+  // Two reporting periods over 10k peers, so that the second one evicts and
+  // rebuilds cached workload instances.
+  size_t max_bytes = 0;
+  for (int period = 0; period < 2; period++) {
+    for (size_t i = 0; i < peer_ids.size(); i++) {
+      edges->addEdge(requestInfo(), peer_ids[i], peer_node_info);
+      if (i % 100 == 0) {
+        max_bytes = std::max(max_bytes, edges->estimatedMemoryUsage());
+      }
+    }
+    edges->reportEdges();
+  }
+
+  // Requests are flushed after every 1001 assertions.
+  EXPECT_EQ(21, calls);
+  EXPECT_EQ(21000, num_assertions);
+  EXPECT_EQ(1000, edges->peerInstanceCacheSize());
+  // Ten times more distinct peers take about the same memory once the cache
+  // is full; only the longer peer ids add to it. While a period is in
+  // progress, the current request holds up to 1001 assertions on top of it,
+  // each with a copy of two workload instances.
+  EXPECT_LE(edges->estimatedMemoryUsage(), full_cache_bytes * 11 / 10);
+  EXPECT_LE(max_bytes, 4 * full_cache_bytes);
+}
+
 }  // namespace Edges
 }  // namespace Stackdriver
 }  // namespace Extensions
@@ -58,7 +58,6 @@ MeshEdgesServiceClientImpl::MeshEdgesServiceClientImpl(
   };
 
   failure_callback_ = [](GrpcStatus status) {
-    // TODO(douglas-reid): add retry (and other) logic
     logWarn("MeshEdgesService ReportTrafficAssertionsRequest failure: " +
             std::to_string(static_cast<int>(status)) + " " +
             getStatus().second->toString());
@@ -86,13 +85,18 @@ MeshEdgesServiceClientImpl::MeshEdgesServiceClientImpl(
 };
 
 void MeshEdgesServiceClientImpl::reportTrafficAssertions(
-    const ReportTrafficAssertionsRequest& request) const {
+    const ReportTrafficAssertionsRequest& request, FailureFn on_failure) const {
   LOG_TRACE("mesh edge services client: sending request '" +
             request.DebugString() + "'");
 
+  auto failure_callback = [log_failure = failure_callback_,
+                           on_failure](GrpcStatus status) {
+    log_failure(status);
+    on_failure();
+  };
   context_->grpcSimpleCall(
       grpc_service_, kMeshEdgesService, kReportTrafficAssertions, request,
-      kDefaultTimeoutMillisecond, success_callback_, failure_callback_);
+      kDefaultTimeoutMillisecond, success_callback_, failure_callback);
 };
 
 }  // namespace Edges
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "extensions/stackdriver/edges/edges.pb.h"
 
 #ifndef NULL_PLUGIN
@@ -41,11 +43,15 @@ using google::cloud::meshtelemetry::v1alpha1::ReportTrafficAssertionsRequest;
 // service (defined in edges.proto).
 class MeshEdgesServiceClient {
  public:
+  typedef std::function<void()> FailureFn;
+
   virtual ~MeshEdgesServiceClient() {}
 
   // reportTrafficAssertions handles invoking the `ReportTrafficAssertions` rpc.
+  // on_failure is invoked if the rpc fails, so that it can be retried.
   virtual void reportTrafficAssertions(
-      const ReportTrafficAssertionsRequest& request) const = 0;
+      const ReportTrafficAssertionsRequest& request,
+      FailureFn on_failure) const = 0;
 };
 
 // MeshEdgesServiceClientImpl provides a gRPC implementation of the client
@@ -59,8 +65,8 @@ class MeshEdgesServiceClientImpl : public MeshEdgesServiceClient {
   MeshEdgesServiceClientImpl(RootContext* root_context,
                              std::string edges_endpoint);
 
-  void reportTrafficAssertions(
-      const ReportTrafficAssertionsRequest& request) const override;
+  void reportTrafficAssertions(const ReportTrafficAssertionsRequest& request,
+                               FailureFn on_failure) const override;
 
  private:
   // Provides the VM context for making calls.
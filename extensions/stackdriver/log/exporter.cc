@@ -48,14 +48,14 @@ ExporterImpl::ExporterImpl(RootContext* root_context,
                      {MetricTag{"type", MetricTag::TagType::String},
                       MetricTag{"success", MetricTag::TagType::Bool}});
   auto success_counter = export_call.resolve("logging", true);
-  auto failure_counter = export_call.resolve("logging", false);
+  failure_counter_ = export_call.resolve("logging", false);
   success_callback_ = [success_counter](size_t) {
     // TODO(bianpengyuan): replace this with envoy's generic gRPC counter.
     incrementMetric(success_counter, 1);
     logDebug("successfully sent Stackdriver logging request");
   };
 
-  failure_callback_ = [failure_counter](GrpcStatus status) {
+  failure_callback_ = [failure_counter = failure_counter_](GrpcStatus status) {
     // TODO(bianpengyuan): add retry.
     // TODO(bianpengyuan): replace this with envoy's generic gRPC counter.
     incrementMetric(failure_counter, 1);
@@ -87,15 +87,48 @@ ExporterImpl::ExporterImpl(RootContext* root_context,
   grpc_service.SerializeToString(&grpc_service_string_);
 }
 
+WasmResult startExportCall(
+    const std::shared_ptr<size_t>& pending_bytes, size_t size,
+    std::function<void(size_t)> on_success,
+    std::function<void(GrpcStatus)> on_failure,
+    const std::function<WasmResult(std::function<void(size_t)>,
+                                   std::function<void(GrpcStatus)>)>& start) {
+  *pending_bytes += size;
+  auto result = start(
+      [on_success, pending_bytes, size](size_t body_size) {
+        *pending_bytes -= size;
+        on_success(body_size);
+      },
+      [on_failure, pending_bytes, size](GrpcStatus status) {
+        *pending_bytes -= size;
+        on_failure(status);
+      });
+  if (result != WasmResult::Ok) {
+    *pending_bytes -= size;
+  }
+  return result;
+}
+
 void ExporterImpl::exportLogs(
     const std::vector<
         std::unique_ptr<const google::logging::v2::WriteLogEntriesRequest>>&
         requests) const {
   for (const auto& req : requests) {
-    context_->grpcSimpleCall(grpc_service_string_, kGoogleLoggingService,
-                             kGoogleWriteLogEntriesMethod, *req,
-                             kDefaultTimeoutMillisecond, success_callback_,
-                             failure_callback_);
+    auto result = startExportCall(
+        pending_bytes_, req->ByteSizeLong(), success_callback_,
+        failure_callback_,
+        [this, &req](std::function<void(size_t)> on_success,
+                     std::function<void(GrpcStatus)> on_failure) {
+          return context_->grpcSimpleCall(
+              grpc_service_string_, kGoogleLoggingService,
+              kGoogleWriteLogEntriesMethod, *req, kDefaultTimeoutMillisecond,
+              on_success, on_failure);
+        });
+    if (result != WasmResult::Ok) {
+      incrementMetric(failure_counter_, 1);
+      logWarn("Stackdriver logging api call cannot be started: " +
+              std::to_string(static_cast<int>(result)));
+    }
   }
 }
 
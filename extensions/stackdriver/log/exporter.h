@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 
 #include "google/logging/v2/logging.pb.h"
@@ -46,8 +48,23 @@ class Exporter {
       const std::vector<
           std::unique_ptr<const google::logging::v2::WriteLogEntriesRequest>>&)
       const = 0;
+
+  // Returns the size in bytes of exported requests that have not completed
+  // yet. Logger uses it to apply backpressure on a slow backend.
+  virtual size_t pendingBytes() const { return 0; }
 };
 
+// Starts an export call for a request of the given size and counts the size
+// in pending_bytes until the call completes. start is given the callbacks to
+// pass to the gRPC call. If start fails, neither callback will run, so the size
+// is released right away. Returns the result of start.
+WasmResult startExportCall(
+    const std::shared_ptr<size_t>& pending_bytes, size_t size,
+    std::function<void(size_t)> on_success,
+    std::function<void(GrpcStatus)> on_failure,
+    const std::function<WasmResult(std::function<void(size_t)>,
+                                   std::function<void(GrpcStatus)>)>& start);
+
 // Exporter writes Stackdriver access log to the backend. It uses WebAssembly
 // gRPC API.
 class ExporterImpl : public Exporter {
@@ -64,6 +81,8 @@ class ExporterImpl : public Exporter {
           std::unique_ptr<const google::logging::v2::WriteLogEntriesRequest>>&
           req) const override;
 
+  size_t pendingBytes() const override { return *pending_bytes_; }
+
  private:
   // Wasm context that outbound calls are attached to.
   RootContext* context_ = nullptr;
@@ -71,9 +90,16 @@ class ExporterImpl : public Exporter {
   // Serialized string of Stackdriver logging service
   std::string grpc_service_string_;
 
+  // Counter of failed export calls, including calls that could not start.
+  uint32_t failure_counter_;
+
   // Callbacks for gRPC calls.
   std::function<void(size_t)> success_callback_;
   std::function<void(GrpcStatus)> failure_callback_;
+
+  // Size of requests in flight. It is shared with the per call callbacks,
+  // which may outlive a call to exportLogs.
+  std::shared_ptr<size_t> pending_bytes_ = std::make_shared<size_t>(0);
 };
 
 }  // namespace Log
@@ -0,0 +1,96 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "extensions/stackdriver/log/exporter.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace Wasm {
+namespace Null {
+namespace Plugin {
+namespace Extensions {
+namespace Stackdriver {
+namespace Log {
+
+namespace {
+
+using SuccessCallback = std::function<void(size_t)>;
+using FailureCallback = std::function<void(GrpcStatus)>;
+
+}  // namespace
+
+TEST(ExporterTest, TestSuccessReleasesPendingBytes) {
+  auto pending_bytes = std::make_shared<size_t>(0);
+  SuccessCallback on_done;
+  int successes = 0;
+  auto result = startExportCall(
+      pending_bytes, 100, [&successes](size_t) { successes++; },
+      [](GrpcStatus) { FAIL(); },
+      [&on_done](SuccessCallback on_success, FailureCallback) {
+        on_done = on_success;
+        return WasmResult::Ok;
+      });
+  EXPECT_EQ(result, WasmResult::Ok);
+  EXPECT_EQ(*pending_bytes, 100);
+
+  on_done(0);
+  EXPECT_EQ(*pending_bytes, 0);
+  EXPECT_EQ(successes, 1);
+}
+
+TEST(ExporterTest, TestFailureReleasesPendingBytes) {
+  auto pending_bytes = std::make_shared<size_t>(0);
+  FailureCallback on_done;
+  int failures = 0;
+  startExportCall(
+      pending_bytes, 100, [](size_t) { FAIL(); },
+      [&failures](GrpcStatus) { failures++; },
+      [&on_done](SuccessCallback, FailureCallback on_failure) {
+        on_done = on_failure;
+        return WasmResult::Ok;
+      });
+  EXPECT_EQ(*pending_bytes, 100);
+
+  on_done(GrpcStatus::Unavailable);
+  EXPECT_EQ(*pending_bytes, 0);
+  EXPECT_EQ(failures, 1);
+}
+
+TEST(ExporterTest, TestCallNotStartedReleasesPendingBytes) {
+  auto pending_bytes = std::make_shared<size_t>(50);
+  auto result = startExportCall(
+      pending_bytes, 100, [](size_t) { FAIL(); }, [](GrpcStatus) { FAIL(); },
+      [](SuccessCallback, FailureCallback) {
+        return WasmResult::InternalFailure;
+      });
+  EXPECT_EQ(result, WasmResult::InternalFailure);
+  // Bytes of calls still in flight are kept.
+  EXPECT_EQ(*pending_bytes, 50);
+}
+
+}  // namespace Log
+}  // namespace Stackdriver
+}  // namespace Extensions
+}  // namespace Plugin
+}  // namespace Null
+}  // namespace Wasm
+}  // namespace Common
+}  // namespace Extensions
+}  // namespace Envoy
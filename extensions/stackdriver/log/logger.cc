@@ -37,8 +37,36 @@ using google::protobuf::util::TimeUtil;
 // Name of the HTTP server access log.
 constexpr char kServerAccessLogName[] = "server-accesslog-stackdriver";
 
+// Upper bound of the encoded size of a log entry without its labels, i.e.
+// timestamp and severity.
+constexpr int kLogEntryFixedSize = 16;
+
+namespace {
+
+int varintSize(size_t value) {
+  int size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+// Sets a label and returns its encoded size as a map entry, so that the
+// request size can be tracked without serializing the entry.
+int setLabel(google::protobuf::Map<std::string, std::string>* label_map,
+             const std::string& key, const std::string& value) {
+  (*label_map)[key] = value;
+  const size_t entry_size = 2 + varintSize(key.size()) + key.size() +
+                            varintSize(value.size()) + value.size();
+  return 1 + varintSize(entry_size) + entry_size;
+}
+
+}  // namespace
+
 Logger::Logger(const ::wasm::common::NodeInfo& local_node_info,
-               std::unique_ptr<Exporter> exporter, int log_request_size_limit) {
+               std::unique_ptr<Exporter> exporter, int log_request_size_limit,
+               int max_pending_bytes) {
   // Initalize the current WriteLogEntriesRequest.
   log_entries_request_ =
       std::make_unique<google::logging::v2::WriteLogEntriesRequest>();
@@ -73,6 +101,7 @@ Logger::Logger(const ::wasm::common::NodeInfo& local_node_info,
   (*label_map)["destination_namespace"] = local_node_info.namespace_();
   (*label_map)["mesh_uid"] = local_node_info.mesh_id();
   log_request_size_limit_ = log_request_size_limit;
+  max_pending_bytes_ = max_pending_bytes;
   exporter_ = std::move(exporter);
 }
 
@@ -86,23 +115,28 @@ void Logger::addLogEntry(const ::Wasm::Common::RequestInfo& request_info,
       TimeUtil::NanosecondsToTimestamp(request_info.start_timestamp);
   new_entry->set_severity(::google::logging::type::INFO);
   auto label_map = new_entry->mutable_labels();
-  (*label_map)["source_name"] = peer_node_info.name();
-  (*label_map)["source_workload"] = peer_node_info.workload_name();
-  (*label_map)["source_namespace"] = peer_node_info.namespace_();
-
-  (*label_map)["request_operation"] = request_info.request_operation;
-  (*label_map)["destination_service_host"] =
-      request_info.destination_service_host;
-  (*label_map)["response_flag"] = request_info.response_flag;
-  (*label_map)["protocol"] = request_info.request_protocol;
-  (*label_map)["destination_principal"] = request_info.destination_principal;
-  (*label_map)["source_principal"] = request_info.source_principal;
-  (*label_map)["service_authentication_policy"] =
-      std::string(::Wasm::Common::AuthenticationPolicyString(
-          request_info.service_auth_policy));
+  int size = kLogEntryFixedSize;
+  size += setLabel(label_map, "source_name", peer_node_info.name());
+  size +=
+      setLabel(label_map, "source_workload", peer_node_info.workload_name());
+  size += setLabel(label_map, "source_namespace", peer_node_info.namespace_());
+
+  size += setLabel(label_map, "request_operation",
+                   request_info.request_operation);
+  size += setLabel(label_map, "destination_service_host",
+                   request_info.destination_service_host);
+  size += setLabel(label_map, "response_flag", request_info.response_flag);
+  size += setLabel(label_map, "protocol", request_info.request_protocol);
+  size += setLabel(label_map, "destination_principal",
+                   request_info.destination_principal);
+  size +=
+      setLabel(label_map, "source_principal", request_info.source_principal);
+  size += setLabel(label_map, "service_authentication_policy",
+                   std::string(::Wasm::Common::AuthenticationPolicyString(
+                       request_info.service_auth_policy)));
   // Accumulate estimated size of the request. If the current request exceeds
   // the size limit, flush the request out.
-  size_ += new_entry->ByteSizeLong();
+  size_ += size;
   if (size_ > log_request_size_limit_) {
     flush();
   }
@@ -121,22 +155,52 @@ bool Logger::flush() {
   cur->mutable_resource()->CopyFrom(log_entries_request_->resource());
   *cur->mutable_labels() = log_entries_request_->labels();
 
-  // Swap the new request with the old one and export it.
+  // Swap the new request with the old one and queue it for export.
   log_entries_request_.swap(cur);
-  request_queue_.emplace_back(std::move(cur));
+  request_queue_.push_back({std::move(cur), size_});
+  queued_bytes_ += size_;
 
   // Reset size counter.
   size_ = 0;
+
+  dropOverBudget();
   return true;
 }
 
+void Logger::dropOverBudget() {
+  const int64_t budget =
+      max_pending_bytes_ - static_cast<int64_t>(exporter_->pendingBytes());
+  while (!request_queue_.empty() && queued_bytes_ > budget) {
+    auto& dropped = request_queue_.front();
+    dropped_entries_ += dropped.request->entries_size();
+    queued_bytes_ -= dropped.size;
+    request_queue_.pop_front();
+  }
+}
+
 void Logger::exportLogEntry() {
   if (!flush() && request_queue_.empty()) {
     // No log entry needs to export.
     return;
   }
-  exporter_->exportLogs(request_queue_);
+  // Requests that were queued while the exporter was backed up might no
+  // longer fit with what is still in flight.
+  dropOverBudget();
+  if (request_queue_.empty()) {
+    return;
+  }
+
+  std::vector<
+      std::unique_ptr<const google::logging::v2::WriteLogEntriesRequest>>
+      requests;
+  requests.reserve(request_queue_.size());
+  for (auto& queued : request_queue_) {
+    exported_entries_ += queued.request->entries_size();
+    requests.emplace_back(std::move(queued.request));
+  }
   request_queue_.clear();
+  queued_bytes_ = 0;
+  exporter_->exportLogs(requests);
 }
 
 }  // namespace Log
@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -38,9 +39,13 @@ class Logger {
   // exports to Stackdriver backend with the given exporter.
   // log_request_size_limit is the size limit of a logging request:
   // https://cloud.google.com/logging/quotas.
+  // max_pending_bytes bounds the size of requests that are either queued or
+  // exported but not yet completed. Once it is exceeded, the oldest queued
+  // requests are dropped.
   Logger(const ::wasm::common::NodeInfo &local_node_info,
          std::unique_ptr<Exporter> exporter,
-         int log_request_size_limit = 4000000 /* 4 Mb */);
+         int log_request_size_limit = 4000000 /* 4 Mb */,
+         int max_pending_bytes = 16000000 /* 16 Mb */);
 
   // Add a new log entry based on the given request information and peer node
   // information.
@@ -50,28 +55,55 @@ class Logger {
   // Export and clean the buffered WriteLogEntriesRequests.
   void exportLogEntry();
 
+  // Number of log entries dropped because of the pending bytes limit.
+  int64_t droppedEntries() const { return dropped_entries_; }
+
+  // Number of log entries handed to the exporter.
+  int64_t exportedEntries() const { return exported_entries_; }
+
+  // Estimated size of requests queued for export.
+  int64_t queuedBytes() const { return queued_bytes_; }
+
  private:
+  // A WriteLogEntriesRequest waiting for export, with its estimated size.
+  struct QueuedRequest {
+    std::unique_ptr<const google::logging::v2::WriteLogEntriesRequest> request;
+    int size;
+  };
+
   // Flush rotates the current WriteLogEntriesRequest. This will be triggered
   // either by a timer or by request size limit. Returns false if there is no
   // log entry to be exported.
   bool flush();
 
+  // Drops the oldest queued requests until queued and in flight requests fit
+  // in max_pending_bytes_.
+  void dropOverBudget();
+
   // Buffer for WriteLogEntriesRequests that are to be exported.
-  std::vector<
-      std::unique_ptr<const google::logging::v2::WriteLogEntriesRequest>>
-      request_queue_;
+  std::deque<QueuedRequest> request_queue_;
 
   // Request that the new log entry should be written into.
   std::unique_ptr<google::logging::v2::WriteLogEntriesRequest>
       log_entries_request_;
 
-  // Estimated size of the current WriteLogEntriesRequest.
+  // Estimated size of the current WriteLogEntriesRequest. It is accumulated
+  // from label sizes as entries are added.
   int size_ = 0;
 
   // Size limit of a WriteLogEntriesRequest. If current WriteLogEntriesRequest
   // exceeds this size limit, flush() will be triggered.
   int log_request_size_limit_;
 
+  // Limit of queued and in flight request bytes.
+  int max_pending_bytes_;
+
+  // Estimated size of requests in request_queue_.
+  int64_t queued_bytes_ = 0;
+
+  int64_t dropped_entries_ = 0;
+  int64_t exported_entries_ = 0;
+
   // Exporter calls Stackdriver services to export access logs.
   std::unique_ptr<Exporter> exporter_;
 };
@@ -21,6 +21,7 @@
 #include "extensions/stackdriver/common/utils.h"
 #include "gmock/gmock.h"
 #include "google/logging/v2/log_entry.pb.h"
+#include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
 
@@ -44,6 +45,34 @@ class MockExporter : public Exporter {
                const google::logging::v2::WriteLogEntriesRequest>>&));
 };
 
+// StallingExporter accepts requests but does not complete them until
+// complete() is called, like a slow or unavailable backend.
+class StallingExporter : public Exporter {
+ public:
+  void exportLogs(
+      const std::vector<
+          std::unique_ptr<const google::logging::v2::WriteLogEntriesRequest>>&
+          requests) const override {
+    for (const auto& req : requests) {
+      pending_bytes_ += req->ByteSizeLong();
+      pending_entries_ += req->entries_size();
+    }
+  }
+
+  size_t pendingBytes() const override { return pending_bytes_; }
+
+  int pendingEntries() const { return pending_entries_; }
+
+  void complete() {
+    pending_bytes_ = 0;
+    pending_entries_ = 0;
+  }
+
+ private:
+  mutable size_t pending_bytes_ = 0;
+  mutable int pending_entries_ = 0;
+};
+
 wasm::common::NodeInfo nodeInfo() {
   wasm::common::NodeInfo node_info;
   (*node_info.mutable_platform_metadata())[Common::kGCPProjectKey] =
@@ -166,6 +195,95 @@ TEST(LoggerTest, TestWriteLogEntryRotation) {
   logger->exportLogEntry();
 }
 
+TEST(LoggerTest, TestEstimatedSize) {
+  auto exporter = std::make_unique<::testing::NiceMock<MockExporter>>();
+  auto exporter_ptr = exporter.get();
+  // A size limit of one byte queues every entry in its own request.
+  auto logger = std::make_unique<Logger>(nodeInfo(), std::move(exporter), 1);
+  logger->addLogEntry(requestInfo(), peerNodeInfo());
+  const int64_t estimated_size = logger->queuedBytes();
+  EXPECT_CALL(*exporter_ptr, exportLogs(::testing::_))
+      .WillOnce(::testing::Invoke(
+          [estimated_size](
+              const std::vector<std::unique_ptr<
+                  const google::logging::v2::WriteLogEntriesRequest>>&
+                  requests) {
+            ASSERT_EQ(requests.size(), 1);
+            ASSERT_EQ(requests[0]->entries_size(), 1);
+            // Encoded size of the entry in the request, including its field
+            // tag and length prefix.
+            const size_t entry_size = requests[0]->entries(0).ByteSizeLong();
+            const int64_t actual_size =
+                1 +
+                google::protobuf::io::CodedOutputStream::VarintSize64(
+                    entry_size) +
+                entry_size;
+            // The estimate accounts for labels exactly and bounds the rest of
+            // the entry with a fixed size, so it may only overestimate.
+            EXPECT_GE(estimated_size, actual_size);
+            EXPECT_LE(estimated_size - actual_size, 16);
+          }));
+  logger->exportLogEntry();
+  EXPECT_EQ(logger->exportedEntries(), 1);
+}
+
+TEST(LoggerTest, TestStalledExporterBoundsPendingBytes) {
+  auto exporter = std::make_unique<StallingExporter>();
+  auto exporter_ptr = exporter.get();
+  // Each request holds 3 entries, and 3 requests fit in the budget.
+  auto logger =
+      std::make_unique<Logger>(nodeInfo(), std::move(exporter), 900, 3200);
+
+  for (int i = 0; i < 9; i++) {
+    logger->addLogEntry(requestInfo(), peerNodeInfo());
+  }
+  EXPECT_LE(logger->queuedBytes(), 3200);
+  logger->exportLogEntry();
+  EXPECT_EQ(logger->queuedBytes(), 0);
+  EXPECT_GT(exporter_ptr->pendingBytes(), 3200);
+
+  // While the first requests are in flight, nothing else is queued.
+  for (int tick = 0; tick < 9; tick++) {
+    for (int i = 0; i < 9; i++) {
+      logger->addLogEntry(requestInfo(), peerNodeInfo());
+      EXPECT_EQ(logger->queuedBytes(), 0);
+    }
+    logger->exportLogEntry();
+  }
+
+  // Only the first tick fit in the budget, everything after it was dropped.
+  EXPECT_EQ(exporter_ptr->pendingEntries(), 9);
+  EXPECT_EQ(logger->exportedEntries(), 9);
+  EXPECT_EQ(logger->droppedEntries(), 81);
+
+  // Once the backend catches up, export resumes.
+  exporter_ptr->complete();
+  for (int i = 0; i < 9; i++) {
+    logger->addLogEntry(requestInfo(), peerNodeInfo());
+  }
+  logger->exportLogEntry();
+  EXPECT_EQ(exporter_ptr->pendingEntries(), 9);
+  EXPECT_EQ(logger->exportedEntries(), 18);
+  EXPECT_EQ(logger->droppedEntries(), 81);
+}
+
+TEST(LoggerTest, TestDropOldestQueuedRequests) {
+  auto exporter = std::make_unique<StallingExporter>();
+  auto exporter_ptr = exporter.get();
+  auto logger =
+      std::make_unique<Logger>(nodeInfo(), std::move(exporter), 900, 2100);
+
+  // Without an export in between, the queue keeps the newest requests that
+  // fit in the budget.
+  for (int i = 0; i < 15; i++) {
+    logger->addLogEntry(requestInfo(), peerNodeInfo());
+  }
+  EXPECT_EQ(logger->droppedEntries(), 9);
+  logger->exportLogEntry();
+  EXPECT_EQ(exporter_ptr->pendingEntries(), 6);
+  EXPECT_EQ(logger->exportedEntries(), 6);
+}
+
 }  // namespace Log
 }  // namespace Stackdriver
 }  // namespace Extensions
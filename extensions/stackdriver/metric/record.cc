@@ -15,6 +15,10 @@
 
 #include "extensions/stackdriver/metric/record.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "extensions/stackdriver/common/constants.h"
 #include "extensions/stackdriver/metric/registry.h"
 
@@ -22,66 +26,155 @@ namespace Extensions {
 namespace Stackdriver {
 namespace Metric {
 
-void record(bool is_outbound, const ::wasm::common::NodeInfo &local_node_info,
-            const ::wasm::common::NodeInfo &peer_node_info,
-            const ::Wasm::Common::RequestInfo &request_info) {
-  double latency_ms =
-      double(request_info.end_timestamp - request_info.start_timestamp) /
-      Stackdriver::Common::kNanosecondsPerMillisecond;
-  const auto &operation =
+void MetricDimensions::map(bool is_outbound,
+                           const ::wasm::common::NodeInfo &local_node_info,
+                           const ::wasm::common::NodeInfo &peer_node_info,
+                           const ::Wasm::Common::RequestInfo &request_info) {
+  const auto &source_node_info = is_outbound ? local_node_info : peer_node_info;
+  const auto &destination_node_info =
+      is_outbound ? peer_node_info : local_node_info;
+
+  mesh_uid = local_node_info.mesh_id();
+  request_operation =
       request_info.request_protocol == ::Wasm::Common::kProtocolGRPC
           ? request_info.request_url_path
           : request_info.request_operation;
-  if (is_outbound) {
+  request_protocol = request_info.request_protocol;
+  service_authentication_policy = request_info.service_auth_policy;
+  destination_service_name = request_info.destination_service_name;
+  destination_service_namespace = destination_node_info.namespace_();
+  destination_port = request_info.destination_port;
+  response_code = request_info.response_code;
+  source_principal = request_info.source_principal;
+  source_workload_name = source_node_info.workload_name();
+  source_workload_namespace = source_node_info.namespace_();
+  source_owner = source_node_info.owner();
+  destination_principal = request_info.destination_principal;
+  destination_workload_name = destination_node_info.workload_name();
+  destination_workload_namespace = destination_node_info.namespace_();
+  destination_owner = destination_node_info.owner();
+  outbound = is_outbound;
+}
+
+opencensus::tags::TagMap MetricDimensions::tagMap() const {
+  std::vector<std::pair<opencensus::tags::TagKey, std::string>> tags;
+#define ADD_TAG(name, key) tags.emplace_back(key##Key(), name);
+  STACKDRIVER_STRING_TAGS(ADD_TAG)
+#undef ADD_TAG
+  tags.emplace_back(serviceAuthenticationPolicyKey(),
+                    std::string(::Wasm::Common::AuthenticationPolicyString(
+                        service_authentication_policy)));
+  tags.emplace_back(destinationPortKey(), std::to_string(destination_port));
+  tags.emplace_back(responseCodeKey(), std::to_string(response_code));
+  return opencensus::tags::TagMap(std::move(tags));
+}
+
+size_t MetricDimensions::Hash::operator()(const MetricDimensions &d) const {
+  const size_t kMul = static_cast<size_t>(0x9ddfea08eb382d69);
+  size_t h = 0;
+#define HASH(name, key) h = (h ^ std::hash<std::string>()(d.name)) * kMul;
+  STACKDRIVER_STRING_TAGS(HASH)
+#undef HASH
+  h = (h ^ static_cast<size_t>(d.service_authentication_policy)) * kMul;
+  h = (h ^ d.destination_port) * kMul;
+  h = (h ^ d.response_code) * kMul;
+  h = (h ^ d.outbound) * kMul;
+  return h;
+}
+
+TagMapCache::Entry &TagMapCache::lookup(
+    bool is_outbound, const ::wasm::common::NodeInfo &local_node_info,
+    const ::wasm::common::NodeInfo &peer_node_info,
+    const ::Wasm::Common::RequestInfo &request_info) {
+  dimensions_.map(is_outbound, local_node_info, peer_node_info, request_info);
+  auto it = cache_.find(dimensions_);
+  if (it != cache_.end()) {
+    return it->second;
+  }
+
+  // Do not let the cache grow beyond max_size_. Dimension sets are stable
+  // under steady traffic, so a full reset is rare and cheap to recover from.
+  // Pending counts are recorded first so that they are not lost.
+  if (cache_.size() >= max_size_) {
+    flush();
+    cache_.clear();
+  }
+  return cache_.emplace(dimensions_, Entry(dimensions_.tagMap()))
+      .first->second;
+}
+
+void TagMapCache::flush() {
+  for (auto &it : cache_) {
+    auto &entry = it.second;
+    if (entry.pending_request_count == 0) {
+      continue;
+    }
+    if (it.first.outbound) {
+      opencensus::stats::Record(
+          {{clientRequestCountMeasure(), entry.pending_request_count}},
+          entry.tag_map);
+    } else {
+      opencensus::stats::Record(
+          {{serverRequestCountMeasure(), entry.pending_request_count}},
+          entry.tag_map);
+    }
+    entry.pending_request_count = 0;
+  }
+}
+
+namespace {
+
+void recordRequest(opencensus::stats::MeasureInt64 request_count_measure,
+                   opencensus::stats::MeasureInt64 request_bytes_measure,
+                   opencensus::stats::MeasureInt64 response_bytes_measure,
+                   opencensus::stats::MeasureDouble latencies_measure,
+                   const ::Wasm::Common::RequestInfo &request_info,
+                   bool aggregate_request_count, TagMapCache::Entry *entry) {
+  double latency_ms =
+      double(request_info.end_timestamp - request_info.start_timestamp) /
+      Stackdriver::Common::kNanosecondsPerMillisecond;
+  if (aggregate_request_count) {
+    // Request count views sum the count measure, so a count recorded once by
+    // flush() exports the same value as one recorded per request.
+    // Distributions can not be merged through the OpenCensus API without
+    // changing their mean and deviation, so their samples are still recorded
+    // per request.
+    entry->pending_request_count++;
     opencensus::stats::Record(
-        {{clientRequestCountMeasure(), 1},
-         {clientRequestBytesMeasure(), request_info.request_size},
-         {clientResponseBytesMeasure(), request_info.response_size},
-         {clientRoundtripLatenciesMeasure(), latency_ms}},
-        {{meshUIDKey(), local_node_info.mesh_id()},
-         {requestOperationKey(), operation},
-         {requestProtocolKey(), request_info.request_protocol},
-         {serviceAuthenticationPolicyKey(),
-          ::Wasm::Common::AuthenticationPolicyString(
-              request_info.service_auth_policy)},
-         {destinationServiceNameKey(), request_info.destination_service_name},
-         {destinationServiceNamespaceKey(), peer_node_info.namespace_()},
-         {destinationPortKey(), std::to_string(request_info.destination_port)},
-         {responseCodeKey(), std::to_string(request_info.response_code)},
-         {sourcePrincipalKey(), request_info.source_principal},
-         {sourceWorkloadNameKey(), local_node_info.workload_name()},
-         {sourceWorkloadNamespaceKey(), local_node_info.namespace_()},
-         {sourceOwnerKey(), local_node_info.owner()},
-         {destinationPrincipalKey(), request_info.destination_principal},
-         {destinationWorkloadNameKey(), peer_node_info.workload_name()},
-         {destinationWorkloadNamespaceKey(), peer_node_info.namespace_()},
-         {destinationOwnerKey(), peer_node_info.owner()}});
+        {{request_bytes_measure, request_info.request_size},
+         {response_bytes_measure, request_info.response_size},
+         {latencies_measure, latency_ms}},
+        entry->tag_map);
     return;
   }
 
   opencensus::stats::Record(
-      {{serverRequestCountMeasure(), 1},
-       {serverRequestBytesMeasure(), request_info.request_size},
-       {serverResponseBytesMeasure(), request_info.response_size},
-       {serverResponseLatenciesMeasure(), latency_ms}},
-      {{meshUIDKey(), local_node_info.mesh_id()},
-       {requestOperationKey(), operation},
-       {requestProtocolKey(), request_info.request_protocol},
-       {serviceAuthenticationPolicyKey(),
-        ::Wasm::Common::AuthenticationPolicyString(
-            request_info.service_auth_policy)},
-       {destinationServiceNameKey(), request_info.destination_service_name},
-       {destinationServiceNamespaceKey(), local_node_info.namespace_()},
-       {destinationPortKey(), std::to_string(request_info.destination_port)},
-       {responseCodeKey(), std::to_string(request_info.response_code)},
-       {sourcePrincipalKey(), request_info.source_principal},
-       {sourceWorkloadNameKey(), peer_node_info.workload_name()},
-       {sourceWorkloadNamespaceKey(), peer_node_info.namespace_()},
-       {sourceOwnerKey(), peer_node_info.owner()},
-       {destinationPrincipalKey(), request_info.destination_principal},
-       {destinationWorkloadNameKey(), local_node_info.workload_name()},
-       {destinationWorkloadNamespaceKey(), local_node_info.namespace_()},
-       {destinationOwnerKey(), local_node_info.owner()}});
+      {{request_count_measure, 1},
+       {request_bytes_measure, request_info.request_size},
+       {response_bytes_measure, request_info.response_size},
+       {latencies_measure, latency_ms}},
+      entry->tag_map);
+}
+
+}  // namespace
+
+void record(bool is_outbound, const ::wasm::common::NodeInfo &local_node_info,
+            const ::wasm::common::NodeInfo &peer_node_info,
+            const ::Wasm::Common::RequestInfo &request_info,
+            TagMapCache *tag_map_cache) {
+  auto &entry = tag_map_cache->lookup(is_outbound, local_node_info,
+                                      peer_node_info, request_info);
+  if (is_outbound) {
+    recordRequest(clientRequestCountMeasure(), clientRequestBytesMeasure(),
+                  clientResponseBytesMeasure(),
+                  clientRoundtripLatenciesMeasure(), request_info,
+                  tag_map_cache->aggregateRequestCount(), &entry);
+    return;
+  }
+
+  recordRequest(serverRequestCountMeasure(), serverRequestBytesMeasure(),
+                serverResponseBytesMeasure(), serverResponseLatenciesMeasure(),
+                request_info, tag_map_cache->aggregateRequestCount(), &entry);
 }
 
 }  // namespace Metric
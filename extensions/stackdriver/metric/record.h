@@ -15,18 +15,144 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <utility>
+
 #include "extensions/common/context.h"
 #include "extensions/stackdriver/config/v1alpha1/stackdriver_plugin_config.pb.h"
+#include "opencensus/tags/tag_map.h"
 
 namespace Extensions {
 namespace Stackdriver {
 namespace Metric {
 
+// String valued tags of Stackdriver metrics, listed as (field, tag key).
+#define STACKDRIVER_STRING_TAGS(FIELD_FUNC)                                \
+  FIELD_FUNC(mesh_uid, meshUID)                                            \
+  FIELD_FUNC(request_operation, requestOperation)                          \
+  FIELD_FUNC(request_protocol, requestProtocol)                            \
+  FIELD_FUNC(destination_service_name, destinationServiceName)             \
+  FIELD_FUNC(destination_service_namespace, destinationServiceNamespace)   \
+  FIELD_FUNC(source_principal, sourcePrincipal)                            \
+  FIELD_FUNC(source_workload_name, sourceWorkloadName)                     \
+  FIELD_FUNC(source_workload_namespace, sourceWorkloadNamespace)           \
+  FIELD_FUNC(source_owner, sourceOwner)                                    \
+  FIELD_FUNC(destination_principal, destinationPrincipal)                  \
+  FIELD_FUNC(destination_workload_name, destinationWorkloadName)           \
+  FIELD_FUNC(destination_workload_namespace, destinationWorkloadNamespace) \
+  FIELD_FUNC(destination_owner, destinationOwner)
+
+// MetricDimensions holds the tag values of a Stackdriver metric data point.
+// Numeric and enum tags are kept in their native form and only converted to
+// strings when a new tag map is built.
+struct MetricDimensions {
+#define DEFINE_FIELD(name, key) std::string name;
+  STACKDRIVER_STRING_TAGS(DEFINE_FIELD)
+#undef DEFINE_FIELD
+  ::Wasm::Common::ServiceAuthenticationPolicy service_authentication_policy =
+      ::Wasm::Common::ServiceAuthenticationPolicy::Unspecified;
+  uint32_t destination_port = 0;
+  uint32_t response_code = 0;
+
+  // Reporter kind. It is not a tag, but selects the client or server metrics.
+  bool outbound = false;
+
+  // Maps local node, peer node and request info to dimensions. Fields are
+  // assigned in place, so a reused instance does not allocate once its
+  // strings have grown to size.
+  void map(bool is_outbound, const ::wasm::common::NodeInfo &local_node_info,
+           const ::wasm::common::NodeInfo &peer_node_info,
+           const ::Wasm::Common::RequestInfo &request_info);
+
+  // Builds the OpenCensus tag map for these dimensions.
+  opencensus::tags::TagMap tagMap() const;
+
+  struct Hash {
+    size_t operator()(const MetricDimensions &d) const;
+  };
+
+  friend bool operator==(const MetricDimensions &lhs,
+                         const MetricDimensions &rhs) {
+    return (
+#define COMPARE(name, key) lhs.name == rhs.name &&
+        STACKDRIVER_STRING_TAGS(COMPARE)
+            lhs.service_authentication_policy ==
+            rhs.service_authentication_policy &&
+        lhs.destination_port == rhs.destination_port &&
+        lhs.response_code == rhs.response_code &&
+        lhs.outbound == rhs.outbound);
+#undef COMPARE
+  }
+};
+
+const size_t kDefaultTagMapCacheMaxSize = 1000;
+
+// TagMapCache keeps the OpenCensus tag map built for each distinct set of
+// dimensions. A request then only hashes its dimensions, instead of converting
+// numeric tags to strings and building and sorting a new tag map.
+//
+// If request count aggregation is enabled, request counts are also
+// pre-aggregated per dimension set and only recorded into OpenCensus by
+// flush(), so that counting a request is an integer increment.
+// It is not thread safe and should be owned by a root context.
+class TagMapCache {
+ public:
+  struct Entry {
+    explicit Entry(opencensus::tags::TagMap tag_map)
+        : tag_map(std::move(tag_map)) {}
+
+    opencensus::tags::TagMap tag_map;
+
+    // Requests counted locally but not yet recorded into OpenCensus.
+    int64_t pending_request_count = 0;
+  };
+
+  explicit TagMapCache(size_t max_size = kDefaultTagMapCacheMaxSize,
+                       bool aggregate_request_count = true)
+      : max_size_(max_size),
+        aggregate_request_count_(aggregate_request_count) {}
+
+  // Records counts still pending so that they outlive the cache owner.
+  ~TagMapCache() { flush(); }
+
+  // Returns the tag map for the given request. The reference is valid until
+  // the next call.
+  const opencensus::tags::TagMap &get(
+      bool is_outbound, const ::wasm::common::NodeInfo &local_node_info,
+      const ::wasm::common::NodeInfo &peer_node_info,
+      const ::Wasm::Common::RequestInfo &request_info) {
+    return lookup(is_outbound, local_node_info, peer_node_info, request_info)
+        .tag_map;
+  }
+
+  // Returns the cache entry for the given request. The reference is valid
+  // until the next call.
+  Entry &lookup(bool is_outbound,
+                const ::wasm::common::NodeInfo &local_node_info,
+                const ::wasm::common::NodeInfo &peer_node_info,
+                const ::Wasm::Common::RequestInfo &request_info);
+
+  // Records pre-aggregated request counts into OpenCensus and resets them.
+  void flush();
+
+  bool aggregateRequestCount() const { return aggregate_request_count_; }
+
+  size_t size() const { return cache_.size(); }
+
+ private:
+  // Scratch dimensions reused across requests.
+  MetricDimensions dimensions_;
+  std::unordered_map<MetricDimensions, Entry, MetricDimensions::Hash> cache_;
+  size_t max_size_;
+  bool aggregate_request_count_;
+};
+
 // Record metrics based on local node info and request info.
 // Reporter kind deceides the type of metrics to record.
 void record(bool is_outbound, const ::wasm::common::NodeInfo &local_node_info,
             const ::wasm::common::NodeInfo &peer_node_info,
-            const ::Wasm::Common::RequestInfo &request_info);
+            const ::Wasm::Common::RequestInfo &request_info,
+            TagMapCache *tag_map_cache);
 
 }  // namespace Metric
 }  // namespace Stackdriver
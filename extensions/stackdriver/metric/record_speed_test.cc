@@ -0,0 +1,102 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+#include "extensions/stackdriver/metric/record.h"
+#include "extensions/stackdriver/metric/registry.h"
+
+namespace Extensions {
+namespace Stackdriver {
+namespace Metric {
+
+namespace {
+
+::Wasm::Common::RequestInfo requestInfo() {
+  ::Wasm::Common::RequestInfo request_info;
+  request_info.request_protocol = ::Wasm::Common::kProtocolHTTP;
+  request_info.request_operation = "GET";
+  request_info.service_auth_policy =
+      ::Wasm::Common::ServiceAuthenticationPolicy::MutualTLS;
+  request_info.destination_service_name = "productpage";
+  request_info.destination_port = 9080;
+  request_info.response_code = 200;
+  request_info.source_principal = "spiffe://cluster.local/ns/a/sa/b";
+  request_info.destination_principal = "spiffe://cluster.local/ns/c/sa/d";
+  return request_info;
+}
+
+wasm::common::NodeInfo nodeInfo(const std::string& name) {
+  wasm::common::NodeInfo node_info;
+  node_info.set_mesh_id("mesh");
+  node_info.set_namespace_(name + "_namespace");
+  node_info.set_workload_name(name + "_workload");
+  node_info.set_owner(name + "_owner");
+  return node_info;
+}
+
+}  // namespace
+
+// Builds the tag map from scratch for every request.
+static void BM_BuildTagMap(benchmark::State& state) {
+  const auto local = nodeInfo("local");
+  const auto peer = nodeInfo("peer");
+  const auto request_info = requestInfo();
+  MetricDimensions dimensions;
+  for (auto _ : state) {
+    dimensions.map(true, local, peer, request_info);
+    auto tag_map = dimensions.tagMap();
+    benchmark::DoNotOptimize(tag_map);
+  }
+}
+BENCHMARK(BM_BuildTagMap);
+
+// Looks up the precomputed tag map for every request.
+static void BM_CachedTagMap(benchmark::State& state) {
+  const auto local = nodeInfo("local");
+  const auto peer = nodeInfo("peer");
+  const auto request_info = requestInfo();
+  TagMapCache cache;
+  for (auto _ : state) {
+    const auto& tag_map = cache.get(true, local, peer, request_info);
+    benchmark::DoNotOptimize(tag_map);
+  }
+}
+BENCHMARK(BM_CachedTagMap);
+
+static void BM_Record(benchmark::State& state) {
+  registerViews();
+  const auto local = nodeInfo("local");
+  const auto peer = nodeInfo("peer");
+  const auto request_info = requestInfo();
+  TagMapCache cache;
+  for (auto _ : state) {
+    record(true, local, peer, request_info, &cache);
+  }
+}
+BENCHMARK(BM_Record);
+
+}  // namespace Metric
+}  // namespace Stackdriver
+}  // namespace Extensions
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
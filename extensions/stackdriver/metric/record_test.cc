@@ -0,0 +1,259 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "extensions/stackdriver/metric/record.h"
+
+#include "extensions/stackdriver/common/constants.h"
+#include "extensions/stackdriver/metric/registry.h"
+#include "gtest/gtest.h"
+#include "opencensus/stats/testing/test_utils.h"
+
+namespace Extensions {
+namespace Stackdriver {
+namespace Metric {
+
+namespace {
+
+wasm::common::NodeInfo localNodeInfo() {
+  wasm::common::NodeInfo node_info;
+  node_info.set_mesh_id("mesh");
+  node_info.set_namespace_("local_namespace");
+  node_info.set_workload_name("local_workload");
+  node_info.set_owner("local_owner");
+  return node_info;
+}
+
+wasm::common::NodeInfo peerNodeInfo() {
+  wasm::common::NodeInfo node_info;
+  node_info.set_mesh_id("mesh");
+  node_info.set_namespace_("peer_namespace");
+  node_info.set_workload_name("peer_workload");
+  node_info.set_owner("peer_owner");
+  return node_info;
+}
+
+::Wasm::Common::RequestInfo requestInfo() {
+  ::Wasm::Common::RequestInfo request_info;
+  request_info.request_protocol = ::Wasm::Common::kProtocolHTTP;
+  request_info.request_operation = "GET";
+  request_info.request_url_path = "/foo";
+  request_info.service_auth_policy =
+      ::Wasm::Common::ServiceAuthenticationPolicy::MutualTLS;
+  request_info.destination_service_name = "productpage";
+  request_info.destination_port = 9080;
+  request_info.response_code = 200;
+  request_info.source_principal = "spiffe://cluster.local/ns/a/sa/b";
+  request_info.destination_principal = "spiffe://cluster.local/ns/c/sa/d";
+  return request_info;
+}
+
+// Tag map as built by record() before tag maps were cached.
+opencensus::tags::TagMap expectedTagMap(
+    const wasm::common::NodeInfo& source, const wasm::common::NodeInfo& dest,
+    const wasm::common::NodeInfo& local,
+    const ::Wasm::Common::RequestInfo& request_info) {
+  return opencensus::tags::TagMap(
+      {{meshUIDKey(), local.mesh_id()},
+       {requestOperationKey(), request_info.request_operation},
+       {requestProtocolKey(), request_info.request_protocol},
+       {serviceAuthenticationPolicyKey(),
+        ::Wasm::Common::AuthenticationPolicyString(
+            request_info.service_auth_policy)},
+       {destinationServiceNameKey(), request_info.destination_service_name},
+       {destinationServiceNamespaceKey(), dest.namespace_()},
+       {destinationPortKey(), std::to_string(request_info.destination_port)},
+       {responseCodeKey(), std::to_string(request_info.response_code)},
+       {sourcePrincipalKey(), request_info.source_principal},
+       {sourceWorkloadNameKey(), source.workload_name()},
+       {sourceWorkloadNamespaceKey(), source.namespace_()},
+       {sourceOwnerKey(), source.owner()},
+       {destinationPrincipalKey(), request_info.destination_principal},
+       {destinationWorkloadNameKey(), dest.workload_name()},
+       {destinationWorkloadNamespaceKey(), dest.namespace_()},
+       {destinationOwnerKey(), dest.owner()}});
+}
+
+// Records requests with a mix of response codes and returns the request count
+// data seen by a server request count view, as exported.
+opencensus::stats::ViewData::DataMap<int64_t> recordRequestCounts(
+    TagMapCache* cache) {
+  serverRequestCountMeasure();
+  opencensus::stats::View view(
+      opencensus::stats::ViewDescriptor()
+          .set_name("test/server/request_count")
+          .set_measure(Common::kServerRequestCountMeasure)
+          .set_aggregation(opencensus::stats::Aggregation::Sum())
+          .add_column(responseCodeKey())
+          .add_column(destinationServiceNameKey()));
+
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  for (int i = 0; i < 100; i++) {
+    request_info.response_code = i % 3 == 0 ? 503 : 200;
+    request_info.destination_service_name = i % 2 == 0 ? "foo" : "bar";
+    record(false, local, peer, request_info, cache);
+  }
+  cache->flush();
+  opencensus::stats::testing::TestUtils::Flush();
+  return view.GetData().int_data();
+}
+
+}  // namespace
+
+TEST(RecordTest, TagMapOutbound) {
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  TagMapCache cache;
+  EXPECT_EQ(cache.get(true, local, peer, request_info),
+            expectedTagMap(local, peer, local, request_info));
+}
+
+TEST(RecordTest, TagMapInbound) {
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  TagMapCache cache;
+  EXPECT_EQ(cache.get(false, local, peer, request_info),
+            expectedTagMap(peer, local, local, request_info));
+}
+
+TEST(RecordTest, TagMapGrpcOperation) {
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  request_info.request_protocol = ::Wasm::Common::kProtocolGRPC;
+  TagMapCache cache;
+  const auto& tag_map = cache.get(true, local, peer, request_info);
+  request_info.request_operation = request_info.request_url_path;
+  EXPECT_EQ(tag_map, expectedTagMap(local, peer, local, request_info));
+}
+
+TEST(RecordTest, TagMapCacheReuse) {
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  TagMapCache cache;
+  cache.get(true, local, peer, request_info);
+  cache.get(true, local, peer, request_info);
+  EXPECT_EQ(cache.size(), 1);
+
+  request_info.response_code = 503;
+  EXPECT_EQ(cache.get(true, local, peer, request_info),
+            expectedTagMap(local, peer, local, request_info));
+  EXPECT_EQ(cache.size(), 2);
+
+  cache.get(false, local, peer, request_info);
+  EXPECT_EQ(cache.size(), 3);
+}
+
+TEST(RecordTest, TagMapCacheBounded) {
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  TagMapCache cache(10);
+  for (uint32_t code = 0; code < 25; code++) {
+    request_info.response_code = code;
+    EXPECT_EQ(cache.get(true, local, peer, request_info),
+              expectedTagMap(local, peer, local, request_info));
+    EXPECT_LE(cache.size(), 10);
+  }
+}
+
+TEST(RecordTest, PreAggregatedRequestCount) {
+  TagMapCache per_request_cache(kDefaultTagMapCacheMaxSize, false);
+  const auto expected = recordRequestCounts(&per_request_cache);
+  EXPECT_EQ(expected.size(), 4);
+
+  TagMapCache aggregating_cache(kDefaultTagMapCacheMaxSize, true);
+  EXPECT_EQ(recordRequestCounts(&aggregating_cache), expected);
+}
+
+TEST(RecordTest, PreAggregatedRequestCountPendingUntilFlush) {
+  serverRequestCountMeasure();
+  opencensus::stats::View view(
+      opencensus::stats::ViewDescriptor()
+          .set_name("test/server/pending_request_count")
+          .set_measure(Common::kServerRequestCountMeasure)
+          .set_aggregation(opencensus::stats::Aggregation::Sum())
+          .add_column(responseCodeKey()));
+
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  TagMapCache cache;
+  record(false, local, peer, request_info, &cache);
+  record(false, local, peer, request_info, &cache);
+  opencensus::stats::testing::TestUtils::Flush();
+  EXPECT_TRUE(view.GetData().int_data().empty());
+
+  cache.flush();
+  opencensus::stats::testing::TestUtils::Flush();
+  const auto& data = view.GetData().int_data();
+  ASSERT_EQ(data.size(), 1);
+  EXPECT_EQ(data.begin()->first, std::vector<std::string>{"200"});
+  EXPECT_EQ(data.begin()->second, 2);
+
+  // Flushed counts are reset.
+  cache.flush();
+  opencensus::stats::testing::TestUtils::Flush();
+  EXPECT_EQ(view.GetData().int_data().begin()->second, 2);
+}
+
+TEST(RecordTest, PreAggregatedRequestCountKeptOnEviction) {
+  serverRequestCountMeasure();
+  opencensus::stats::View view(
+      opencensus::stats::ViewDescriptor()
+          .set_name("test/server/evicted_request_count")
+          .set_measure(Common::kServerRequestCountMeasure)
+          .set_aggregation(opencensus::stats::Aggregation::Sum()));
+
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  TagMapCache cache(2);
+  for (uint32_t code = 0; code < 10; code++) {
+    request_info.response_code = code;
+    record(false, local, peer, request_info, &cache);
+  }
+  cache.flush();
+  opencensus::stats::testing::TestUtils::Flush();
+  EXPECT_EQ(view.GetData().int_data().at({}), 10);
+}
+
+TEST(RecordTest, PreAggregatedRequestCountFlushedOnDestruction) {
+  serverRequestCountMeasure();
+  opencensus::stats::View view(
+      opencensus::stats::ViewDescriptor()
+          .set_name("test/server/destroyed_request_count")
+          .set_measure(Common::kServerRequestCountMeasure)
+          .set_aggregation(opencensus::stats::Aggregation::Sum()));
+
+  auto local = localNodeInfo();
+  auto peer = peerNodeInfo();
+  auto request_info = requestInfo();
+  {
+    TagMapCache cache;
+    record(false, local, peer, request_info, &cache);
+    record(false, local, peer, request_info, &cache);
+  }
+  opencensus::stats::testing::TestUtils::Flush();
+  EXPECT_EQ(view.GetData().int_data().at({}), 2);
+}
+
+}  // namespace Metric
+}  // namespace Stackdriver
+}  // namespace Extensions
@@ -83,15 +83,17 @@ StackdriverOptions getStackdriverOptions(
 /*
  *  view function macros
  */
-#define REGISTER_COUNT_VIEW(_v)                              \
-  void register##_v##View() {                                \
-    const ViewDescriptor view_descriptor =                   \
-        ViewDescriptor()                                     \
-            .set_name(k##_v##View)                           \
-            .set_measure(k##_v##Measure)                     \
-            .set_aggregation(Aggregation::Count()) ADD_TAGS; \
-    View view(view_descriptor);                              \
-    view_descriptor.RegisterForExport();                     \
+// Count views sum their measure rather than counting measurements, so that
+// request counts pre-aggregated by TagMapCache can be recorded at once.
+#define REGISTER_COUNT_VIEW(_v)                            \
+  void register##_v##View() {                              \
+    const ViewDescriptor view_descriptor =                 \
+        ViewDescriptor()                                   \
+            .set_name(k##_v##View)                         \
+            .set_measure(k##_v##Measure)                   \
+            .set_aggregation(Aggregation::Sum()) ADD_TAGS; \
+    View view(view_descriptor);                            \
+    view_descriptor.RegisterForExport();                   \
   }
 
 #define REGISTER_DISTRIBUTION_VIEW(_v)                              \
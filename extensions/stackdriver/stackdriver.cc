@@ -127,6 +127,10 @@ bool StackdriverRootContext::onConfigure(size_t) {
     auto exporter = std::make_unique<ExporterImpl>(this, getLoggingEndpoint());
     // logger takes ownership of exporter.
     logger_ = std::make_unique<Logger>(local_node_info_, std::move(exporter));
+    Metric log_entries(MetricType::Counter, "stackdriver_filter_log_entries",
+                       {MetricTag{"status", MetricTag::TagType::String}});
+    exported_log_entries_ = log_entries.resolve("exported");
+    dropped_log_entries_ = log_entries.resolve("dropped");
   }
 
   if (!edge_reporter_) {
@@ -166,15 +170,16 @@ bool StackdriverRootContext::onConfigure(size_t) {
 }
 
 bool StackdriverRootContext::onStart(size_t) {
-  if (enableServerAccessLog() || enableEdgeReporting()) {
-    proxy_set_tick_period_milliseconds(kDefaultLogExportMilliseconds);
-  }
+  // Ticks are always needed to flush pre-aggregated request counts.
+  proxy_set_tick_period_milliseconds(kDefaultLogExportMilliseconds);
   return true;
 }
 
 void StackdriverRootContext::onTick() {
+  tag_map_cache_.flush();
   if (enableServerAccessLog()) {
     logger_->exportLogEntry();
+    reportLogEntryCounts();
   }
   if (enableEdgeReporting()) {
     auto cur = static_cast<long int>(getCurrentTimeNanoseconds());
@@ -182,6 +187,7 @@ void StackdriverRootContext::onTick() {
       edge_reporter_->reportEdges();
       last_edge_report_call_nanos_ = cur;
     }
+    edge_reporter_->retryFailedRequests();
   }
 }
 
@@ -190,7 +196,8 @@ void StackdriverRootContext::record(const RequestInfo& request_info) {
   const NodeInfo& peer_node_info =
       peer_node_info_ptr ? *peer_node_info_ptr : ::Wasm::Common::EmptyNodeInfo;
   ::Extensions::Stackdriver::Metric::record(isOutbound(), local_node_info_,
-                                            peer_node_info, request_info);
+                                            peer_node_info, request_info,
+                                            &tag_map_cache_);
   if (enableServerAccessLog()) {
     logger_->addLogEntry(request_info, peer_node_info);
   }
@@ -208,6 +215,21 @@ void StackdriverRootContext::record(const RequestInfo& request_info) {
   }
 }
 
+void StackdriverRootContext::reportLogEntryCounts() {
+  const int64_t exported = logger_->exportedEntries();
+  const int64_t dropped = logger_->droppedEntries();
+  if (exported > reported_exported_log_entries_) {
+    incrementMetric(exported_log_entries_,
+                    exported - reported_exported_log_entries_);
+    reported_exported_log_entries_ = exported;
+  }
+  if (dropped > reported_dropped_log_entries_) {
+    incrementMetric(dropped_log_entries_,
+                    dropped - reported_dropped_log_entries_);
+    reported_dropped_log_entries_ = dropped;
+  }
+}
+
 inline bool StackdriverRootContext::isOutbound() {
   return direction_ == ::Wasm::Common::TrafficDirection::Outbound;
 }
@@ -82,6 +82,10 @@ class StackdriverRootContext : public RootContext {
   // Indicates whether or not to report edges to Stackdriver.
   bool enableEdgeReporting();
 
+  // Adds the log entries exported and dropped by logger since the last call to
+  // their counters.
+  void reportLogEntryCounts();
+
   // Config for Stackdriver plugin.
   stackdriver::config::v1alpha1::PluginConfig config_;
 
@@ -91,6 +95,11 @@ class StackdriverRootContext : public RootContext {
   // Cache of peer node info.
   ::Wasm::Common::NodeInfoCache node_info_cache_;
 
+  // Cache of OpenCensus tag maps and pre-aggregated request counts by metric
+  // dimensions. Counts are flushed on tick and when the root context is
+  // destroyed.
+  ::Extensions::Stackdriver::Metric::TagMapCache tag_map_cache_;
+
   // Indicates the traffic direction relative to this proxy.
   ::Wasm::Common::TrafficDirection direction_{
       ::Wasm::Common::TrafficDirection::Unspecified};
@@ -98,6 +107,13 @@ class StackdriverRootContext : public RootContext {
   // Logger records and exports log entries to Stackdriver backend.
   std::unique_ptr<::Extensions::Stackdriver::Log::Logger> logger_;
 
+  // Counters of exported and dropped log entries, and the logger totals
+  // already added to them.
+  uint32_t exported_log_entries_;
+  uint32_t dropped_log_entries_;
+  int64_t reported_exported_log_entries_ = 0;
+  int64_t reported_dropped_log_entries_ = 0;
+
   std::unique_ptr<::Extensions::Stackdriver::Edges::EdgeReporter>
       edge_reporter_;
 
@@ -17,9 +17,11 @@
 #define ISTIO_CONTROL_HTTP_CHECK_DATA_H
 
 #include <map>
+#include <set>
 #include <string>
 
 #include "google/protobuf/struct.pb.h"
+#include "src/istio/authn/context.pb.h"
 
 namespace istio {
 namespace control {
@@ -44,6 +46,10 @@ class CheckData {
   // Get request HTTP headers
   virtual std::map<std::string, std::string> GetRequestHeaders() const = 0;
 
+  // Get the request HTTP headers with the given lower case names.
+  virtual std::map<std::string, std::string> GetRequestHeaders(
+      const std::set<std::string> &names) const = 0;
+
   // Returns true if connection is mutual TLS enabled.
   virtual bool IsMutualTLS() const = 0;
 
@@ -85,6 +91,12 @@ class CheckData {
   // metadata, if available. Otherwise, returns nullptr.
   virtual const ::google::protobuf::Struct *GetAuthenticationResult() const = 0;
 
+  // Returns a pointer to the authentication result shared by the
+  // authentication filter, if available. Otherwise, returns nullptr. It is
+  // preferred over the dynamic metadata form.
+  virtual const ::istio::authn::Result *GetAuthenticationResultProto()
+      const = 0;
+
   // Get request url path, which strips query part from the http path header.
   // Return true if url path is found, otherwise return false.
   virtual bool GetUrlPath(std::string *url_path) const = 0;
@@ -16,6 +16,9 @@
 #ifndef ISTIO_CONTROL_HTTP_CONTROLLER_H
 #define ISTIO_CONTROL_HTTP_CONTROLLER_H
 
+#include <set>
+#include <string>
+
 #include "include/istio/control/http/request_handler.h"
 #include "include/istio/mixerclient/client.h"
 #include "include/istio/utils/attribute_names.h"
@@ -66,6 +69,15 @@ class Controller {
   virtual std::unique_ptr<RequestHandler> CreateRequestHandler(
       const PerRouteConfig& per_route_config) = 0;
 
+  // Selects the headers sent in the request.headers and response.headers
+  // attributes. An empty set selects all the headers.
+  struct HeaderSelection {
+    // Lower case names of the request headers.
+    std::set<std::string> request_headers;
+    // Lower case names of the response headers and trailers.
+    std::set<std::string> response_headers;
+  };
+
   // The initial data required by the Controller. It needs:
   // * client_config: the mixer client config.
   // * some functions provided by the environment (Envoy)
@@ -81,10 +93,18 @@ class Controller {
     // Some plaform functions for mixer client library.
     ::istio::mixerclient::Environment env;
 
+    // Refreshing of cached check results before they expire, disabled by
+    // default. See ::istio::mixerclient::CheckOptions.
+    uint32_t check_cache_refresh_ahead_ms{};
+    uint32_t check_cache_max_stale_ms{};
+
     // The LRU cache size for service config.
     // If not set or is 0 default value, the cache size is 1000.
     int service_config_cache_size{};
 
+    // The headers sent to Mixer, all of them by default.
+    HeaderSelection header_selection;
+
     const ::istio::utils::LocalNode& local_node;
   };
 
@@ -18,6 +18,7 @@
 
 #include <chrono>
 #include <map>
+#include <set>
 
 #include "google/protobuf/struct.pb.h"
 
@@ -34,6 +35,11 @@ class ReportData {
   // Get response HTTP headers.
   virtual std::map<std::string, std::string> GetResponseHeaders() const = 0;
 
+  // Get the response HTTP headers and trailers with the given lower case
+  // names.
+  virtual std::map<std::string, std::string> GetResponseHeaders(
+      const std::set<std::string> &names) const = 0;
+
   // Get tracing headers from HTTP request headers.
   virtual void GetTracingHeaders(
       std::map<std::string, std::string> &) const = 0;
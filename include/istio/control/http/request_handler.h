@@ -48,6 +48,8 @@ class RequestHandler {
   // * extract check attributes if not done yet.
   // * extract more report attributes
   // * make a Report call.
+  // The attributes extracted by Check() are kept and reused, check_data is
+  // only read if Check() was not called and may be nullptr otherwise.
   virtual void Report(CheckData* check_data, ReportData* report_data) = 0;
 };
 
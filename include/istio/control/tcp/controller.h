@@ -50,6 +50,11 @@ class Controller {
     // Some plaform functions for mixer client library.
     ::istio::mixerclient::Environment env;
 
+    // Refreshing of cached check results before they expire, disabled by
+    // default. See ::istio::mixerclient::CheckOptions.
+    uint32_t check_cache_refresh_ahead_ms{};
+    uint32_t check_cache_max_stale_ms{};
+
     const ::istio::utils::LocalNode& local_node;
   };
 
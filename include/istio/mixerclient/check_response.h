@@ -16,6 +16,8 @@
 #ifndef ISTIO_MIXERCLIENT_CHECK_RESPONSE_H
 #define ISTIO_MIXERCLIENT_CHECK_RESPONSE_H
 
+#include <memory>
+
 #include "google/protobuf/stubs/status.h"
 #include "mixer/v1/mixer.pb.h"
 
@@ -31,6 +33,11 @@ class CheckResponseInfo {
   virtual const ::google::protobuf::util::Status& status() const = 0;
 
   virtual const ::istio::mixer::v1::RouteDirective& routeDirective() const = 0;
+
+  // The object that owns routeDirective(). Requests served by the same cached
+  // check result share it, so state derived from the directive can be kept
+  // per owner. Empty for the default directive.
+  virtual std::shared_ptr<const void> routeDirectiveOwner() const = 0;
 };
 
 }  // namespace mixerclient
@@ -57,20 +57,23 @@ struct Statistics {
   //
   // total_check_calls = total_check_hits + total_check_misses
   // total_check_hits = total_check_hit_accepts + total_check_hit_denies
-  // total_remote_check_calls = total_check_misses
+  // total_remote_check_calls <= total_check_misses +
+  // total_remote_check_refresh_calls
+  //    ^ concurrent identical misses share one remote check
   // total_remote_check_calls >= total_remote_check_accepts +
   // total_remote_check_denies
   //    ^ Transport errors are responsible for the >=
   //
 
-  uint64_t total_check_calls_{0};              // 1.0
-  uint64_t total_check_cache_hits_{0};         // 1.1
-  uint64_t total_check_cache_misses_{0};       // 1.1
-  uint64_t total_check_cache_hit_accepts_{0};  // 1.1
-  uint64_t total_check_cache_hit_denies_{0};   // 1.1
-  uint64_t total_remote_check_calls_{0};       // 1.0
-  uint64_t total_remote_check_accepts_{0};     // 1.1
-  uint64_t total_remote_check_denies_{0};      // 1.1
+  uint64_t total_check_calls_{0};                 // 1.0
+  uint64_t total_check_cache_hits_{0};            // 1.1
+  uint64_t total_check_cache_misses_{0};          // 1.1
+  uint64_t total_check_cache_hit_accepts_{0};     // 1.1
+  uint64_t total_check_cache_hit_denies_{0};      // 1.1
+  uint64_t total_remote_check_calls_{0};          // 1.0
+  uint64_t total_remote_check_accepts_{0};        // 1.1
+  uint64_t total_remote_check_denies_{0};         // 1.1
+  uint64_t total_remote_check_refresh_calls_{0};  // 1.1
 
   //
   // Quota check counters
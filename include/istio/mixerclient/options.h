@@ -50,6 +50,15 @@ struct CheckOptions {
 
   // Max milliseconds to sleep between retries.
   uint32_t max_retry_ms{1000};
+
+  // If greater than 0, the first cache hit within this many milliseconds of
+  // the expiration of a cached result uses it and refreshes it with a
+  // remote check in the background.
+  uint32_t refresh_ahead_ms{0};
+
+  // Max milliseconds an expired cached result is still used while its
+  // background refresh is in flight. Only used with refresh_ahead_ms.
+  uint32_t max_stale_ms{0};
 };
 
 const int DEFAULT_BATCH_REPORT_MAX_ENTRIES = 100;
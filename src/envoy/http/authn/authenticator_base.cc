@@ -43,6 +43,8 @@ bool FindHeaderOfExchangedToken(const iaapi::Jwt& jwt) {
 
 }  // namespace
 
+const char PeerX509Identity::kFilterStateName[] = "istio_authn.peer_x509";
+
 AuthenticatorBase::AuthenticatorBase(FilterContext* filter_context)
     : filter_context_(*filter_context) {}
 
@@ -78,6 +80,31 @@ bool AuthenticatorBase::validateTrustDomain(
   return true;
 }
 
+PeerX509Identity& AuthenticatorBase::peerX509Identity(
+    const Network::Connection* connection) const {
+  // The HTTP filter callbacks only expose a const connection, but the filter
+  // state of the connection is shared by all its streams and is meant to be
+  // written by them.
+  StreamInfo::FilterState& filter_state =
+      const_cast<Network::Connection*>(connection)->streamInfo().filterState();
+  if (filter_state.hasData<PeerX509Identity>(
+          PeerX509Identity::kFilterStateName)) {
+    return filter_state.getDataMutable<PeerX509Identity>(
+        PeerX509Identity::kFilterStateName);
+  }
+
+  auto identity = std::make_unique<PeerX509Identity>();
+  identity->certificate_presented =
+      connection->ssl()->peerCertificatePresented();
+  identity->has_user =
+      identity->certificate_presented &&
+      Utils::GetPrincipal(connection, true, &identity->user);
+  PeerX509Identity& result = *identity;
+  filter_state.setData(PeerX509Identity::kFilterStateName, std::move(identity),
+                       StreamInfo::FilterState::StateType::Mutable);
+  return result;
+}
+
 bool AuthenticatorBase::validateX509(const iaapi::MutualTls& mtls,
                                      Payload* payload) const {
   const Network::Connection* connection = filter_context_.connection();
@@ -87,11 +114,19 @@ bool AuthenticatorBase::validateX509(const iaapi::MutualTls& mtls,
     return false;
   }
   // Always try to get principal and set to output if available.
-  const bool has_user =
-      connection->ssl() != nullptr &&
-      connection->ssl()->peerCertificatePresented() &&
-      Utils::GetPrincipal(connection, true,
-                          payload->mutable_x509()->mutable_user());
+  PeerX509Identity* identity = nullptr;
+  if (connection->ssl() != nullptr) {
+    identity = &peerX509Identity(connection);
+    // x509 is set whenever a peer certificate is presented, even if no user
+    // could be extracted from it.
+    if (identity->certificate_presented) {
+      auto* x509 = payload->mutable_x509();
+      if (identity->has_user) {
+        x509->set_user(identity->user);
+      }
+    }
+  }
+  const bool has_user = identity != nullptr && identity->has_user;
 
   ENVOY_CONN_LOG(debug, "validateX509 mode {}: ssl={}, has_user={}",
                  *connection, iaapi::MutualTls::Mode_Name(mtls.mode()),
@@ -117,11 +152,35 @@ bool AuthenticatorBase::validateX509(const iaapi::MutualTls& mtls,
   }
 
   // For TLS connection with valid certificate, validate trust domain for both
-  // PERMISSIVE and STRICT mode.
-  return validateTrustDomain(connection);
+  // PERMISSIVE and STRICT mode. The verdict is computed once per connection.
+  if (!identity->trust_domain_valid.has_value()) {
+    identity->trust_domain_valid = validateTrustDomain(connection);
+  }
+  return identity->trust_domain_valid.value();
 }
 
 bool AuthenticatorBase::validateJwt(const iaapi::Jwt& jwt, Payload* payload) {
+  // The payload from Envoy jwt_authn filter is processed without converting
+  // it to JSON and back.
+  const ProtobufWkt::Struct* jwt_payload_struct =
+      filter_context()->getJwtPayloadStruct(jwt.issuer());
+  if (jwt_payload_struct != nullptr) {
+    const ProtobufWkt::Struct* payload_to_process = jwt_payload_struct;
+    if (FindHeaderOfExchangedToken(jwt)) {
+      payload_to_process =
+          AuthnUtils::ExtractOriginalPayload(*jwt_payload_struct);
+      if (payload_to_process == nullptr) {
+        ENVOY_LOG(
+            error,
+            "Expect exchanged-token with original payload claim. Received: {}",
+            jwt_payload_struct->ShortDebugString());
+        return false;
+      }
+    }
+    return AuthnUtils::ProcessJwtPayload(*payload_to_process,
+                                         payload->mutable_jwt());
+  }
+
   std::string jwt_payload;
   if (filter_context()->getJwtPayload(jwt.issuer(), &jwt_payload)) {
     std::string payload_to_process = jwt_payload;
@@ -15,8 +15,10 @@
 
 #pragma once
 
+#include "absl/types/optional.h"
 #include "authentication/v1alpha1/policy.pb.h"
 #include "common/common/logger.h"
+#include "envoy/stream_info/filter_state.h"
 #include "src/envoy/http/authn/filter_context.h"
 #include "src/istio/authn/context.pb.h"
 
@@ -25,6 +27,21 @@ namespace Http {
 namespace Istio {
 namespace AuthN {
 
+// Peer X509 identity of a connection, saved in the filter state of the
+// connection by its first stream. The peer certificate and the trust domains
+// do not change during the life of the connection, so the other streams reuse
+// them instead of extracting them from the certificates again.
+struct PeerX509Identity : public StreamInfo::FilterState::Object {
+  // Name of the data in the filter state of the connection.
+  static const char kFilterStateName[];
+
+  bool certificate_presented{false};
+  bool has_user{false};
+  std::string user;
+  // Result of the trust domain validation, unset until it is run.
+  absl::optional<bool> trust_domain_valid;
+};
+
 // AuthenticatorBase is the base class for authenticator. It provides functions
 // to perform individual authentication methods, which can be used to construct
 // compound authentication flow.
@@ -57,6 +74,11 @@ class AuthenticatorBase : public Logger::Loggable<Logger::Id::filter> {
   FilterContext& filter_context_;
 
   bool validateTrustDomain(const Network::Connection* connection) const;
+
+  // Returns the peer identity of a TLS connection, extracted and saved in the
+  // filter state of the connection if this is the first stream to need it.
+  PeerX509Identity& peerX509Identity(
+      const Network::Connection* connection) const;
 };
 
 }  // namespace AuthN
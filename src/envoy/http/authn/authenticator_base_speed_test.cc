@@ -0,0 +1,133 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/http/header_map_impl.h"
+#include "common/stream_info/filter_state_impl.h"
+#include "envoy/config/filter/http/authn/v2alpha1/config.pb.h"
+#include "extensions/transport_sockets/tls/utility.h"
+#include "openssl/pem.h"
+#include "openssl/x509v3.h"
+#include "src/envoy/http/authn/peer_authenticator.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+
+using istio::authn::Payload;
+using istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace iaapi = istio::authentication::v1alpha1;
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+namespace {
+
+// Self-signed certificate with the URI SAN
+// spiffe://cluster.local/ns/default/sa/client.
+const char kCertificate[] = R"(-----BEGIN CERTIFICATE-----
+MIIBwTCCAWegAwIBAgIUK3iWvTl6HfQMwn+tDOPWaVNtORowCgYIKoZIzj0EAwIw
+GDEWMBQGA1UECgwNY2x1c3Rlci5sb2NhbDAgFw0yNjEwMTkwMjU2MDFaGA8yMTI2
+MDkyNTAyNTYwMVowGDEWMBQGA1UECgwNY2x1c3Rlci5sb2NhbDBZMBMGByqGSM49
+AgEGCCqGSM49AwEHA0IABHxeBiyF1sFdf2e0XN3wB9fGBM7fKTfNXu0h5cPFsK8h
+msLonHxUYZrTjC+COSfhdK9ltmW2vhK2mglW6k4blXmjgYwwgYkwHQYDVR0OBBYE
+FAcci2tmzzSnXyjlSsndDYTdT+gpMB8GA1UdIwQYMBaAFAcci2tmzzSnXyjlSsnd
+DYTdT+gpMA8GA1UdEwEB/wQFMAMBAf8wNgYDVR0RBC8wLYYrc3BpZmZlOi8vY2x1
+c3Rlci5sb2NhbC9ucy9kZWZhdWx0L3NhL2NsaWVudDAKBggqhkjOPQQDAgNIADBF
+AiBC43CU4dt3Hoozt04upOLjBAb3H43MnTxbnRUUj13exwIhAKU94fUYLMcRlKpp
+tJ4nx0cilShJ3APx82SLzs/Rd9yw
+-----END CERTIFICATE-----
+)";
+
+bssl::UniquePtr<X509> parseCertificate() {
+  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(kCertificate, -1));
+  return bssl::UniquePtr<X509>(
+      PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr));
+}
+
+}  // namespace
+
+// Peer authentication of mTLS streams, with streams_per_connection streams
+// on each connection. Like the TLS transport socket, the connection extracts
+// the SANs from the certificates every time they are asked for.
+static void BM_PeerAuthenticatorMtls(benchmark::State& state) {
+  const int64_t streams_per_connection = state.range(0);
+  const bssl::UniquePtr<X509> certificate = parseCertificate();
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  ON_CALL(*ssl, peerCertificatePresented()).WillByDefault(Return(true));
+  ON_CALL(*ssl, uriSanPeerCertificate()).WillByDefault(Invoke([&] {
+    return Extensions::TransportSockets::Tls::Utility::getSubjectAltNames(
+        *certificate, GEN_URI);
+  }));
+  ON_CALL(*ssl, uriSanLocalCertificate()).WillByDefault(Invoke([&] {
+    return Extensions::TransportSockets::Tls::Utility::getSubjectAltNames(
+        *certificate, GEN_URI);
+  }));
+
+  std::unique_ptr<StreamInfo::FilterStateImpl> filter_state;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  ON_CALL(stream_info, filterState())
+      .WillByDefault(Invoke(
+          [&]() -> StreamInfo::FilterState& { return *filter_state; }));
+  NiceMock<Network::MockConnection> connection;
+  ON_CALL(connection, ssl()).WillByDefault(Return(ssl));
+  ON_CALL(connection, streamInfo()).WillByDefault(ReturnRef(stream_info));
+
+  iaapi::Policy policy;
+  policy.add_peers()->mutable_mtls()->set_mode(iaapi::MutualTls::STRICT);
+  const FilterConfig filter_config;
+  HeaderMapImpl headers;
+
+  int64_t streams = 0;
+  for (auto _ : state) {
+    if (streams++ % streams_per_connection == 0) {
+      filter_state = std::make_unique<StreamInfo::FilterStateImpl>();
+    }
+    FilterContext filter_context(
+        envoy::api::v2::core::Metadata::default_instance(), headers,
+        &connection, filter_config);
+    PeerAuthenticator authenticator(&filter_context, policy);
+    Payload payload;
+    if (!authenticator.run(&payload)) {
+      state.SkipWithError("peer authentication failed");
+    }
+  }
+}
+BENCHMARK(BM_PeerAuthenticatorMtls)->Arg(1)->Arg(10)->Arg(100);
+
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
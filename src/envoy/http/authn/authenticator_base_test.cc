@@ -20,16 +20,19 @@
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/config/filter/http/authn/v2alpha1/config.pb.h"
 #include "gmock/gmock.h"
+#include "src/envoy/http/authn/authn_utils.h"
 #include "src/envoy/http/authn/test_utils.h"
 #include "src/envoy/utils/filter_names.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
 
 using google::protobuf::util::MessageDifferencer;
 using istio::authn::Payload;
 using istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnRef;
 using testing::StrictMock;
 
 namespace iaapi = istio::authentication::v1alpha1;
@@ -96,14 +99,27 @@ class ValidateX509Test : public testing::TestWithParam<iaapi::MutualTls::Mode>,
       filter_config_};
 
   MockAuthenticatorBase authenticator_{&filter_context_};
+  NiceMock<StreamInfo::MockStreamInfo> connection_stream_info_{};
 
   void SetUp() override {
+    ON_CALL(connection_, streamInfo())
+        .WillByDefault(ReturnRef(connection_stream_info_));
     mtls_params_.set_mode(GetParam());
     payload_ = new Payload();
   }
 
   void TearDown() override { delete (payload_); }
 
+  // Runs validateX509 for another stream of connection_.
+  bool validateX509OnNewStream(Payload* payload) {
+    Envoy::Http::HeaderMapImpl header;
+    FilterContext filter_context{
+        envoy::api::v2::core::Metadata::default_instance(), header,
+        &connection_, filter_config_};
+    MockAuthenticatorBase authenticator{&filter_context};
+    return authenticator.validateX509(mtls_params_, payload);
+  }
+
  protected:
   iaapi::MutualTls mtls_params_;
   iaapi::Jwt jwt_;
@@ -219,6 +235,83 @@ TEST_P(ValidateX509Test, SslConnectionWithPeerMalformedSpiffeCert) {
   EXPECT_EQ(payload_->x509().user(), "spiffe:foo");
 }
 
+TEST_P(ValidateX509Test, StreamsOfConnectionWithNoPeerCert) {
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  EXPECT_CALL(*ssl, peerCertificatePresented()).WillOnce(Return(false));
+  EXPECT_CALL(Const(connection_), ssl()).WillRepeatedly(Return(ssl));
+
+  const bool expected = GetParam() == iaapi::MutualTls::PERMISSIVE;
+  EXPECT_EQ(expected, authenticator_.validateX509(mtls_params_, payload_));
+  for (int i = 0; i < 3; i++) {
+    Payload payload;
+    EXPECT_EQ(expected, validateX509OnNewStream(&payload));
+    EXPECT_TRUE(MessageDifferencer::Equals(payload, default_payload_));
+  }
+}
+
+TEST_P(ValidateX509Test, StreamsOfConnectionWithSpiffeCertsSameTrustDomain) {
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  EXPECT_CALL(*ssl, peerCertificatePresented()).WillOnce(Return(true));
+  // The first stream reads the peer certificate for the principal and for the
+  // trust domain. The other streams of the connection do not read it again.
+  EXPECT_CALL(*ssl, uriSanPeerCertificate())
+      .Times(2)
+      .WillRepeatedly(Return(std::vector<std::string>{"spiffe://td/foo"}));
+  EXPECT_CALL(*ssl, uriSanLocalCertificate())
+      .WillOnce(Return(std::vector<std::string>{"spiffe://td/bar"}));
+  EXPECT_CALL(Const(connection_), ssl()).WillRepeatedly(Return(ssl));
+
+  EXPECT_TRUE(authenticator_.validateX509(mtls_params_, payload_));
+  EXPECT_EQ(payload_->x509().user(), "td/foo");
+  EXPECT_TRUE(
+      connection_stream_info_.filterState().hasData<PeerX509Identity>(
+          PeerX509Identity::kFilterStateName));
+  for (int i = 0; i < 3; i++) {
+    Payload payload;
+    EXPECT_TRUE(validateX509OnNewStream(&payload));
+    EXPECT_TRUE(MessageDifferencer::Equals(payload, *payload_));
+  }
+}
+
+TEST_P(ValidateX509Test, StreamsOfConnectionWithSpiffeCertsDiffTrustDomain) {
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  EXPECT_CALL(*ssl, peerCertificatePresented()).WillOnce(Return(true));
+  EXPECT_CALL(*ssl, uriSanPeerCertificate())
+      .Times(2)
+      .WillRepeatedly(Return(std::vector<std::string>{"spiffe://td-1/foo"}));
+  EXPECT_CALL(*ssl, uriSanLocalCertificate())
+      .WillOnce(Return(std::vector<std::string>{"spiffe://td-2/bar"}));
+  EXPECT_CALL(Const(connection_), ssl()).WillRepeatedly(Return(ssl));
+
+  // The failed trust domain validation is remembered for the connection.
+  EXPECT_FALSE(authenticator_.validateX509(mtls_params_, payload_));
+  for (int i = 0; i < 3; i++) {
+    Payload payload;
+    EXPECT_FALSE(validateX509OnNewStream(&payload));
+    EXPECT_EQ(payload.x509().user(), "td-1/foo");
+  }
+}
+
+TEST_P(ValidateX509Test, StreamsOfConnectionSkipTrustDomainValidation) {
+  google::protobuf::util::JsonParseOptions options;
+  JsonStringToMessage("{ skip_validate_trust_domain: true }", &filter_config_,
+                      options);
+
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  EXPECT_CALL(*ssl, peerCertificatePresented()).WillOnce(Return(true));
+  EXPECT_CALL(*ssl, uriSanPeerCertificate())
+      .WillOnce(Return(std::vector<std::string>{"spiffe://td-1/foo"}));
+  EXPECT_CALL(*ssl, uriSanLocalCertificate()).Times(0);
+  EXPECT_CALL(Const(connection_), ssl()).WillRepeatedly(Return(ssl));
+
+  EXPECT_TRUE(authenticator_.validateX509(mtls_params_, payload_));
+  for (int i = 0; i < 3; i++) {
+    Payload payload;
+    EXPECT_TRUE(validateX509OnNewStream(&payload));
+    EXPECT_EQ(payload.x509().user(), "td-1/foo");
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(ValidateX509Tests, ValidateX509Test,
                          testing::Values(iaapi::MutualTls::STRICT,
                                          iaapi::MutualTls::PERMISSIVE));
@@ -435,6 +528,68 @@ TEST_F(ValidateJwtTest, OriginalPayloadOfExchangedTokenNotInIntendedHeader) {
   EXPECT_TRUE(MessageDifferencer::Equals(expected_payload, *payload_));
 }
 
+TEST_F(ValidateJwtTest, EnvoyJwtFilterPayloadAvailable) {
+  jwt_.set_issuer("issuer@foo.com");
+  ProtobufWkt::Struct claims;
+  ASSERT_TRUE(Protobuf::util::JsonStringToMessage(
+                  kSecIstioAuthUserinfoHeaderValue, &claims)
+                  .ok());
+  (*(*dynamic_metadata_.mutable_filter_metadata())
+        [Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn]
+            .mutable_fields())["issuer@foo.com"]
+      .mutable_struct_value()
+      ->CopyFrom(claims);
+
+  // The payload is the same as the one processed from the JSON string of
+  // the claims.
+  std::string claims_str;
+  ASSERT_TRUE(Protobuf::util::MessageToJsonString(claims, &claims_str).ok());
+  Payload expected_payload;
+  ASSERT_TRUE(AuthnUtils::ProcessJwtPayload(claims_str,
+                                            expected_payload.mutable_jwt()));
+
+  EXPECT_TRUE(authenticator_.validateJwt(jwt_, payload_));
+  EXPECT_TRUE(MessageDifferencer::Equals(expected_payload, *payload_));
+}
+
+TEST_F(ValidateJwtTest, EnvoyJwtFilterOriginalPayload) {
+  jwt_.set_issuer("token-service");
+  jwt_.add_jwt_headers(kExchangedTokenHeaderName);
+  ProtobufWkt::Struct claims;
+  ASSERT_TRUE(
+      Protobuf::util::JsonStringToMessage(kExchangedTokenPayload, &claims)
+          .ok());
+  (*(*dynamic_metadata_.mutable_filter_metadata())
+        [Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn]
+            .mutable_fields())["token-service"]
+      .mutable_struct_value()
+      ->CopyFrom(claims);
+
+  EXPECT_TRUE(authenticator_.validateJwt(jwt_, payload_));
+  EXPECT_EQ("https://accounts.example.com/example-subject",
+            payload_->jwt().user());
+  EXPECT_EQ(3, payload_->jwt().claims().fields().size());
+  EXPECT_EQ(0, payload_->jwt().audiences_size());
+}
+
+TEST_F(ValidateJwtTest, EnvoyJwtFilterOriginalPayloadMissing) {
+  jwt_.set_issuer("token-service");
+  jwt_.add_jwt_headers(kExchangedTokenHeaderName);
+  ProtobufWkt::Struct claims;
+  ASSERT_TRUE(Protobuf::util::JsonStringToMessage(
+                  kExchangedTokenPayloadNoOriginalClaims, &claims)
+                  .ok());
+  (*(*dynamic_metadata_.mutable_filter_metadata())
+        [Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn]
+            .mutable_fields())["token-service"]
+      .mutable_struct_value()
+      ->CopyFrom(claims);
+
+  // When no original_claims in an exchanged token, the token
+  // is treated as invalid.
+  EXPECT_FALSE(authenticator_.validateJwt(jwt_, payload_));
+}
+
 }  // namespace
 }  // namespace AuthN
 }  // namespace Istio
@@ -63,6 +63,56 @@ void ExtractStringList(const std::string& key, const Envoy::Json::Object& obj,
     // Not convertable to string array
   }
 }
+
+// Same as ExtractStringList() for a claim value of the Struct payload.
+void ExtractStringList(const ProtobufWkt::Value& value,
+                       std::vector<absl::string_view>* list) {
+  switch (value.kind_case()) {
+    case ProtobufWkt::Value::kStringValue:
+      for (absl::string_view s :
+           absl::StrSplit(value.string_value(), ' ', absl::SkipEmpty())) {
+        list->push_back(s);
+      }
+      return;
+    case ProtobufWkt::Value::kListValue:
+      // Only a list of strings is extracted.
+      for (const auto& v : value.list_value().values()) {
+        if (v.kind_case() != ProtobufWkt::Value::kStringValue) {
+          return;
+        }
+      }
+      for (const auto& v : value.list_value().values()) {
+        list->push_back(v.string_value());
+      }
+      return;
+    default:
+      return;
+  }
+}
+
+// Builds the audiences, user and presenter of the payload from its claims.
+void ProcessJwtClaims(istio::authn::JwtPayload* payload) {
+  auto claims = payload->mutable_claims()->mutable_fields();
+  // Copy audience to the audience in context.proto
+  if (claims->find(kJwtAudienceKey) != claims->end()) {
+    for (const auto& v : (*claims)[kJwtAudienceKey].list_value().values()) {
+      payload->add_audiences(v.string_value());
+    }
+  }
+
+  // Build user
+  if (claims->find("iss") != claims->end() &&
+      claims->find("sub") != claims->end()) {
+    payload->set_user(
+        (*claims)["iss"].list_value().values().Get(0).string_value() + "/" +
+        (*claims)["sub"].list_value().values().Get(0).string_value());
+  }
+  // Build authorized presenter (azp)
+  if (claims->find("azp") != claims->end()) {
+    payload->set_presenter(
+        (*claims)["azp"].list_value().values().Get(0).string_value());
+  }
+}
 };  // namespace
 
 bool AuthnUtils::ProcessJwtPayload(const std::string& payload_str,
@@ -90,25 +140,39 @@ bool AuthnUtils::ProcessJwtPayload(const std::string& payload_str,
     }
     return true;
   });
-  // Copy audience to the audience in context.proto
-  if (claims->find(kJwtAudienceKey) != claims->end()) {
-    for (const auto& v : (*claims)[kJwtAudienceKey].list_value().values()) {
-      payload->add_audiences(v.string_value());
-    }
-  }
+  ProcessJwtClaims(payload);
 
-  // Build user
-  if (claims->find("iss") != claims->end() &&
-      claims->find("sub") != claims->end()) {
-    payload->set_user(
-        (*claims)["iss"].list_value().values().Get(0).string_value() + "/" +
-        (*claims)["sub"].list_value().values().Get(0).string_value());
+  return true;
+}
+
+bool AuthnUtils::ProcessJwtPayload(const ProtobufWkt::Struct& jwt_payload,
+                                   istio::authn::JwtPayload* payload) {
+  // The raw claims are still reported in their JSON form.
+  if (!Protobuf::util::MessageToJsonString(jwt_payload,
+                                           payload->mutable_raw_claims())
+           .ok()) {
+    payload->clear_raw_claims();
+    return false;
   }
-  // Build authorized presenter (azp)
-  if (claims->find("azp") != claims->end()) {
-    payload->set_presenter(
-        (*claims)["azp"].list_value().values().Get(0).string_value());
+
+  auto claims = payload->mutable_claims()->mutable_fields();
+  // Extract claims as string lists
+  std::vector<absl::string_view> list;
+  for (const auto& field : jwt_payload.fields()) {
+    // In current implementation, only string/string list objects are extracted
+    list.clear();
+    ExtractStringList(field.second, &list);
+    if (list.empty()) {
+      continue;
+    }
+    auto* values =
+        (*claims)[field.first].mutable_list_value()->mutable_values();
+    values->Reserve(static_cast<int>(list.size()));
+    for (absl::string_view s : list) {
+      values->Add()->set_string_value(s.data(), s.size());
+    }
   }
+  ProcessJwtClaims(payload);
 
   return true;
 }
@@ -143,6 +207,16 @@ bool AuthnUtils::ExtractOriginalPayload(const std::string& token,
   return true;
 }
 
+const ProtobufWkt::Struct* AuthnUtils::ExtractOriginalPayload(
+    const ProtobufWkt::Struct& token) {
+  const auto it = token.fields().find(kExchangedTokenOriginalPayload);
+  if (it == token.fields().end() ||
+      it->second.kind_case() != ProtobufWkt::Value::kStructValue) {
+    return nullptr;
+  }
+  return &it->second.struct_value();
+}
+
 bool AuthnUtils::MatchString(absl::string_view str,
                              const iaapi::StringMatch& match) {
   switch (match.match_type_case()) {
@@ -18,6 +18,7 @@
 #include "authentication/v1alpha1/policy.pb.h"
 #include "common/common/logger.h"
 #include "common/common/utility.h"
+#include "common/protobuf/protobuf.h"
 #include "envoy/http/header_map.h"
 #include "envoy/json/json_object.h"
 #include "src/istio/authn/context.pb.h"
@@ -38,12 +39,23 @@ class AuthnUtils : public Logger::Loggable<Logger::Id::filter> {
   static bool ProcessJwtPayload(const std::string& jwt_payload_str,
                                 istio::authn::JwtPayload* payload);
 
+  // Populates JwtPayload object from the JWT payload claims (which typically
+  // is the output from Envoy jwt_authn filter), without parsing them from
+  // JSON. The result is the same as for the JSON string of the claims.
+  static bool ProcessJwtPayload(const ProtobufWkt::Struct& jwt_payload,
+                                istio::authn::JwtPayload* payload);
+
   // Parses the original_payload in an exchanged JWT.
   // Returns true if original_payload can be
   // parsed successfully. Otherwise, returns false.
   static bool ExtractOriginalPayload(const std::string& token,
                                      std::string* original_payload);
 
+  // Returns the original_payload in the claims of an exchanged JWT, or
+  // nullptr if it has none.
+  static const ProtobufWkt::Struct* ExtractOriginalPayload(
+      const ProtobufWkt::Struct& token);
+
   // Returns true if str is matched to match.
   static bool MatchString(absl::string_view str,
                           const iaapi::StringMatch& match);
@@ -0,0 +1,92 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "common/protobuf/protobuf.h"
+#include "src/envoy/http/authn/authn_utils.h"
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+namespace {
+
+// JWT claims as output by Envoy jwt_authn filter: the registered claims and
+// the given number of custom claims, alternating strings and string lists.
+ProtobufWkt::Struct jwtClaims(int custom_claims) {
+  ProtobufWkt::Struct claims;
+  auto& fields = *claims.mutable_fields();
+  fields["iss"].set_string_value("https://accounts.example.com");
+  fields["sub"].set_string_value("example-subject");
+  fields["azp"].set_string_value("example-presenter");
+  fields["exp"].set_number_value(1512754205);
+  auto* aud = fields["aud"].mutable_list_value();
+  aud->add_values()->set_string_value("aud1");
+  aud->add_values()->set_string_value("aud2");
+  for (int i = 0; i < custom_claims; i++) {
+    const std::string name = "claim-" + std::to_string(i);
+    if (i % 2 == 0) {
+      fields[name].set_string_value("value-" + std::to_string(i) + " scope");
+    } else {
+      auto* list = fields[name].mutable_list_value();
+      list->add_values()->set_string_value("group-a");
+      list->add_values()->set_string_value("group-b");
+    }
+  }
+  return claims;
+}
+
+}  // namespace
+
+// The claims converted to JSON, then parsed again.
+static void BM_ProcessJwtPayloadFromJson(benchmark::State& state) {
+  const auto claims = jwtClaims(state.range(0));
+  for (auto _ : state) {
+    std::string claims_str;
+    Protobuf::util::MessageToJsonString(claims, &claims_str);
+    istio::authn::JwtPayload payload;
+    AuthnUtils::ProcessJwtPayload(claims_str, &payload);
+    benchmark::DoNotOptimize(payload);
+  }
+}
+BENCHMARK(BM_ProcessJwtPayloadFromJson)->Arg(0)->Arg(30)->Arg(300);
+
+static void BM_ProcessJwtPayloadFromStruct(benchmark::State& state) {
+  const auto claims = jwtClaims(state.range(0));
+  for (auto _ : state) {
+    istio::authn::JwtPayload payload;
+    AuthnUtils::ProcessJwtPayload(claims, &payload);
+    benchmark::DoNotOptimize(payload);
+  }
+}
+BENCHMARK(BM_ProcessJwtPayloadFromStruct)->Arg(0)->Arg(30)->Arg(300);
+
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
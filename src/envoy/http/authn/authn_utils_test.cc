@@ -249,6 +249,91 @@ TEST(AuthnUtilsTest, ProcessJwtPayloadWithAudArrayTest) {
   EXPECT_TRUE(MessageDifferencer::Equals(expected_payload, payload));
 }
 
+// Claims of all kinds, only string and string list claims are extracted.
+const std::string kJwtPayloadWithAllKinds =
+    R"(
+       {
+         "iss": "issuer@foo.com",
+         "sub": "sub@foo.com",
+         "aud": ["aud1", "aud2"],
+         "azp": "presenter@foo.com",
+         "scope": " read  write ",
+         "empty-string": "",
+         "blank-string": "   ",
+         "empty-list": [],
+         "mixed-list": ["a", 1],
+         "number": 1512754205,
+         "bool": true,
+         "null": null,
+         "object": {"iss": "nested"},
+         "unicode": "café 中文"
+       }
+     )";
+
+// Processes the claims as a Struct, and as the JSON string that used to be
+// built from the Struct.
+void ExpectSamePayloadFromStruct(const std::string& json) {
+  ProtobufWkt::Struct claims;
+  ASSERT_TRUE(Protobuf::util::JsonStringToMessage(json, &claims).ok());
+  std::string claims_str;
+  ASSERT_TRUE(Protobuf::util::MessageToJsonString(claims, &claims_str).ok());
+
+  JwtPayload expected_payload, payload;
+  EXPECT_TRUE(AuthnUtils::ProcessJwtPayload(claims_str, &expected_payload));
+  EXPECT_TRUE(AuthnUtils::ProcessJwtPayload(claims, &payload));
+  EXPECT_TRUE(MessageDifferencer::Equals(expected_payload, payload))
+      << "expected: " << expected_payload.DebugString()
+      << "actual: " << payload.DebugString();
+}
+
+TEST(AuthnUtilsTest, ProcessJwtPayloadFromStruct) {
+  ExpectSamePayloadFromStruct(kSecIstioAuthUserinfoHeaderValue);
+  ExpectSamePayloadFromStruct(kSecIstioAuthUserInfoHeaderWithAudValueList);
+  ExpectSamePayloadFromStruct(kSecIstioAuthUserInfoHeaderWithAudValueArray);
+  ExpectSamePayloadFromStruct(kJwtPayloadWithAllKinds);
+  ExpectSamePayloadFromStruct("{}");
+}
+
+TEST(AuthnUtilsTest, ProcessJwtPayloadFromStructWithAllKinds) {
+  ProtobufWkt::Struct claims;
+  ASSERT_TRUE(
+      Protobuf::util::JsonStringToMessage(kJwtPayloadWithAllKinds, &claims)
+          .ok());
+  JwtPayload payload;
+  EXPECT_TRUE(AuthnUtils::ProcessJwtPayload(claims, &payload));
+
+  EXPECT_EQ("issuer@foo.com/sub@foo.com", payload.user());
+  EXPECT_EQ("presenter@foo.com", payload.presenter());
+  EXPECT_EQ(2, payload.audiences_size());
+  const auto& fields = payload.claims().fields();
+  EXPECT_EQ(6, fields.size());
+  EXPECT_EQ(2, fields.at("scope").list_value().values_size());
+  EXPECT_EQ("write",
+            fields.at("scope").list_value().values(1).string_value());
+  EXPECT_EQ(2, fields.at("unicode").list_value().values_size());
+  EXPECT_EQ(0, fields.count("mixed-list"));
+  EXPECT_EQ(0, fields.count("object"));
+}
+
+TEST(AuthnUtilsTest, ExtractOriginalPayloadFromStruct) {
+  ProtobufWkt::Struct token;
+  ASSERT_TRUE(Protobuf::util::JsonStringToMessage(
+                  R"({"iss": "token-service",
+                      "original_claims": {"iss": "https://accounts.example.com",
+                                          "sub": "example-subject"}})",
+                  &token)
+                  .ok());
+  const ProtobufWkt::Struct* original =
+      AuthnUtils::ExtractOriginalPayload(token);
+  ASSERT_NE(nullptr, original);
+  EXPECT_EQ("example-subject", original->fields().at("sub").string_value());
+
+  (*token.mutable_fields())["original_claims"].set_string_value("invalid");
+  EXPECT_EQ(nullptr, AuthnUtils::ExtractOriginalPayload(token));
+  token.mutable_fields()->erase("original_claims");
+  EXPECT_EQ(nullptr, AuthnUtils::ExtractOriginalPayload(token));
+}
+
 TEST(AuthnUtilsTest, MatchString) {
   iaapi::StringMatch match;
   EXPECT_FALSE(AuthnUtils::MatchString(nullptr, match));
@@ -83,33 +83,40 @@ bool FilterContext::getJwtPayload(const std::string& issuer,
 
 bool FilterContext::getJwtPayloadFromEnvoyJwtFilter(
     const std::string& issuer, std::string* payload) const {
+  const ProtobufWkt::Struct* jwt_payload = getJwtPayloadStruct(issuer);
+  if (jwt_payload == nullptr) {
+    return false;
+  }
+
+  // Serialize the payload from Envoy jwt filter first before writing it to
+  // |payload|. AuthenticatorBase uses getJwtPayloadStruct() instead.
+  Protobuf::util::MessageToJsonString(*jwt_payload, payload);
+  return true;
+}
+
+const ProtobufWkt::Struct* FilterContext::getJwtPayloadStruct(
+    const std::string& issuer) const {
   // Try getting the Jwt payload from Envoy jwt_authn filter.
   auto filter_it = dynamic_metadata_.filter_metadata().find(
       Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn);
   if (filter_it == dynamic_metadata_.filter_metadata().end()) {
     ENVOY_LOG(debug, "No dynamic_metadata found for filter {}",
               Extensions::HttpFilters::HttpFilterNames::get().JwtAuthn);
-    return false;
+    return nullptr;
   }
 
   const auto& data_struct = filter_it->second;
 
   const auto entry_it = data_struct.fields().find(issuer);
   if (entry_it == data_struct.fields().end()) {
-    return false;
+    return nullptr;
   }
 
   if (entry_it->second.struct_value().fields().empty()) {
-    return false;
+    return nullptr;
   }
 
-  // Serialize the payload from Envoy jwt filter first before writing it to
-  // |payload|.
-  // TODO (pitlv2109): Return protobuf Struct instead of string, once Istio jwt
-  // filter is removed. Also need to change how Istio authn filter processes the
-  // jwt payload.
-  Protobuf::util::MessageToJsonString(entry_it->second.struct_value(), payload);
-  return true;
+  return &entry_it->second.struct_value();
 }
 
 bool FilterContext::getJwtPayloadFromIstioJwtFilter(
@@ -17,6 +17,7 @@
 
 #include "authentication/v1alpha1/policy.pb.h"
 #include "common/common/logger.h"
+#include "common/protobuf/protobuf.h"
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/config/filter/http/authn/v2alpha1/config.pb.h"
 #include "envoy/http/filter.h"
@@ -60,6 +61,12 @@ class FilterContext : public Logger::Loggable<Logger::Id::filter> {
   // Returns the authentication result.
   const istio::authn::Result& authenticationResult() { return result_; }
 
+  // Moves the authentication result out of the context, once the
+  // authentication is done.
+  istio::authn::Result releaseAuthenticationResult() {
+    return std::move(result_);
+  }
+
   // Accessor to connection
   const Network::Connection* connection() { return connection_; }
   // Accessor to the filter config
@@ -73,6 +80,11 @@ class FilterContext : public Logger::Loggable<Logger::Id::filter> {
   // returns false.
   bool getJwtPayload(const std::string& issuer, std::string* payload) const;
 
+  // Gets JWT payload claims output from Envoy jwt_authn filter for given
+  // issuer. Returns nullptr if no non-empty payload is found.
+  const ProtobufWkt::Struct* getJwtPayloadStruct(
+      const std::string& issuer) const;
+
   const HeaderMap& headerMap() const { return header_map_; }
 
  private:
@@ -40,8 +40,12 @@ struct RcDetailsValues {
 };
 typedef ConstSingleton<RcDetailsValues> RcDetails;
 
-AuthenticationFilter::AuthenticationFilter(const FilterConfig& filter_config)
-    : filter_config_(filter_config) {}
+AuthenticationFilter::AuthenticationFilter(
+    const FilterConfig& filter_config, bool save_dynamic_metadata,
+    const Istio::AuthN::TriggerRuleMatcher* trigger_rule_matcher)
+    : filter_config_(filter_config),
+      save_dynamic_metadata_(save_dynamic_metadata),
+      trigger_rule_matcher_(trigger_rule_matcher) {}
 
 AuthenticationFilter::~AuthenticationFilter() {}
 
@@ -78,14 +82,19 @@ FilterHeadersStatus AuthenticationFilter::decodeHeaders(HeaderMap& headers,
 
   // Put authentication result to headers.
   if (filter_context_ != nullptr) {
-    // Save auth results in the metadata, could be used later by RBAC and/or
-    // mixer filter.
-    ProtobufWkt::Struct data;
-    Utils::Authentication::SaveAuthAttributesToStruct(
-        filter_context_->authenticationResult(), data);
-    decoder_callbacks_->streamInfo().setDynamicMetadata(
-        Utils::IstioFilterName::kAuthentication, data);
-    ENVOY_LOG(debug, "Saved Dynamic Metadata:\n{}", data.DebugString());
+    if (save_dynamic_metadata_) {
+      // Save auth results in the metadata, could be used later by RBAC.
+      ProtobufWkt::Struct data;
+      Utils::Authentication::SaveAuthAttributesToStruct(
+          filter_context_->authenticationResult(), data);
+      decoder_callbacks_->streamInfo().setDynamicMetadata(
+          Utils::IstioFilterName::kAuthentication, data);
+      ENVOY_LOG(debug, "Saved Dynamic Metadata:\n{}", data.DebugString());
+    }
+    // Share auth results in the filter state, used later by mixer filter.
+    Utils::Authentication::SaveResultToFilterState(
+        filter_context_->releaseAuthenticationResult(),
+        decoder_callbacks_->streamInfo().filterState());
   }
   state_ = State::COMPLETE;
   return FilterHeadersStatus::Continue;
@@ -131,7 +140,7 @@ std::unique_ptr<Istio::AuthN::AuthenticatorBase>
 AuthenticationFilter::createOriginAuthenticator(
     Istio::AuthN::FilterContext* filter_context) {
   return std::make_unique<Istio::AuthN::OriginAuthenticator>(
-      filter_context, filter_config_.policy());
+      filter_context, filter_config_.policy(), trigger_rule_matcher_);
 }
 
 }  // namespace AuthN
@@ -20,6 +20,7 @@
 #include "envoy/http/filter.h"
 #include "src/envoy/http/authn/authenticator_base.h"
 #include "src/envoy/http/authn/filter_context.h"
+#include "src/envoy/http/authn/trigger_rule_matcher.h"
 
 namespace Envoy {
 namespace Http {
@@ -30,9 +31,15 @@ namespace AuthN {
 class AuthenticationFilter : public StreamDecoderFilter,
                              public Logger::Loggable<Logger::Id::filter> {
  public:
+  // The authentication result is always shared in the filter state. It is
+  // also saved in the dynamic metadata if save_dynamic_metadata is true,
+  // which filters like RBAC rely on. trigger_rule_matcher holds the compiled
+  // trigger rules of the policy in config, if not null.
   AuthenticationFilter(
       const istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig&
-          config);
+          config,
+      bool save_dynamic_metadata = true,
+      const Istio::AuthN::TriggerRuleMatcher* trigger_rule_matcher = nullptr);
   ~AuthenticationFilter();
 
   // Http::StreamFilterBase
@@ -68,6 +75,11 @@ class AuthenticationFilter : public StreamDecoderFilter,
   const istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig&
       filter_config_;
 
+  const bool save_dynamic_metadata_;
+
+  // Compiled trigger rules of the policy. Do not own.
+  const Istio::AuthN::TriggerRuleMatcher* trigger_rule_matcher_;
+
   StreamDecoderFilterCallbacks* decoder_callbacks_{};
 
   enum State { INIT, PROCESSING, COMPLETE, REJECTED };
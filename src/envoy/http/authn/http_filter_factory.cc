@@ -29,12 +29,18 @@ namespace Configuration {
 
 namespace iaapi = istio::authentication::v1alpha1;
 
+namespace {
+// Runtime key to stop saving the authentication result in the dynamic
+// metadata, once no filter (e.g. RBAC) reads it there.
+const char kSaveDynamicMetadataKey[] = "istio.authn.save_dynamic_metadata";
+}  // namespace
+
 class AuthnFilterConfig : public NamedHttpFilterConfigFactory,
                           public Logger::Loggable<Logger::Id::filter> {
  public:
   Http::FilterFactoryCb createFilterFactory(const Json::Object& config,
                                             const std::string&,
-                                            FactoryContext&) override {
+                                            FactoryContext& context) override {
     ENVOY_LOG(debug, "Called AuthnFilterConfig : {}", __func__);
     FilterConfig filter_config;
     google::protobuf::util::Status status =
@@ -48,14 +54,14 @@ class AuthnFilterConfig : public NamedHttpFilterConfigFactory,
           "is: " +
           status.ToString());
     }
-    return createFilterFactory(filter_config);
+    return createFilterFactory(filter_config, context.runtime());
   }
 
   Http::FilterFactoryCb createFilterFactoryFromProto(
       const Protobuf::Message& proto_config, const std::string&,
-      FactoryContext&) override {
+      FactoryContext& context) override {
     auto filter_config = dynamic_cast<const FilterConfig&>(proto_config);
-    return createFilterFactory(filter_config);
+    return createFilterFactory(filter_config, context.runtime());
   }
 
   ProtobufTypes::MessagePtr createEmptyConfigProto() override {
@@ -68,22 +74,30 @@ class AuthnFilterConfig : public NamedHttpFilterConfigFactory,
   }
 
  private:
-  Http::FilterFactoryCb createFilterFactory(const FilterConfig& config_pb) {
+  Http::FilterFactoryCb createFilterFactory(const FilterConfig& config_pb,
+                                            Runtime::Loader& runtime) {
     ENVOY_LOG(debug, "Called AuthnFilterConfig : {}", __func__);
     // Make it shared_ptr so that the object is still reachable when callback is
     // invoked.
     // TODO(incfly): add a test to simulate different config can be handled
     // correctly similar to multiplexing on different port.
     auto filter_config = std::make_shared<FilterConfig>(config_pb);
+    // The trigger rules are compiled once for all requests.
+    auto trigger_rule_matcher =
+        std::make_shared<Http::Istio::AuthN::TriggerRuleMatcher>(
+            filter_config->policy());
     // Print a log to remind user to upgrade to the mTLS setting. This will only
     // be called when a new config is received by Envoy.
     warnPermissiveMode(*filter_config);
-    return
-        [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-          callbacks.addStreamDecoderFilter(
-              std::make_shared<Http::Istio::AuthN::AuthenticationFilter>(
-                  *filter_config));
-        };
+    return [filter_config, trigger_rule_matcher,
+            &runtime](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+      const bool save_dynamic_metadata =
+          runtime.snapshot().getInteger(kSaveDynamicMetadataKey, 1) != 0;
+      callbacks.addStreamDecoderFilter(
+          std::make_shared<Http::Istio::AuthN::AuthenticationFilter>(
+              *filter_config, save_dynamic_metadata,
+              trigger_rule_matcher.get()));
+    };
   }
 
   void warnPermissiveMode(const FilterConfig& filter_config) {
@@ -87,8 +87,9 @@ class MockAuthenticationFilter : public AuthenticationFilter {
  public:
   // We'll use fake authenticator for test, so policy is not really needed. Use
   // default config for simplicity.
-  MockAuthenticationFilter(const FilterConfig &filter_config)
-      : AuthenticationFilter(filter_config) {}
+  MockAuthenticationFilter(const FilterConfig &filter_config,
+                           bool save_dynamic_metadata = true)
+      : AuthenticationFilter(filter_config, save_dynamic_metadata) {}
 
   ~MockAuthenticationFilter(){};
 
@@ -211,6 +212,55 @@ TEST_F(AuthenticationFilterTest, AllPass) {
   EXPECT_TRUE(TestUtility::protoEqual(expected_data, *data));
 }
 
+TEST_F(AuthenticationFilterTest, AllPassSharesResultInFilterState) {
+  EXPECT_CALL(filter_, createPeerAuthenticator(_))
+      .Times(1)
+      .WillOnce(Invoke(createAlwaysPassAuthenticator));
+  EXPECT_CALL(filter_, createOriginAuthenticator(_))
+      .Times(1)
+      .WillOnce(Invoke(createAlwaysPassAuthenticator));
+  DangerousDeprecatedTestTime test_time;
+  StreamInfo::StreamInfoImpl stream_info(Http::Protocol::Http2,
+                                         test_time.timeSystem());
+  EXPECT_CALL(decoder_callbacks_, streamInfo())
+      .Times(AtLeast(1))
+      .WillRepeatedly(ReturnRef(stream_info));
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            filter_.decodeHeaders(request_headers_, true));
+
+  const auto *result = Utils::Authentication::GetResultFromFilterState(
+      stream_info.filterState());
+  ASSERT_TRUE(result);
+  EXPECT_EQ("cluster.local/sa/test_user/ns/test_ns/", result->peer_user());
+}
+
+TEST_F(AuthenticationFilterTest, AllPassWithoutDynamicMetadata) {
+  StrictMock<MockAuthenticationFilter> filter(filter_config_, false);
+  filter.setDecoderFilterCallbacks(decoder_callbacks_);
+  EXPECT_CALL(filter, createPeerAuthenticator(_))
+      .Times(1)
+      .WillOnce(Invoke(createAlwaysPassAuthenticator));
+  EXPECT_CALL(filter, createOriginAuthenticator(_))
+      .Times(1)
+      .WillOnce(Invoke(createAlwaysPassAuthenticator));
+  DangerousDeprecatedTestTime test_time;
+  StreamInfo::StreamInfoImpl stream_info(Http::Protocol::Http2,
+                                         test_time.timeSystem());
+  EXPECT_CALL(decoder_callbacks_, streamInfo())
+      .Times(AtLeast(1))
+      .WillRepeatedly(ReturnRef(stream_info));
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            filter.decodeHeaders(request_headers_, true));
+
+  EXPECT_EQ(0, stream_info.dynamicMetadata().filter_metadata_size());
+  const auto *result = Utils::Authentication::GetResultFromFilterState(
+      stream_info.filterState());
+  ASSERT_TRUE(result);
+  EXPECT_EQ("cluster.local/sa/test_user/ns/test_ns/", result->peer_user());
+}
+
 TEST_F(AuthenticationFilterTest, IgnoreBothFail) {
   iaapi::Policy policy_;
   ASSERT_TRUE(
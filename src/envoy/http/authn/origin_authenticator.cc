@@ -38,9 +38,12 @@ bool isCORSPreflightRequest(const Http::HeaderMap& headers) {
          !headers.AccessControlRequestMethod()->value().empty();
 }
 
-OriginAuthenticator::OriginAuthenticator(FilterContext* filter_context,
-                                         const iaapi::Policy& policy)
-    : AuthenticatorBase(filter_context), policy_(policy) {}
+OriginAuthenticator::OriginAuthenticator(
+    FilterContext* filter_context, const iaapi::Policy& policy,
+    const TriggerRuleMatcher* trigger_rule_matcher)
+    : AuthenticatorBase(filter_context),
+      policy_(policy),
+      trigger_rule_matcher_(trigger_rule_matcher) {}
 
 bool OriginAuthenticator::run(Payload* payload) {
   if (policy_.origins_size() == 0 &&
@@ -75,12 +78,19 @@ bool OriginAuthenticator::run(Payload* payload) {
               "validation");
   }
 
+  TriggerRuleMatcher::Triggered should_validate;
+  if (trigger_rule_matcher_ != nullptr) {
+    should_validate = trigger_rule_matcher_->match(request_path);
+  }
+
   bool triggered = false;
   bool triggered_success = false;
-  for (const auto& method : policy_.origins()) {
-    const auto& jwt = method.jwt();
+  for (int i = 0; i < policy_.origins_size(); i++) {
+    const auto& jwt = policy_.origins(i).jwt();
 
-    if (AuthnUtils::ShouldValidateJwtPerPath(request_path, jwt)) {
+    if (trigger_rule_matcher_ != nullptr
+            ? should_validate[i]
+            : AuthnUtils::ShouldValidateJwtPerPath(request_path, jwt)) {
       ENVOY_LOG(debug, "Validating request path {} for jwt {}", request_path,
                 jwt.DebugString());
       // set triggered to true if any of the jwt trigger rule matched.
@@ -17,6 +17,7 @@
 
 #include "authentication/v1alpha1/policy.pb.h"
 #include "src/envoy/http/authn/authenticator_base.h"
+#include "src/envoy/http/authn/trigger_rule_matcher.h"
 
 namespace Envoy {
 namespace Http {
@@ -26,8 +27,12 @@ namespace AuthN {
 // OriginAuthenticator performs origin authentication for given credential rule.
 class OriginAuthenticator : public AuthenticatorBase {
  public:
-  OriginAuthenticator(FilterContext* filter_context,
-                      const istio::authentication::v1alpha1::Policy& policy);
+  // trigger_rule_matcher, if not null, holds the compiled trigger rules of
+  // the policy. Otherwise, the trigger rules are matched one by one.
+  OriginAuthenticator(
+      FilterContext* filter_context,
+      const istio::authentication::v1alpha1::Policy& policy,
+      const TriggerRuleMatcher* trigger_rule_matcher = nullptr);
 
   bool run(istio::authn::Payload*) override;
 
@@ -35,6 +40,9 @@ class OriginAuthenticator : public AuthenticatorBase {
   // Reference to the authentication policy that the authenticator should
   // enforce. Typically, the actual object is owned by filter.
   const istio::authentication::v1alpha1::Policy& policy_;
+
+  // Compiled trigger rules of the policy. Do not own.
+  const TriggerRuleMatcher* trigger_rule_matcher_;
 };
 
 }  // namespace AuthN
@@ -138,14 +138,18 @@ const char kMultipleOriginMethodWithTriggerRulePolicy[] = R"(
 class MockOriginAuthenticator : public OriginAuthenticator {
  public:
   MockOriginAuthenticator(FilterContext* filter_context,
-                          const iaapi::Policy& policy)
-      : OriginAuthenticator(filter_context, policy) {}
+                          const iaapi::Policy& policy,
+                          const TriggerRuleMatcher* trigger_rule_matcher)
+      : OriginAuthenticator(filter_context, policy, trigger_rule_matcher) {}
 
   MOCK_CONST_METHOD2(validateX509, bool(const iaapi::MutualTls&, Payload*));
   MOCK_METHOD2(validateJwt, bool(const iaapi::Jwt&, Payload*));
 };
 
-class OriginAuthenticatorTest : public testing::TestWithParam<bool> {
+// The parameters are whether a peer result is set and whether the trigger
+// rules are compiled.
+class OriginAuthenticatorTest
+    : public testing::TestWithParam<std::tuple<bool, bool>> {
  public:
   OriginAuthenticatorTest() {}
   virtual ~OriginAuthenticatorTest() {}
@@ -158,7 +162,7 @@ class OriginAuthenticatorTest : public testing::TestWithParam<bool> {
         presenter: "istio.io"
       }
     )");
-    set_peer_ = GetParam();
+    set_peer_ = std::get<0>(GetParam());
     if (set_peer_) {
       auto peer_result = TestUtilities::CreateX509Payload("bar");
       filter_context_.setPeerResult(&peer_result);
@@ -171,8 +175,11 @@ class OriginAuthenticatorTest : public testing::TestWithParam<bool> {
   void TearDown() override { delete (payload_); }
 
   void createAuthenticator() {
-    authenticator_.reset(
-        new StrictMock<MockOriginAuthenticator>(&filter_context_, policy_));
+    if (std::get<1>(GetParam())) {
+      trigger_rule_matcher_ = std::make_unique<TriggerRuleMatcher>(policy_);
+    }
+    authenticator_.reset(new StrictMock<MockOriginAuthenticator>(
+        &filter_context_, policy_, trigger_rule_matcher_.get()));
   }
 
  protected:
@@ -184,6 +191,7 @@ class OriginAuthenticatorTest : public testing::TestWithParam<bool> {
       istio::envoy::config::filter::http::authn::v2alpha1::FilterConfig::
           default_instance()};
   iaapi::Policy policy_;
+  std::unique_ptr<TriggerRuleMatcher> trigger_rule_matcher_;
 
   Payload* payload_;
 
@@ -454,7 +462,7 @@ TEST_P(OriginAuthenticatorTest, PeerBindingFail) {
 }
 
 INSTANTIATE_TEST_SUITE_P(OriginAuthenticatorTests, OriginAuthenticatorTest,
-                         testing::Bool());
+                         testing::Combine(testing::Bool(), testing::Bool()));
 
 }  // namespace
 }  // namespace AuthN
@@ -0,0 +1,228 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/authn/trigger_rule_matcher.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
+#include "envoy/common/exception.h"
+
+namespace iaapi = istio::authentication::v1alpha1;
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+namespace {
+
+// Paths are matched byte by byte, as std::regex does.
+re2::RE2::Options regexOptions() {
+  re2::RE2::Options options;
+  options.set_encoding(re2::RE2::Options::EncodingLatin1);
+  options.set_log_errors(false);
+  return options;
+}
+
+char charAt(absl::string_view str, size_t i, bool reversed) {
+  return reversed ? str[str.size() - 1 - i] : str[i];
+}
+
+// Returns the position of the first child of children not less than c.
+size_t lowerBound(const std::vector<std::pair<char, uint32_t>>& children,
+                  char c) {
+  return std::lower_bound(children.begin(), children.end(), c,
+                          [](const std::pair<char, uint32_t>& child,
+                             char value) { return child.first < value; }) -
+         children.begin();
+}
+
+// Bits of the per rule state in TriggerRuleMatcher::match().
+constexpr uint8_t kIncludedMatched = 1;
+constexpr uint8_t kExcludedMatched = 2;
+
+}  // namespace
+
+PathMatcher::Trie::Trie() : nodes_(1) {}
+
+void PathMatcher::Trie::add(absl::string_view key, uint32_t id,
+                            bool reversed) {
+  uint32_t node = 0;
+  for (size_t i = 0; i < key.size(); i++) {
+    const char c = charAt(key, i, reversed);
+    auto& children = nodes_[node].children;
+    const size_t pos = lowerBound(children, c);
+    if (pos == children.size() || children[pos].first != c) {
+      const uint32_t child = nodes_.size();
+      // Growing nodes_ invalidates children, so update it first.
+      children.emplace(children.begin() + pos, c, child);
+      nodes_.emplace_back();
+      node = child;
+    } else {
+      node = children[pos].second;
+    }
+  }
+  nodes_[node].ids.push_back(id);
+}
+
+void PathMatcher::Trie::match(
+    absl::string_view str, bool reversed,
+    const std::function<void(uint32_t)>& on_match) const {
+  uint32_t node = 0;
+  for (size_t i = 0;; i++) {
+    for (uint32_t id : nodes_[node].ids) {
+      on_match(id);
+    }
+    if (i == str.size()) {
+      return;
+    }
+    const char c = charAt(str, i, reversed);
+    const auto& children = nodes_[node].children;
+    const size_t pos = lowerBound(children, c);
+    if (pos == children.size() || children[pos].first != c) {
+      return;
+    }
+    node = children[pos].second;
+  }
+}
+
+PathMatcher::PathMatcher()
+    : regexes_(regexOptions(), re2::RE2::ANCHOR_BOTH) {}
+
+void PathMatcher::add(const iaapi::StringMatch& pattern, uint32_t id) {
+  switch (pattern.match_type_case()) {
+    case iaapi::StringMatch::kExact:
+      exact_[pattern.exact()].push_back(id);
+      break;
+    case iaapi::StringMatch::kPrefix:
+      prefixes_.add(pattern.prefix(), id, false);
+      break;
+    case iaapi::StringMatch::kSuffix:
+      suffixes_.add(pattern.suffix(), id, true);
+      break;
+    case iaapi::StringMatch::kRegex: {
+      std::string error;
+      if (regexes_.Add(pattern.regex(), &error) >= 0) {
+        regex_ids_.push_back(id);
+        break;
+      }
+      try {
+        std_regexes_.emplace_back(std::regex(pattern.regex()), id);
+      } catch (const std::regex_error& e) {
+        // A trigger rule that never matches could skip JWT validation, so
+        // the config is rejected instead.
+        throw EnvoyException(absl::StrCat(
+            "Invalid regex ", pattern.regex(), " in trigger rule: ", e.what()));
+      }
+      break;
+    }
+    default:
+      // A pattern without match type never matches.
+      break;
+  }
+}
+
+void PathMatcher::compile() {
+  if (!regex_ids_.empty() && !regexes_.Compile()) {
+    // Compile() only fails when RE2 runs out of memory.
+    throw EnvoyException("Failed to compile the regexes of trigger rules");
+  }
+}
+
+void PathMatcher::match(absl::string_view path,
+                        const std::function<void(uint32_t)>& on_match) const {
+  const auto exact_it = exact_.find(path);
+  if (exact_it != exact_.end()) {
+    for (uint32_t id : exact_it->second) {
+      on_match(id);
+    }
+  }
+  prefixes_.match(path, false, on_match);
+  suffixes_.match(path, true, on_match);
+  if (!regex_ids_.empty()) {
+    std::vector<int> matched;
+    if (regexes_.Match(re2::StringPiece(path.data(), path.size()),
+                       &matched)) {
+      for (int index : matched) {
+        on_match(regex_ids_[index]);
+      }
+    }
+  }
+  if (!std_regexes_.empty()) {
+    const std::string path_str(path);
+    for (const auto& regex : std_regexes_) {
+      if (std::regex_match(path_str, regex.first)) {
+        on_match(regex.second);
+      }
+    }
+  }
+}
+
+TriggerRuleMatcher::TriggerRuleMatcher(const iaapi::Policy& policy) {
+  for (const auto& method : policy.origins()) {
+    const uint32_t begin = rule_has_included_.size();
+    for (const auto& rule : method.jwt().trigger_rules()) {
+      const uint32_t index = rule_has_included_.size();
+      rule_has_included_.push_back(rule.included_paths_size() > 0);
+      for (const auto& included : rule.included_paths()) {
+        matcher_.add(included, 2 * index);
+      }
+      for (const auto& excluded : rule.excluded_paths()) {
+        matcher_.add(excluded, 2 * index + 1);
+      }
+    }
+    origin_rules_.emplace_back(begin, rule_has_included_.size());
+  }
+  matcher_.compile();
+}
+
+TriggerRuleMatcher::Triggered TriggerRuleMatcher::match(
+    absl::string_view path) const {
+  // Like AuthnUtils::ShouldValidateJwtPerPath(), every JWT is validated for
+  // an empty path.
+  Triggered triggered(origin_rules_.size(), true);
+  if (path.empty() || rule_has_included_.empty()) {
+    return triggered;
+  }
+
+  absl::InlinedVector<uint8_t, 32> rules(rule_has_included_.size(), 0);
+  matcher_.match(path, [&rules](uint32_t id) {
+    rules[id / 2] |= (id % 2 == 0) ? kIncludedMatched : kExcludedMatched;
+  });
+
+  for (size_t i = 0; i < origin_rules_.size(); i++) {
+    const auto& range = origin_rules_[i];
+    if (range.first == range.second) {
+      // A JWT without trigger rules is always validated.
+      continue;
+    }
+    // A rule is matched if none of its excluded paths matched, and one of its
+    // included paths matched or it has none.
+    bool matched = false;
+    for (uint32_t rule = range.first; rule < range.second && !matched;
+         rule++) {
+      matched = (rules[rule] & kExcludedMatched) == 0 &&
+                (!rule_has_included_[rule] ||
+                 (rules[rule] & kIncludedMatched) != 0);
+    }
+    triggered[i] = matched;
+  }
+  return triggered;
+}
+
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
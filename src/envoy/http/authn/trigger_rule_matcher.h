@@ -0,0 +1,119 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+#include "authentication/v1alpha1/policy.pb.h"
+#include "re2/set.h"
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+
+// PathMatcher matches a path against many StringMatch patterns at once. Exact
+// patterns are kept in a hash map, prefixes in a trie, suffixes in a trie of
+// the reversed suffixes and regexes in a RE2 set, so the cost of a match
+// depends on the length of the path rather than on the number of patterns.
+class PathMatcher {
+ public:
+  PathMatcher();
+
+  // Adds a pattern, reported as id when it matches. Patterns must be added
+  // before compile() is called. Throws EnvoyException if a regex is invalid.
+  void add(const istio::authentication::v1alpha1::StringMatch& pattern,
+           uint32_t id);
+
+  // Prepares the added patterns for matching.
+  void compile();
+
+  // Calls on_match with the id of every pattern matching path, in no
+  // particular order.
+  void match(absl::string_view path,
+             const std::function<void(uint32_t)>& on_match) const;
+
+ private:
+  // Trie of keys, which finds the keys that are a prefix of a string, or a
+  // suffix of it if the keys are added and looked up reversed.
+  class Trie {
+   public:
+    Trie();
+
+    void add(absl::string_view key, uint32_t id, bool reversed);
+    void match(absl::string_view str, bool reversed,
+               const std::function<void(uint32_t)>& on_match) const;
+
+   private:
+    struct Node {
+      // Ids of the keys ending at this node.
+      std::vector<uint32_t> ids;
+      // Children sorted by their character.
+      std::vector<std::pair<char, uint32_t>> children;
+    };
+    // The root is nodes_[0].
+    std::vector<Node> nodes_;
+  };
+
+  absl::flat_hash_map<std::string, std::vector<uint32_t>> exact_;
+  Trie prefixes_;
+  Trie suffixes_;
+  re2::RE2::Set regexes_;
+  // The id of each regex in regexes_.
+  std::vector<uint32_t> regex_ids_;
+  // Regexes RE2 cannot compile, such as those with lookarounds or back
+  // references, which are matched with std::regex.
+  std::vector<std::pair<std::regex, uint32_t>> std_regexes_;
+};
+
+// TriggerRuleMatcher holds the trigger rules of the JWT origin methods of a
+// policy, compiled once per filter config.
+class TriggerRuleMatcher {
+ public:
+  // Whether the JWT of each origin method should be validated, in the order
+  // of the origins in the policy.
+  using Triggered = absl::InlinedVector<bool, 4>;
+
+  // Throws EnvoyException if a trigger rule has an invalid regex.
+  TriggerRuleMatcher(const istio::authentication::v1alpha1::Policy& policy);
+
+  // Returns for each origin method of the policy the same as
+  // AuthnUtils::ShouldValidateJwtPerPath(path, jwt) for its JWT.
+  Triggered match(absl::string_view path) const;
+
+ private:
+  // Whether each trigger rule has included paths, one of which must match.
+  std::vector<bool> rule_has_included_;
+  // The range of trigger rules of each origin method.
+  std::vector<std::pair<uint32_t, uint32_t>> origin_rules_;
+  // The paths of the trigger rules. The id of an included path of the i-th
+  // rule is 2 * i and that of an excluded path 2 * i + 1.
+  PathMatcher matcher_;
+};
+
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
@@ -0,0 +1,97 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "authentication/v1alpha1/policy.pb.h"
+#include "benchmark/benchmark.h"
+#include "src/envoy/http/authn/authn_utils.h"
+#include "src/envoy/http/authn/trigger_rule_matcher.h"
+
+namespace iaapi = istio::authentication::v1alpha1;
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+namespace {
+
+// The path of a request matching none of the rules.
+const char kPath[] = "/api/v1/namespaces/default/pods/productpage-v1?watch=1";
+
+// A policy with a JWT origin method and num_rules trigger rules. Each rule
+// includes an exact path, a prefix and a suffix, and excludes a path; every
+// tenth rule also includes a regex.
+iaapi::Policy makePolicy(int num_rules) {
+  iaapi::Policy policy;
+  auto* jwt = policy.add_origins()->mutable_jwt();
+  jwt->set_issuer("issuer@istio.io");
+  for (int i = 0; i < num_rules; i++) {
+    auto* rule = jwt->add_trigger_rules();
+    rule->add_included_paths()->set_exact(absl::StrCat("/service-", i));
+    rule->add_included_paths()->set_prefix(absl::StrCat("/api/v", i + 2));
+    rule->add_included_paths()->set_suffix(absl::StrCat("/resource-", i));
+    rule->add_excluded_paths()->set_exact(
+        absl::StrCat("/service-", i, "/health"));
+    if (i % 10 == 0) {
+      rule->add_included_paths()->set_regex(
+          absl::StrCat("/regex-", i, "/[a-z]+/[0-9]+"));
+    }
+  }
+  return policy;
+}
+
+}  // namespace
+
+// Matches the trigger rules one by one, as done for every request before.
+static void BM_ShouldValidateJwtPerPath(benchmark::State& state) {
+  const iaapi::Policy policy = makePolicy(state.range(0));
+  for (auto _ : state) {
+    bool triggered = false;
+    for (const auto& method : policy.origins()) {
+      triggered |= AuthnUtils::ShouldValidateJwtPerPath(kPath, method.jwt());
+    }
+    benchmark::DoNotOptimize(triggered);
+  }
+}
+BENCHMARK(BM_ShouldValidateJwtPerPath)->Arg(10)->Arg(100)->Arg(1000);
+
+// Matches the trigger rules compiled once.
+static void BM_TriggerRuleMatcher(benchmark::State& state) {
+  const iaapi::Policy policy = makePolicy(state.range(0));
+  const TriggerRuleMatcher matcher(policy);
+  for (auto _ : state) {
+    auto triggered = matcher.match(kPath);
+    benchmark::DoNotOptimize(triggered);
+  }
+}
+BENCHMARK(BM_TriggerRuleMatcher)->Arg(10)->Arg(100)->Arg(1000);
+
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
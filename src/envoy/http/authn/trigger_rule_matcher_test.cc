@@ -0,0 +1,232 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/authn/trigger_rule_matcher.h"
+
+#include "authentication/v1alpha1/policy.pb.h"
+#include "common/protobuf/protobuf.h"
+#include "gtest/gtest.h"
+#include "src/envoy/http/authn/authn_utils.h"
+#include "test/test_common/utility.h"
+
+namespace iaapi = istio::authentication::v1alpha1;
+
+namespace Envoy {
+namespace Http {
+namespace Istio {
+namespace AuthN {
+namespace {
+
+const char kPolicy[] = R"(
+  origins {
+    jwt {
+      issuer: "no-rules@istio.io"
+    }
+  }
+  origins {
+    jwt {
+      issuer: "rules@istio.io"
+      trigger_rules {
+        excluded_paths {
+          exact: "/health"
+        }
+        excluded_paths {
+          prefix: "/public/"
+        }
+        included_paths {
+          prefix: "/api/"
+        }
+        included_paths {
+          suffix: ".json"
+        }
+      }
+      trigger_rules {
+        included_paths {
+          regex: "/admin/[0-9]+"
+        }
+      }
+    }
+  }
+  origins {
+    jwt {
+      issuer: "exclude-only@istio.io"
+      trigger_rules {
+        excluded_paths {
+          suffix: "/metrics"
+        }
+      }
+    }
+  }
+)";
+
+// Returns the result of the matcher for path, and expects it to be the same
+// as that of the trigger rules matched one by one.
+TriggerRuleMatcher::Triggered match(const iaapi::Policy& policy,
+                                    absl::string_view path) {
+  const TriggerRuleMatcher matcher(policy);
+  const auto triggered = matcher.match(path);
+  EXPECT_EQ(triggered.size(), static_cast<size_t>(policy.origins_size()));
+  for (int i = 0; i < policy.origins_size(); i++) {
+    EXPECT_EQ(triggered[i], AuthnUtils::ShouldValidateJwtPerPath(
+                                path, policy.origins(i).jwt()))
+        << "origin " << i << ", path " << path;
+  }
+  return triggered;
+}
+
+// Returns whether jwt should be validated for path.
+bool shouldValidate(const iaapi::Jwt& jwt, absl::string_view path) {
+  iaapi::Policy policy;
+  *policy.add_origins()->mutable_jwt() = jwt;
+  return match(policy, path)[0];
+}
+
+TEST(TriggerRuleMatcherTest, NoOrigins) {
+  EXPECT_TRUE(TriggerRuleMatcher(iaapi::Policy()).match("/").empty());
+}
+
+TEST(TriggerRuleMatcherTest, Default) {
+  iaapi::Jwt jwt;
+
+  // Always trigger when path is unavailable.
+  EXPECT_TRUE(shouldValidate(jwt, ""));
+
+  // Always trigger when there is no rules in jwt.
+  EXPECT_TRUE(shouldValidate(jwt, "/test"));
+
+  // Add a rule that triggers on everything except /hello.
+  jwt.add_trigger_rules()->add_excluded_paths()->set_exact("/hello");
+  EXPECT_TRUE(shouldValidate(jwt, ""));
+  EXPECT_FALSE(shouldValidate(jwt, "/hello"));
+  EXPECT_TRUE(shouldValidate(jwt, "/other"));
+
+  // Add another rule that triggers on path /hello.
+  jwt.add_trigger_rules()->add_included_paths()->set_exact("/hello");
+  EXPECT_TRUE(shouldValidate(jwt, "/hello"));
+  EXPECT_TRUE(shouldValidate(jwt, "/other"));
+}
+
+TEST(TriggerRuleMatcherTest, Excluded) {
+  iaapi::Jwt jwt;
+
+  // Create a rule that triggers on everything except /good-x and /allow-x.
+  auto* rule = jwt.add_trigger_rules();
+  rule->add_excluded_paths()->set_exact("/good-x");
+  rule->add_excluded_paths()->set_exact("/allow-x");
+  EXPECT_FALSE(shouldValidate(jwt, "/good-x"));
+  EXPECT_FALSE(shouldValidate(jwt, "/allow-x"));
+  EXPECT_TRUE(shouldValidate(jwt, "/good-1"));
+  EXPECT_TRUE(shouldValidate(jwt, "/allow-1"));
+  EXPECT_TRUE(shouldValidate(jwt, "/other"));
+
+  // Change the rule to only triggers on prefix /good and /allow.
+  rule->add_included_paths()->set_prefix("/good");
+  rule->add_included_paths()->set_prefix("/allow");
+  EXPECT_FALSE(shouldValidate(jwt, "/good-x"));
+  EXPECT_FALSE(shouldValidate(jwt, "/allow-x"));
+  EXPECT_TRUE(shouldValidate(jwt, "/good-1"));
+  EXPECT_TRUE(shouldValidate(jwt, "/allow-1"));
+  EXPECT_FALSE(shouldValidate(jwt, "/other"));
+}
+
+TEST(TriggerRuleMatcherTest, MatchTypes) {
+  iaapi::Jwt jwt;
+  auto* rule = jwt.add_trigger_rules();
+  rule->add_included_paths()->set_exact("/exact");
+  rule->add_included_paths()->set_prefix("/prefix");
+  rule->add_included_paths()->set_suffix("suffix");
+  rule->add_included_paths()->set_regex("/[a-c]+-[0-9]{2}");
+  // A pattern without match type never matches.
+  rule->add_included_paths();
+
+  EXPECT_TRUE(shouldValidate(jwt, "/exact"));
+  EXPECT_FALSE(shouldValidate(jwt, "/exact/"));
+  EXPECT_FALSE(shouldValidate(jwt, "/exac"));
+  EXPECT_TRUE(shouldValidate(jwt, "/prefix"));
+  EXPECT_TRUE(shouldValidate(jwt, "/prefix/more"));
+  EXPECT_FALSE(shouldValidate(jwt, "/prefi"));
+  EXPECT_TRUE(shouldValidate(jwt, "suffix"));
+  EXPECT_TRUE(shouldValidate(jwt, "/a/suffix"));
+  EXPECT_FALSE(shouldValidate(jwt, "/suffix/"));
+  EXPECT_TRUE(shouldValidate(jwt, "/abc-12"));
+  // The regex must match the whole path.
+  EXPECT_FALSE(shouldValidate(jwt, "/abc-123"));
+  EXPECT_FALSE(shouldValidate(jwt, "/x/abc-12"));
+  EXPECT_FALSE(shouldValidate(jwt, "/other"));
+}
+
+TEST(TriggerRuleMatcherTest, EmptyPrefixAndSuffix) {
+  iaapi::Jwt jwt;
+  jwt.add_trigger_rules()->add_excluded_paths()->set_prefix("");
+  EXPECT_FALSE(shouldValidate(jwt, "/any"));
+
+  jwt.mutable_trigger_rules(0)->mutable_excluded_paths(0)->set_suffix("");
+  EXPECT_FALSE(shouldValidate(jwt, "/any"));
+}
+
+TEST(TriggerRuleMatcherTest, OverlappingPrefixes) {
+  iaapi::Jwt jwt;
+  auto* rule = jwt.add_trigger_rules();
+  rule->add_included_paths()->set_prefix("/a");
+  rule->add_excluded_paths()->set_prefix("/a/b");
+  EXPECT_TRUE(shouldValidate(jwt, "/a"));
+  EXPECT_TRUE(shouldValidate(jwt, "/a/c"));
+  EXPECT_FALSE(shouldValidate(jwt, "/a/b"));
+  EXPECT_FALSE(shouldValidate(jwt, "/a/bc"));
+  EXPECT_FALSE(shouldValidate(jwt, "/b"));
+}
+
+TEST(TriggerRuleMatcherTest, RegexNotSupportedByRe2) {
+  iaapi::Jwt jwt;
+  // Back references are only supported by std::regex.
+  jwt.add_trigger_rules()->add_included_paths()->set_regex("/(a+)/\\1");
+  EXPECT_TRUE(shouldValidate(jwt, "/aa/aa"));
+  EXPECT_FALSE(shouldValidate(jwt, "/aa/a"));
+}
+
+TEST(TriggerRuleMatcherTest, InvalidRegex) {
+  iaapi::Policy policy;
+  policy.add_origins()
+      ->mutable_jwt()
+      ->add_trigger_rules()
+      ->add_included_paths()
+      ->set_regex("/[a");
+  // An invalid regex rejects the policy rather than never matching.
+  EXPECT_THROW_WITH_REGEX(TriggerRuleMatcher matcher(policy), EnvoyException,
+                          "Invalid regex /\\[a in trigger rule");
+}
+
+TEST(TriggerRuleMatcherTest, MultipleOrigins) {
+  iaapi::Policy policy;
+  ASSERT_TRUE(Protobuf::TextFormat::ParseFromString(kPolicy, &policy));
+
+  using Triggered = TriggerRuleMatcher::Triggered;
+  EXPECT_EQ(match(policy, ""), Triggered({true, true, true}));
+  EXPECT_EQ(match(policy, "/api/v1"), Triggered({true, true, true}));
+  EXPECT_EQ(match(policy, "/data.json"), Triggered({true, true, true}));
+  EXPECT_EQ(match(policy, "/health"), Triggered({true, false, true}));
+  EXPECT_EQ(match(policy, "/public/data.json"),
+            Triggered({true, false, true}));
+  EXPECT_EQ(match(policy, "/admin/12"), Triggered({true, true, true}));
+  EXPECT_EQ(match(policy, "/admin/x"), Triggered({true, false, true}));
+  EXPECT_EQ(match(policy, "/api/metrics"), Triggered({true, true, false}));
+  EXPECT_EQ(match(policy, "/metrics"), Triggered({true, false, false}));
+}
+
+}  // namespace
+}  // namespace AuthN
+}  // namespace Istio
+}  // namespace Http
+}  // namespace Envoy
@@ -31,7 +31,6 @@
 #include "openssl/ecdsa.h"
 #include "openssl/evp.h"
 #include "openssl/rsa.h"
-#include "openssl/sha.h"
 
 namespace Envoy {
 namespace Http {
@@ -327,57 +326,66 @@ Jwt::Jwt(const std::string &jwt) {
   }
 }
 
-bool Verifier::VerifySignatureRSA(EVP_PKEY *key, const EVP_MD *md,
-                                  const uint8_t *signature,
-                                  size_t signature_len,
-                                  const uint8_t *signed_data,
-                                  size_t signed_data_len) {
-  bssl::UniquePtr<EVP_MD_CTX> md_ctx(EVP_MD_CTX_create());
+namespace {
 
-  if (EVP_DigestVerifyInit(md_ctx.get(), nullptr, md, nullptr, key) != 1) {
-    return false;
-  }
-  if (EVP_DigestVerifyUpdate(md_ctx.get(), signed_data, signed_data_len) != 1) {
-    return false;
+// Digest of the signed data of a JWT, computed on first use.
+class SignedDataDigest {
+ public:
+  SignedDataDigest(const EVP_MD *md, const std::string &signed_data)
+      : md_(md), signed_data_(signed_data) {}
+
+  // Returns false if the digest cannot be computed.
+  bool Get(const uint8_t **digest, size_t *digest_len) {
+    if (!computed_) {
+      computed_ = true;
+      ok_ = Compute();
+    }
+    *digest = digest_;
+    *digest_len = digest_len_;
+    return ok_;
   }
-  return (EVP_DigestVerifyFinal(md_ctx.get(), signature, signature_len) == 1);
-}
-
-bool Verifier::VerifySignatureRSA(EVP_PKEY *key, const EVP_MD *md,
-                                  const std::string &signature,
-                                  const std::string &signed_data) {
-  return VerifySignatureRSA(key, md, CastToUChar(signature), signature.length(),
-                            CastToUChar(signed_data), signed_data.length());
-}
 
-bool Verifier::VerifySignatureEC(EC_KEY *key, const uint8_t *signature,
-                                 size_t signature_len,
-                                 const uint8_t *signed_data,
-                                 size_t signed_data_len) {
-  // ES256 signature should be 64 bytes.
-  if (signature_len != 2 * 32) {
-    return false;
+ private:
+  bool Compute() {
+    // The digest context of each thread is reused, which saves allocating
+    // its state for every JWT.
+    static thread_local bssl::UniquePtr<EVP_MD_CTX> md_ctx(EVP_MD_CTX_new());
+    unsigned int len = 0;
+    if (!md_ctx || EVP_DigestInit_ex(md_ctx.get(), md_, nullptr) != 1 ||
+        EVP_DigestUpdate(md_ctx.get(), signed_data_.data(),
+                         signed_data_.size()) != 1 ||
+        EVP_DigestFinal_ex(md_ctx.get(), digest_, &len) != 1) {
+      return false;
+    }
+    digest_len_ = len;
+    return true;
   }
 
-  uint8_t digest[SHA256_DIGEST_LENGTH];
-  SHA256(signed_data, signed_data_len, digest);
+  const EVP_MD *md_;
+  const std::string &signed_data_;
+  bool computed_ = false;
+  bool ok_ = false;
+  uint8_t digest_[EVP_MAX_MD_SIZE];
+  size_t digest_len_ = 0;
+};
+
+}  // namespace
 
-  bssl::UniquePtr<ECDSA_SIG> ecdsa_sig(ECDSA_SIG_new());
-  if (!ecdsa_sig) {
-    UpdateStatus(Status::FAILED_CREATE_ECDSA_SIGNATURE);
+bool Verifier::VerifySignatureRSA(EVP_PKEY *key, const EVP_MD *md,
+                                  const uint8_t *digest, size_t digest_len,
+                                  const std::string &signature) {
+  RSA *rsa = EVP_PKEY_get0_RSA(key);
+  if (rsa == nullptr) {
     return false;
   }
-
-  BN_bin2bn(signature, 32, ecdsa_sig->r);
-  BN_bin2bn(signature + 32, 32, ecdsa_sig->s);
-  return (ECDSA_do_verify(digest, SHA256_DIGEST_LENGTH, ecdsa_sig.get(), key) ==
-          1);
+  return RSA_verify(EVP_MD_type(md), digest, digest_len,
+                    CastToUChar(signature), signature.length(), rsa) == 1;
 }
 
-bool Verifier::VerifySignatureEC(EC_KEY *key, const std::string &signature,
-                                 const std::string &signed_data) {
-  return VerifySignatureEC(key, CastToUChar(signature), signature.length(),
-                           CastToUChar(signed_data), signed_data.length());
+bool Verifier::VerifySignatureEC(EC_KEY *key, const uint8_t *digest,
+                                 size_t digest_len,
+                                 const ECDSA_SIG *signature) {
+  return ECDSA_do_verify(digest, digest_len, signature, key) == 1;
 }
 
 bool Verifier::Verify(const Jwt &jwt, const Pubkeys &pubkeys) {
@@ -395,41 +403,82 @@ bool Verifier::Verify(const Jwt &jwt, const Pubkeys &pubkeys) {
 
   std::string signed_data =
       jwt.header_str_base64url_ + '.' + jwt.payload_str_base64url_;
-  bool kid_alg_matched = false;
-  for (auto &pubkey : pubkeys.keys_) {
-    // If kid is specified in JWT, JWK with the same kid is used for
-    // verification.
-    // If kid is not specified in JWT, try all JWK.
-    if (jwt.kid_ != "" && pubkey->kid_specified_ && pubkey->kid_ != jwt.kid_) {
-      continue;
-    }
 
+  const EVP_MD *md;
+  if (jwt.alg_ == "RS384") {
+    md = EVP_sha384();
+  } else if (jwt.alg_ == "RS512") {
+    md = EVP_sha512();
+  } else {
+    // default to SHA256
+    md = EVP_sha256();
+  }
+  // The digests and the EC signature are shared by all the keys tried.
+  SignedDataDigest rsa_digest(md, signed_data);
+  SignedDataDigest ec_digest(EVP_sha256(), signed_data);
+  bssl::UniquePtr<ECDSA_SIG> ecdsa_sig;
+  const uint8_t *digest;
+  size_t digest_len;
+
+  bool kid_alg_matched = false;
+  auto verify = [&](const Pubkeys::Pubkey &pubkey) {
     // The same alg must be used.
-    if (pubkey->alg_specified_ && pubkey->alg_ != jwt.alg_) {
-      continue;
+    if (pubkey.alg_specified_ && pubkey.alg_ != jwt.alg_) {
+      return false;
     }
     kid_alg_matched = true;
 
-    if (pubkey->kty_ == "EC" &&
-        VerifySignatureEC(pubkey->ec_key_.get(), jwt.signature_, signed_data)) {
-      // Verification succeeded.
-      return true;
-    } else if (pubkey->pem_format_ || pubkey->kty_ == "RSA") {
-      const EVP_MD *md;
-      if (jwt.alg_ == "RS384") {
-        md = EVP_sha384();
-      } else if (jwt.alg_ == "RS512") {
-        md = EVP_sha512();
-      } else {
-        // default to SHA256
-        md = EVP_sha256();
+    if (pubkey.kty_ == "EC") {
+      // ES256 signature should be 64 bytes.
+      if (jwt.signature_.length() != 2 * 32) {
+        return false;
+      }
+      if (!ecdsa_sig) {
+        ecdsa_sig.reset(ECDSA_SIG_new());
+        if (!ecdsa_sig) {
+          UpdateStatus(Status::FAILED_CREATE_ECDSA_SIGNATURE);
+          return false;
+        }
+        const uint8_t *signature = CastToUChar(jwt.signature_);
+        BN_bin2bn(signature, 32, ecdsa_sig->r);
+        BN_bin2bn(signature + 32, 32, ecdsa_sig->s);
       }
-      if (VerifySignatureRSA(pubkey->evp_pkey_.get(), md, jwt.signature_,
-                             signed_data)) {
+      return ec_digest.Get(&digest, &digest_len) &&
+             VerifySignatureEC(pubkey.ec_key_.get(), digest, digest_len,
+                               ecdsa_sig.get());
+    }
+    if (pubkey.pem_format_ || pubkey.kty_ == "RSA") {
+      return rsa_digest.Get(&digest, &digest_len) &&
+             VerifySignatureRSA(pubkey.evp_pkey_.get(), md, digest,
+                                digest_len, jwt.signature_);
+    }
+    return false;
+  };
+
+  // If kid is specified in JWT, JWK with the same kid or without kid is used
+  // for verification.
+  // If kid is not specified in JWT, try all JWK.
+  if (jwt.kid_ == "") {
+    for (const auto &pubkey : pubkeys.keys_) {
+      if (verify(*pubkey)) {
         // Verification succeeded.
         return true;
       }
     }
+  } else {
+    const auto it = pubkeys.keys_by_kid_.find(jwt.kid_);
+    if (it != pubkeys.keys_by_kid_.end()) {
+      for (const Pubkeys::Pubkey *pubkey : it->second) {
+        if (verify(*pubkey)) {
+          return true;
+        }
+      }
+    }
+    for (const Pubkeys::Pubkey *pubkey : pubkeys.keys_without_kid_) {
+      if (verify(*pubkey)) {
+        return true;
+      }
+    }
   }
   // Verification failed.
   if (kid_alg_matched) {
@@ -458,6 +507,18 @@ const std::vector<std::string> &Jwt::Aud() { return aud_; }
 const std::string &Jwt::Sub() { return sub_; }
 int64_t Jwt::Exp() { return exp_; }
 
+void Pubkeys::IndexKeysByKid() {
+  keys_by_kid_.clear();
+  keys_without_kid_.clear();
+  for (const auto &key : keys_) {
+    if (key->kid_specified_) {
+      keys_by_kid_[key->kid_].push_back(key.get());
+    } else {
+      keys_without_kid_.push_back(key.get());
+    }
+  }
+}
+
 void Pubkeys::CreateFromPemCore(const std::string &pkey_pem) {
   keys_.clear();
   std::unique_ptr<Pubkey> key_ptr(new Pubkey());
@@ -468,6 +529,7 @@ void Pubkeys::CreateFromPemCore(const std::string &pkey_pem) {
   if (e.GetStatus() == Status::OK) {
     keys_.push_back(std::move(key_ptr));
   }
+  IndexKeysByKid();
 }
 
 void Pubkeys::CreateFromJwksCore(const std::string &pkey_jwks) {
@@ -503,6 +565,7 @@ void Pubkeys::CreateFromJwksCore(const std::string &pkey_jwks) {
   if (keys_.size() == 0) {
     UpdateStatus(Status::JWK_NO_VALID_PUBKEY);
   }
+  IndexKeysByKid();
 }
 
 void Pubkeys::ExtractPubkeyFromJwk(Json::ObjectSharedPtr jwk_json) {
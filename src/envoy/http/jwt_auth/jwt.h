@@ -16,11 +16,13 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "envoy/json/json_object.h"
 #include "openssl/ec.h"
+#include "openssl/ecdsa.h"
 #include "openssl/evp.h"
 
 namespace Envoy {
@@ -157,20 +159,15 @@ class Verifier : public WithStatus {
   bool Verify(const Jwt& jwt, const Pubkeys& pubkeys);
 
  private:
-  // Functions to verify with single public key.
+  // Functions to verify with single public key, given the digest of the
+  // signed data. The digest is computed once for all the public keys.
   // (Note: Pubkeys object passed to Verify() may contains multiple public keys)
   // When verification fails, UpdateStatus() is NOT called.
   bool VerifySignatureRSA(EVP_PKEY* key, const EVP_MD* md,
-                          const uint8_t* signature, size_t signature_len,
-                          const uint8_t* signed_data, size_t signed_data_len);
-  bool VerifySignatureRSA(EVP_PKEY* key, const EVP_MD* md,
-                          const std::string& signature,
-                          const std::string& signed_data);
-  bool VerifySignatureEC(EC_KEY* key, const std::string& signature,
-                         const std::string& signed_data);
-  bool VerifySignatureEC(EC_KEY* key, const uint8_t* signature,
-                         size_t signature_len, const uint8_t* signed_data,
-                         size_t signed_data_len);
+                          const uint8_t* digest, size_t digest_len,
+                          const std::string& signature);
+  bool VerifySignatureEC(EC_KEY* key, const uint8_t* digest,
+                         size_t digest_len, const ECDSA_SIG* signature);
 };
 
 // Class to parse and a hold a JWT.
@@ -274,6 +271,9 @@ class Pubkeys : public WithStatus {
   void ExtractPubkeyFromJwkRSA(Json::ObjectSharedPtr jwk_json);
   void ExtractPubkeyFromJwkEC(Json::ObjectSharedPtr jwk_json);
 
+  // Indexes keys_ by kid once they are all extracted.
+  void IndexKeysByKid();
+
   class Pubkey {
    public:
     Pubkey(){};
@@ -287,6 +287,10 @@ class Pubkeys : public WithStatus {
     std::string alg_;
   };
   std::vector<std::unique_ptr<Pubkey> > keys_;
+  // The keys with each kid. A JWT with a kid is verified with these keys and
+  // with keys_without_kid_ only.
+  std::unordered_map<std::string, std::vector<const Pubkey*> > keys_by_kid_;
+  std::vector<const Pubkey*> keys_without_kid_;
 
   /*
    * TODO: try not to use friend function
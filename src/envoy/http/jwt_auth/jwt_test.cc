@@ -562,6 +562,16 @@ TEST_F(JwtTestPem, OKWithAlgRs512) {
   DoTest(ds.kJwtRs512, ds.kPublicKey, "pem", true, Status::OK, payload);
 }
 
+TEST_F(JwtTestPem, OKWithAlternatingAlgs) {
+  // The digest context of the thread is reused across algorithms.
+  auto payload = Json::Factory::loadFromString(ds.kJwtPayload);
+  for (int i = 0; i < 2; ++i) {
+    DoTest(ds.kJwtRs512, ds.kPublicKey, "pem", true, Status::OK, payload);
+    DoTest(ds.kJwt, ds.kPublicKey, "pem", true, Status::OK, payload);
+    DoTest(ds.kJwtRs384, ds.kPublicKey, "pem", true, Status::OK, payload);
+  }
+}
+
 TEST_F(JwtTestPem, MultiAudiences) {
   Jwt jwt(ds.kJwtMultiSub);
   ASSERT_EQ(jwt.Aud(), std::vector<std::string>({"aud1", "aud2"}));
@@ -714,6 +724,36 @@ TEST_F(JwtTestJwks, OkCorrectKid) {
          payload);
 }
 
+TEST_F(JwtTestJwks, OkCorrectKidAmongManyKeys) {
+  auto payload = Json::Factory::loadFromString(ds.kJwtPayload);
+  // Append copies of the key that does not match under other kids.
+  std::string first_key = ds.kPublicKeyRSA.substr(
+      ds.kPublicKeyRSA.find('{', 1),
+      ds.kPublicKeyRSA.find('}') + 1 - ds.kPublicKeyRSA.find('{', 1));
+  std::string pubkey = ds.kPublicKeyRSA.substr(0, ds.kPublicKeyRSA.size() - 2);
+  for (int i = 0; i < 10; ++i) {
+    std::string key = first_key;
+    key.replace(key.find("62a93512"), 8, "0000000" + std::to_string(i));
+    pubkey += "," + key;
+  }
+  pubkey += "]}";
+  DoTest(ds.kJwtWithCorrectKid, pubkey, "jwks", true, Status::OK, payload);
+  DoTest(ds.kJwtWithNonExistKid, pubkey, "jwks", false,
+         Status::KID_ALG_UNMATCH, nullptr);
+}
+
+TEST_F(JwtTestJwks, OkKidMatchesKeyWithoutKid) {
+  auto payload = Json::Factory::loadFromString(ds.kJwtPayload);
+  // Remove "kid" claim of the signing key from public key, it is still used
+  // for a JWT with kid.
+  std::string kid_claim =
+      ",\"kid\": \"b3319a147514df7ee5e4bcdee51350cc890cc89e\"";
+  std::string pubkey_no_kid = ds.kPublicKeyRSA;
+  pubkey_no_kid.erase(pubkey_no_kid.find(kid_claim), kid_claim.length());
+  DoTest(ds.kJwtWithCorrectKid, pubkey_no_kid, "jwks", true, Status::OK,
+         payload);
+}
+
 TEST_F(JwtTestJwks, IncorrectKid) {
   DoTest(ds.kJwtWithIncorrectKid, ds.kPublicKeyRSA, "jwks", false,
          Status::JWT_INVALID_SIGNATURE, nullptr);
@@ -15,9 +15,10 @@
 
 #include "src/envoy/http/jwt_auth/token_extractor.h"
 
+#include <algorithm>
+
 #include "absl/strings/match.h"
 #include "common/common/utility.h"
-#include "common/http/utility.h"
 
 using ::istio::envoy::config::filter::http::jwt_auth::v2alpha1::
     JwtAuthentication;
@@ -73,8 +74,8 @@ void JwtTokenExtractor::Extract(
       auto value = entry->value().getStringView();
       if (absl::StartsWith(value, kBearerPrefix)) {
         value.remove_prefix(kBearerPrefix.length());
-        tokens->emplace_back(new Token(std::string(value),
-                                       authorization_issuers_, true, nullptr));
+        tokens->emplace_back(
+            new Token(value, authorization_issuers_, true, nullptr));
         // Only take the first one.
         return;
       }
@@ -85,14 +86,11 @@ void JwtTokenExtractor::Extract(
   for (const auto &header_it : header_maps_) {
     const HeaderEntry *entry = headers.get(header_it.first);
     if (entry) {
-      std::string token;
-      absl::string_view val = entry->value().getStringView();
-      size_t pos = val.find(' ');
+      absl::string_view token = entry->value().getStringView();
+      size_t pos = token.find(' ');
       if (pos != absl::string_view::npos) {
         // If the header value has prefix, trim the prefix.
-        token = std::string(val.substr(pos + 1));
-      } else {
-        token = std::string(val);
+        token.remove_prefix(pos + 1);
       }
 
       tokens->emplace_back(
@@ -106,16 +104,38 @@ void JwtTokenExtractor::Extract(
     return;
   }
 
-  const auto &params = Utility::parseQueryString(
-      std::string(headers.Path()->value().getStringView()));
-  for (const auto &param_it : param_maps_) {
-    const auto &it = params.find(param_it.first);
-    if (it != params.end()) {
-      tokens->emplace_back(
-          new Token(it->second, param_it.second, false, nullptr));
-      // Only take the first one.
-      return;
+  // Scan the query string in place instead of parsing it into a map. As with
+  // Utility::parseQueryString(), the first value of a parameter is used and
+  // the parameters are tried in the order of param_maps_.
+  absl::string_view query = headers.Path()->value().getStringView();
+  const size_t query_start = query.find('?');
+  if (query_start == absl::string_view::npos) {
+    return;
+  }
+  query.remove_prefix(query_start + 1);
+  auto found = param_maps_.end();
+  absl::string_view found_value;
+  while (!query.empty()) {
+    const size_t param_end = std::min(query.find('&'), query.size());
+    const absl::string_view param = query.substr(0, param_end);
+    query.remove_prefix(std::min(param_end + 1, query.size()));
+
+    const size_t equal = param.find('=');
+    const auto param_it = param_maps_.find(param.substr(0, equal));
+    if (param_it == param_maps_.end() ||
+        (found != param_maps_.end() && found->first <= param_it->first)) {
+      continue;
     }
+    found = param_it;
+    found_value = equal == absl::string_view::npos ? absl::string_view()
+                                                   : param.substr(equal + 1);
+    if (found == param_maps_.begin()) {
+      // No other parameter is tried before this one.
+      break;
+    }
+  }
+  if (found != param_maps_.end()) {
+    tokens->emplace_back(new Token(found_value, found->second, false, nullptr));
   }
 }
 
@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include "absl/strings/string_view.h"
 #include "common/common/logger.h"
 #include "envoy/config/filter/http/jwt_auth/v2alpha1/config.pb.h"
 #include "envoy/http/header_map.h"
@@ -44,7 +45,7 @@ class JwtTokenExtractor : public Logger::Loggable<Logger::Id::filter> {
   // has the allowed issuers that have specified the location.
   class Token {
    public:
-    Token(const std::string& token, const std::set<std::string>& issuers,
+    Token(absl::string_view token, const std::set<std::string>& issuers,
           bool from_authorization, const LowerCaseString* header_name)
         : token_(token),
           allowed_issuers_(issuers),
@@ -78,7 +79,8 @@ class JwtTokenExtractor : public Logger::Loggable<Logger::Id::filter> {
   };
 
   // Return the extracted JWT tokens.
-  // Only extract one token for now.
+  // Only extract one token for now. Header values and the path are scanned in
+  // place, and only the extracted token is copied.
   void Extract(const HeaderMap& headers,
                std::vector<std::unique_ptr<Token>>* tokens) const;
 
@@ -92,8 +94,9 @@ class JwtTokenExtractor : public Logger::Loggable<Logger::Id::filter> {
   // The map of header to set of issuers
   std::map<LowerCaseString, std::set<std::string>, LowerCaseStringCmp>
       header_maps_;
-  // The map of parameters to set of issuers.
-  std::map<std::string, std::set<std::string>> param_maps_;
+  // The map of parameters to set of issuers. It is looked up with the
+  // string_view of the parameter names in the query string.
+  std::map<std::string, std::set<std::string>, std::less<>> param_maps_;
   // Special handling of Authorization header.
   std::set<std::string> authorization_issuers_;
 };
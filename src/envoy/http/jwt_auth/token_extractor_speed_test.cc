@@ -0,0 +1,121 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/utility.h"
+#include "src/envoy/http/jwt_auth/token_extractor.h"
+
+using ::istio::envoy::config::filter::http::jwt_auth::v2alpha1::
+    JwtAuthentication;
+
+namespace Envoy {
+namespace Http {
+namespace JwtAuth {
+namespace {
+
+const char kToken[] =
+    "eyJhbGciOiJSUzI1NiIsInR5cCI6IkpXVCJ9.eyJpc3MiOiJpc3N1ZXIxIiwic3ViIjoi"
+    "c3ViamVjdCJ9.c2lnbmF0dXJl";
+
+// A config with an issuer reading tokens from the default locations and one
+// reading them from a query parameter.
+JwtAuthentication makeConfig() {
+  JwtAuthentication config;
+  config.add_rules()->set_issuer("issuer1");
+  auto* rule = config.add_rules();
+  rule->set_issuer("issuer2");
+  rule->add_from_params("token_param");
+  return config;
+}
+
+// A path with num_params parameters before the token parameter.
+std::string makePath(int num_params) {
+  std::string path = "/api/v1/resource?";
+  for (int i = 0; i < num_params; i++) {
+    absl::StrAppend(&path, "param", i, "=value", i, "&");
+  }
+  absl::StrAppend(&path, "token_param=", kToken);
+  return path;
+}
+
+}  // namespace
+
+static void BM_ExtractFromHeader(benchmark::State& state) {
+  const JwtAuthentication config = makeConfig();
+  const JwtTokenExtractor extractor(config);
+  HeaderMapImpl headers;
+  headers.insertPath().value(makePath(state.range(0)));
+  headers.insertAuthorization().value(absl::StrCat("Bearer ", kToken));
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+    extractor.Extract(headers, &tokens);
+    benchmark::DoNotOptimize(tokens);
+  }
+}
+BENCHMARK(BM_ExtractFromHeader)->Arg(0)->Arg(10)->Arg(100);
+
+static void BM_ExtractFromQuery(benchmark::State& state) {
+  const JwtAuthentication config = makeConfig();
+  const JwtTokenExtractor extractor(config);
+  HeaderMapImpl headers;
+  headers.insertPath().value(makePath(state.range(0)));
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+    extractor.Extract(headers, &tokens);
+    if (tokens.size() != 1) {
+      state.SkipWithError("no token extracted");
+    }
+    benchmark::DoNotOptimize(tokens);
+  }
+}
+BENCHMARK(BM_ExtractFromQuery)->Arg(0)->Arg(10)->Arg(100);
+
+// Finds the token in the query string parsed into a map, as the extractor
+// did before.
+static void BM_ParseQueryString(benchmark::State& state) {
+  HeaderMapImpl headers;
+  headers.insertPath().value(makePath(state.range(0)));
+  for (auto _ : state) {
+    const auto params = Utility::parseQueryString(
+        std::string(headers.Path()->value().getStringView()));
+    const auto it = params.find("token_param");
+    if (it == params.end()) {
+      state.SkipWithError("no token extracted");
+      continue;
+    }
+    std::string token(it->second);
+    benchmark::DoNotOptimize(token);
+  }
+}
+BENCHMARK(BM_ParseQueryString)->Arg(0)->Arg(10)->Arg(100);
+
+}  // namespace JwtAuth
+}  // namespace Http
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
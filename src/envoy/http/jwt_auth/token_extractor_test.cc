@@ -185,6 +185,72 @@ TEST_F(JwtTokenExtractorTest, TestMultipleTokens) {
   EXPECT_EQ(tokens[0]->token(), "header_token");
 }
 
+TEST_F(JwtTokenExtractorTest, TestDefaultHeaderWithoutBearerPrefix) {
+  auto headers = TestHeaderMapImpl{{"Authorization", "Basic jwt_token"}};
+  std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+  extractor_->Extract(headers, &tokens);
+  EXPECT_EQ(tokens.size(), 0);
+}
+
+TEST_F(JwtTokenExtractorTest, TestCustomHeaderTokenWithSpaces) {
+  // Only the prefix up to the first space is trimmed.
+  auto headers = TestHeaderMapImpl{{"token-header", "istio jwt token"}};
+  std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+  extractor_->Extract(headers, &tokens);
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0]->token(), "jwt token");
+}
+
+TEST_F(JwtTokenExtractorTest, TestParamTokenAmongOtherParams) {
+  auto headers = TestHeaderMapImpl{
+      {":path",
+       "/path?a=1&token_param_x=2&xtoken_param=3&token_param=jwt_token&b=4"}};
+  std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+  extractor_->Extract(headers, &tokens);
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0]->token(), "jwt_token");
+  EXPECT_TRUE(tokens[0]->IsIssuerAllowed("issuer3"));
+}
+
+TEST_F(JwtTokenExtractorTest, TestParamTokenFirstValue) {
+  auto headers = TestHeaderMapImpl{
+      {":path", "/path?token_param=first_token&token_param=second_token"}};
+  std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+  extractor_->Extract(headers, &tokens);
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0]->token(), "first_token");
+}
+
+TEST_F(JwtTokenExtractorTest, TestParamTokenOrder) {
+  // The parameters are tried in the order of their names, not of the query.
+  auto headers = TestHeaderMapImpl{
+      {":path", "/path?token_param=param_token&access_token=access_token"}};
+  std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+  extractor_->Extract(headers, &tokens);
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0]->token(), "access_token");
+  EXPECT_TRUE(tokens[0]->IsIssuerAllowed("issuer1"));
+  EXPECT_FALSE(tokens[0]->IsIssuerAllowed("issuer3"));
+}
+
+TEST_F(JwtTokenExtractorTest, TestParamTokenWithoutValue) {
+  auto headers = TestHeaderMapImpl{{":path", "/path?a=1&token_param&b=2"}};
+  std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+  extractor_->Extract(headers, &tokens);
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0]->token(), "");
+}
+
+TEST_F(JwtTokenExtractorTest, TestNoQuery) {
+  for (const char* path :
+       {"/token_param=jwt_token", "/path?", "/path?&&", "/path?=jwt_token"}) {
+    auto headers = TestHeaderMapImpl{{":path", path}};
+    std::vector<std::unique_ptr<JwtTokenExtractor::Token>> tokens;
+    extractor_->Extract(headers, &tokens);
+    EXPECT_EQ(tokens.size(), 0) << path;
+  }
+}
+
 }  // namespace JwtAuth
 }  // namespace Http
 }  // namespace Envoy
@@ -41,12 +41,22 @@ const std::set<std::string> RequestHeaderExclusives = {
 
 CheckData::CheckData(const HeaderMap& headers,
                      const envoy::api::v2::core::Metadata& metadata,
+                     const StreamInfo::FilterState& filter_state,
                      const Network::Connection* connection)
-    : headers_(headers), metadata_(metadata), connection_(connection) {
-  if (headers_.Path()) {
-    query_params_ =
-        Utility::parseQueryString(headers_.Path()->value().getStringView());
+    : headers_(headers),
+      metadata_(metadata),
+      filter_state_(filter_state),
+      connection_(connection) {}
+
+const Utility::QueryParams& CheckData::queryParams() const {
+  if (!query_params_) {
+    query_params_.emplace();
+    if (headers_.Path()) {
+      *query_params_ =
+          Utility::parseQueryString(headers_.Path()->value().getStringView());
+    }
   }
+  return *query_params_;
 }
 
 bool CheckData::ExtractIstioAttributes(std::string* data) const {
@@ -77,6 +87,16 @@ std::map<std::string, std::string> CheckData::GetRequestHeaders() const {
   return header_map;
 }
 
+std::map<std::string, std::string> CheckData::GetRequestHeaders(
+    const std::set<std::string>& names) const {
+  std::map<std::string, std::string> header_map;
+  Utils::FindHeaders(headers_, names, header_map);
+  for (const auto& name : RequestHeaderExclusives) {
+    header_map.erase(name);
+  }
+  return header_map;
+}
+
 bool CheckData::IsMutualTLS() const { return Utils::IsMutualTLS(connection_); }
 
 bool CheckData::GetRequestedServerName(std::string* name) const {
@@ -145,8 +165,9 @@ bool CheckData::FindHeaderByName(const std::string& name,
 
 bool CheckData::FindQueryParameter(const std::string& name,
                                    std::string* value) const {
-  const auto& it = query_params_.find(name);
-  if (it != query_params_.end()) {
+  const auto& query_params = queryParams();
+  const auto& it = query_params.find(name);
+  if (it != query_params.end()) {
     *value = it->second;
     return true;
   }
@@ -166,6 +187,10 @@ const ::google::protobuf::Struct* CheckData::GetAuthenticationResult() const {
   return Utils::Authentication::GetResultFromMetadata(metadata_);
 }
 
+const ::istio::authn::Result* CheckData::GetAuthenticationResultProto() const {
+  return Utils::Authentication::GetResultFromFilterState(filter_state_);
+}
+
 bool CheckData::GetUrlPath(std::string* url_path) const {
   if (!headers_.Path()) {
     return false;
@@ -188,8 +213,7 @@ bool CheckData::GetRequestQueryParams(
   if (!headers_.Path()) {
     return false;
   }
-  *query_params =
-      Utility::parseQueryString(headers_.Path()->value().getStringView());
+  *query_params = queryParams();
   return true;
 }
 
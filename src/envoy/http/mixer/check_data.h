@@ -15,10 +15,12 @@
 
 #pragma once
 
+#include "absl/types/optional.h"
 #include "common/common/logger.h"
 #include "common/http/utility.h"
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/http/header_map.h"
+#include "envoy/stream_info/filter_state.h"
 #include "google/protobuf/struct.pb.h"
 #include "include/istio/control/http/controller.h"
 #include "src/istio/authn/context.pb.h"
@@ -32,6 +34,7 @@ class CheckData : public ::istio::control::http::CheckData,
  public:
   CheckData(const HeaderMap& headers,
             const envoy::api::v2::core::Metadata& metadata,
+            const StreamInfo::FilterState& filter_state,
             const Network::Connection* connection);
 
   // Find "x-istio-attributes" headers, if found base64 decode
@@ -44,6 +47,9 @@ class CheckData : public ::istio::control::http::CheckData,
 
   std::map<std::string, std::string> GetRequestHeaders() const override;
 
+  std::map<std::string, std::string> GetRequestHeaders(
+      const std::set<std::string>& names) const override;
+
   bool IsMutualTLS() const override;
 
   bool GetRequestedServerName(std::string* name) const override;
@@ -62,6 +68,8 @@ class CheckData : public ::istio::control::http::CheckData,
 
   const ::google::protobuf::Struct* GetAuthenticationResult() const override;
 
+  const ::istio::authn::Result* GetAuthenticationResultProto() const override;
+
   bool GetUrlPath(std::string* url_path) const override;
 
   bool GetRequestQueryParams(
@@ -70,8 +78,11 @@ class CheckData : public ::istio::control::http::CheckData,
  private:
   const HeaderMap& headers_;
   const envoy::api::v2::core::Metadata& metadata_;
+  const StreamInfo::FilterState& filter_state_;
   const Network::Connection* connection_;
-  Utility::QueryParams query_params_;
+  // Parsed from the path on first use.
+  const Utility::QueryParams& queryParams() const;
+  mutable absl::optional<Utility::QueryParams> query_params_;
 };
 
 }  // namespace Mixer
@@ -0,0 +1,154 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "common/stream_info/filter_state_impl.h"
+#include "src/envoy/http/mixer/check_data.h"
+#include "src/istio/utils/allocation_counter.h"
+#include "test/test_common/utility.h"
+
+namespace Envoy {
+namespace Http {
+namespace Mixer {
+namespace {
+
+// Request headers with the given number of query parameters.
+TestHeaderMapImpl requestHeaders(int params) {
+  std::string path = "/books/shelf";
+  for (int i = 0; i < params; i++) {
+    path += (i == 0 ? "?" : "&") + std::string("param") + std::to_string(i) +
+            "=value" + std::to_string(i);
+  }
+  return TestHeaderMapImpl{{":method", "GET"},
+                           {":path", path},
+                           {":authority", "bookstore"}};
+}
+
+// Request headers with the given number of custom headers.
+TestHeaderMapImpl requestHeadersWithCustom(int custom) {
+  TestHeaderMapImpl headers = requestHeaders(0);
+  for (int i = 0; i < custom; i++) {
+    headers.addCopy("x-custom-" + std::to_string(i), std::string(40, 'v'));
+  }
+  return headers;
+}
+
+}  // namespace
+
+// request.headers with all the request headers.
+static void BM_GetAllRequestHeaders(benchmark::State& state) {
+  const auto headers = requestHeadersWithCustom(state.range(0));
+  const envoy::api::v2::core::Metadata metadata;
+  const StreamInfo::FilterStateImpl filter_state;
+  const CheckData check_data(headers, metadata, filter_state, nullptr);
+  const uint64_t start = ::istio::utils::AllocationCount();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(check_data.GetRequestHeaders());
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(::istio::utils::AllocationCount() - start,
+                         benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_GetAllRequestHeaders)->Arg(10)->Arg(30);
+
+// request.headers with two selected request headers.
+static void BM_GetSelectedRequestHeaders(benchmark::State& state) {
+  const auto headers = requestHeadersWithCustom(state.range(0));
+  const envoy::api::v2::core::Metadata metadata;
+  const StreamInfo::FilterStateImpl filter_state;
+  const CheckData check_data(headers, metadata, filter_state, nullptr);
+  const std::set<std::string> names = {":authority", "x-custom-1"};
+  const uint64_t start = ::istio::utils::AllocationCount();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(check_data.GetRequestHeaders(names));
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(::istio::utils::AllocationCount() - start,
+                         benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_GetSelectedRequestHeaders)->Arg(10)->Arg(30);
+
+// What log() used to do after a Check: build a CheckData, which parsed the
+// query string in its constructor, only to find the attributes extracted.
+static void BM_LogWithCheckData(benchmark::State& state) {
+  const auto headers = requestHeaders(state.range(0));
+  const envoy::api::v2::core::Metadata metadata;
+  const StreamInfo::FilterStateImpl filter_state;
+  std::map<std::string, std::string> query_params;
+  const uint64_t start = ::istio::utils::AllocationCount();
+  for (auto _ : state) {
+    CheckData check_data(headers, metadata, filter_state, nullptr);
+    check_data.GetRequestQueryParams(&query_params);
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(::istio::utils::AllocationCount() - start,
+                         benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LogWithCheckData)->Arg(0)->Arg(10);
+
+// log() after a Check now reuses the handler attributes, and a CheckData
+// that is built only parses the query string when it is read.
+static void BM_LogWithoutCheckData(benchmark::State& state) {
+  const auto headers = requestHeaders(state.range(0));
+  const envoy::api::v2::core::Metadata metadata;
+  const StreamInfo::FilterStateImpl filter_state;
+  const uint64_t start = ::istio::utils::AllocationCount();
+  for (auto _ : state) {
+    CheckData check_data(headers, metadata, filter_state, nullptr);
+    benchmark::DoNotOptimize(&check_data);
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(::istio::utils::AllocationCount() - start,
+                         benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LogWithoutCheckData)->Arg(0)->Arg(10);
+
+// Reading the query parameters more than once parses the query string once.
+static void BM_CheckQueryParams(benchmark::State& state) {
+  const auto headers = requestHeaders(state.range(0));
+  const envoy::api::v2::core::Metadata metadata;
+  const StreamInfo::FilterStateImpl filter_state;
+  std::map<std::string, std::string> query_params;
+  std::string value;
+  const uint64_t start = ::istio::utils::AllocationCount();
+  for (auto _ : state) {
+    CheckData check_data(headers, metadata, filter_state, nullptr);
+    check_data.FindQueryParameter("param1", &value);
+    check_data.GetRequestQueryParams(&query_params);
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(::istio::utils::AllocationCount() - start,
+                         benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_CheckQueryParams)->Arg(0)->Arg(10);
+
+}  // namespace Mixer
+}  // namespace Http
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -15,6 +15,8 @@
 
 #include "src/envoy/http/mixer/control.h"
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_split.h"
 #include "include/istio/utils/local_attributes.h"
 
 using ::istio::mixer::v1::Attributes;
@@ -23,6 +25,28 @@ using ::istio::utils::LocalNode;
 namespace Envoy {
 namespace Http {
 namespace Mixer {
+namespace {
+
+// Node metadata with the comma separated names of the headers sent in the
+// request.headers and response.headers attributes. If a key is not set, all
+// the headers are sent.
+const char kMixerRequestHeaders[] = "MIXER_REQUEST_HEADERS";
+const char kMixerResponseHeaders[] = "MIXER_RESPONSE_HEADERS";
+
+void ReadHeaderNames(const envoy::api::v2::core::Node& node, const char* key,
+                     std::set<std::string>* names) {
+  const auto& fields = node.metadata().fields();
+  const auto it = fields.find(key);
+  if (it == fields.end()) {
+    return;
+  }
+  for (absl::string_view name : absl::StrSplit(
+           it->second.string_value(), ',', absl::SkipWhitespace())) {
+    names->insert(absl::AsciiStrToLower(absl::StripAsciiWhitespace(name)));
+  }
+}
+
+}  // namespace
 
 Control::Control(ControlDataSharedPtr control_data,
                  Upstream::ClusterManager& cm, Event::Dispatcher& dispatcher,
@@ -55,6 +79,13 @@ Control::Control(ControlDataSharedPtr control_data,
 
   ::istio::control::http::Controller::Options options(
       control_data_->config().config_pb(), local_node);
+  ReadHeaderNames(local_info.node(), kMixerRequestHeaders,
+                  &options.header_selection.request_headers);
+  ReadHeaderNames(local_info.node(), kMixerResponseHeaders,
+                  &options.header_selection.response_headers);
+  Utils::ExtractCheckCacheRefresh(local_info.node(),
+                                  &options.check_cache_refresh_ahead_ms,
+                                  &options.check_cache_max_stale_ms);
 
   Utils::CreateEnvironment(dispatcher, random, *check_client_factory_,
                            *report_client_factory_,
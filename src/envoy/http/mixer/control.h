@@ -24,6 +24,7 @@
 #include "include/istio/control/http/controller.h"
 #include "include/istio/utils/local_attributes.h"
 #include "src/envoy/http/mixer/config.h"
+#include "src/envoy/http/mixer/header_operations.h"
 #include "src/envoy/utils/grpc_transport.h"
 #include "src/envoy/utils/mixer_control.h"
 #include "src/envoy/utils/stats.h"
@@ -61,6 +62,11 @@ class Control final : public ThreadLocal::ThreadLocalObject {
   // Create a per-request Check transport function.
   Utils::CheckTransport::Func GetCheckTransport(Tracing::Span& parent_span);
 
+  // Get the compiled header operations of check results on this worker.
+  HeaderOperationsCache& headerOperationsCache() {
+    return header_operations_cache_;
+  }
+
  private:
   // Call controller to get statistics.
   bool GetStats(::istio::mixerclient::Statistics* stat);
@@ -76,6 +82,8 @@ class Control final : public ThreadLocal::ThreadLocalObject {
   Utils::MixerStatsObject stats_obj_;
   // The mixer control
   std::unique_ptr<::istio::control::http::Controller> controller_;
+  // Compiled header operations of route directives.
+  HeaderOperationsCache header_operations_cache_;
 };
 
 }  // namespace Mixer
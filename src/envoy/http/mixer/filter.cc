@@ -75,6 +75,7 @@ FilterHeadersStatus Filter::decodeHeaders(HeaderMap& headers, bool) {
   initiating_call_ = true;
   CheckData check_data(headers,
                        decoder_callbacks_->streamInfo().dynamicMetadata(),
+                       decoder_callbacks_->streamInfo().filterState(),
                        decoder_callbacks_->connection());
   Utils::HeaderUpdate header_update(&headers);
   headers_ = &headers;
@@ -110,27 +111,6 @@ FilterTrailersStatus Filter::decodeTrailers(HeaderMap& trailers) {
   return FilterTrailersStatus::Continue;
 }
 
-void Filter::UpdateHeaders(
-    HeaderMap& headers, const ::google::protobuf::RepeatedPtrField<
-                            ::istio::mixer::v1::HeaderOperation>& operations) {
-  for (auto const iter : operations) {
-    switch (iter.operation()) {
-      case ::istio::mixer::v1::HeaderOperation_Operation_REPLACE:
-        headers.remove(LowerCaseString(iter.name()));
-        headers.addCopy(LowerCaseString(iter.name()), iter.value());
-        break;
-      case ::istio::mixer::v1::HeaderOperation_Operation_REMOVE:
-        headers.remove(LowerCaseString(iter.name()));
-        break;
-      case ::istio::mixer::v1::HeaderOperation_Operation_APPEND:
-        headers.addCopy(LowerCaseString(iter.name()), iter.value());
-        break;
-      default:
-        PANIC("unreachable header operation");
-    }
-  }
-}
-
 FilterHeadersStatus Filter::encodeHeaders(HeaderMap& headers, bool) {
   ENVOY_LOG(debug, "Called Mixer::Filter : {} {}", __func__, state_);
   // Init state is possible if a filter prior to mixerfilter interrupts the
@@ -138,7 +118,7 @@ FilterHeadersStatus Filter::encodeHeaders(HeaderMap& headers, bool) {
   ASSERT(state_ == NotStarted || state_ == Complete || state_ == Responded);
   if (state_ == Complete) {
     // handle response header operations
-    UpdateHeaders(headers, route_directive_.response_header_operations());
+    header_operations_->response.apply(headers);
   }
   return FilterHeadersStatus::Continue;
 }
@@ -159,19 +139,21 @@ void Filter::completeCheck(const CheckResponseInfo& info) {
     return;
   }
 
-  route_directive_ = info.routeDirective();
+  const auto& route_directive = info.routeDirective();
+  header_operations_ = control_.headerOperationsCache().get(
+      route_directive, info.routeDirectiveOwner());
 
   Utils::CheckResponseInfoToStreamInfo(info, decoder_callbacks_->streamInfo());
 
   // handle direct response from the route directive
-  if (route_directive_.direct_response_code() != 0) {
-    int status_code = route_directive_.direct_response_code();
+  if (route_directive.direct_response_code() != 0) {
+    int status_code = route_directive.direct_response_code();
     ENVOY_LOG(debug, "Mixer::Filter direct response {}", status_code);
     state_ = Responded;
     decoder_callbacks_->sendLocalReply(
-        Code(status_code), route_directive_.direct_response_body(),
+        Code(status_code), route_directive.direct_response_body(),
         [this](HeaderMap& headers) {
-          UpdateHeaders(headers, route_directive_.response_header_operations());
+          header_operations_->response.apply(headers);
         },
         absl::nullopt, RcDetails::get().MixerDirectResponse);
     return;
@@ -192,9 +174,9 @@ void Filter::completeCheck(const CheckResponseInfo& info) {
 
   // handle request header operations
   if (nullptr != headers_) {
-    UpdateHeaders(*headers_, route_directive_.request_header_operations());
+    header_operations_->request.apply(*headers_);
     headers_ = nullptr;
-    if (route_directive_.request_header_operations().size() > 0) {
+    if (route_directive.request_header_operations().size() > 0) {
       decoder_callbacks_->clearRouteCache();
     }
   }
@@ -220,30 +202,36 @@ void Filter::log(const HeaderMap* request_headers,
                  const HeaderMap* response_trailers,
                  const StreamInfo::StreamInfo& stream_info) {
   ENVOY_LOG(debug, "Called Mixer::Filter : {}", __func__);
-  if (!handler_) {
-    if (request_headers == nullptr) {
-      return;
-    }
+  // response trailer header is not counted to response total size.
+  ReportData report_data(request_headers, response_headers, response_trailers,
+                         stream_info, request_total_size_);
+  if (handler_) {
+    // The handler keeps the attributes extracted for the Check call in
+    // decodeHeaders(), only the report attributes are added.
+    handler_->Report(nullptr, &report_data);
+    return;
+  }
 
-    // Here Request is rejected by other filters, Mixer filter is not called.
-    ::istio::control::http::Controller::PerRouteConfig config;
-    auto route_entry = stream_info.routeEntry();
-    if (route_entry) {
-      auto route_cfg =
-          route_entry->perFilterConfigTyped<PerRouteServiceConfig>("mixer");
-      if (route_cfg) {
-        ReadPerRouteConfig(*route_cfg, &config);
-      }
+  if (request_headers == nullptr) {
+    return;
+  }
+
+  // Here Request is rejected by other filters, Mixer filter is not called.
+  ::istio::control::http::Controller::PerRouteConfig config;
+  auto route_entry = stream_info.routeEntry();
+  if (route_entry) {
+    auto route_cfg =
+        route_entry->perFilterConfigTyped<PerRouteServiceConfig>("mixer");
+    if (route_cfg) {
+      ReadPerRouteConfig(*route_cfg, &config);
     }
-    handler_ = control_.controller()->CreateRequestHandler(config);
   }
+  handler_ = control_.controller()->CreateRequestHandler(config);
 
-  // If check is NOT called, check attributes are not extracted.
+  // Check is NOT called, check attributes are not extracted.
   CheckData check_data(*request_headers, stream_info.dynamicMetadata(),
+                       stream_info.filterState(),
                        decoder_callbacks_->connection());
-  // response trailer header is not counted to response total size.
-  ReportData report_data(request_headers, response_headers, response_trailers,
-                         stream_info, request_total_size_);
   handler_->Report(&check_data, &report_data);
 }
 
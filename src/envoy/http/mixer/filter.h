@@ -19,6 +19,7 @@
 #include "envoy/access_log/access_log.h"
 #include "envoy/http/filter.h"
 #include "src/envoy/http/mixer/control.h"
+#include "src/envoy/http/mixer/header_operations.h"
 
 namespace Envoy {
 namespace Http {
@@ -80,11 +81,6 @@ class Filter : public StreamFilter,
       const PerRouteServiceConfig& route_cfg,
       ::istio::control::http::Controller::PerRouteConfig* config);
 
-  // Update header maps
-  void UpdateHeaders(HeaderMap& headers,
-                     const ::google::protobuf::RepeatedPtrField<
-                         ::istio::mixer::v1::HeaderOperation>& operations);
-
   // The control object.
   Control& control_;
   // The request handler.
@@ -105,9 +101,9 @@ class Filter : public StreamFilter,
   // The stream decoder filter callback.
   StreamDecoderFilterCallbacks* decoder_callbacks_{nullptr};
 
-  // Returned directive
-  ::istio::mixer::v1::RouteDirective route_directive_{
-      ::istio::mixer::v1::RouteDirective::default_instance()};
+  // Compiled header operations of the returned directive, shared with the
+  // other requests served by the same cached check result.
+  RouteDirectiveHeaderOperationsConstSharedPtr header_operations_;
 };
 
 }  // namespace Mixer
@@ -0,0 +1,139 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/mixer/header_operations.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "common/common/assert.h"
+
+using ::istio::mixer::v1::HeaderOperation;
+using ::istio::mixer::v1::HeaderOperation_Operation_APPEND;
+using ::istio::mixer::v1::HeaderOperation_Operation_REMOVE;
+using ::istio::mixer::v1::HeaderOperation_Operation_REPLACE;
+
+namespace Envoy {
+namespace Http {
+namespace Mixer {
+namespace {
+
+// Marks the removals present in the header map.
+struct PresentRemovals {
+  const std::vector<LowerCaseString>& removals;
+  absl::InlinedVector<bool, 16> present;
+  bool any{false};
+};
+
+}  // namespace
+
+HeaderOperations::HeaderOperations(
+    const ::google::protobuf::RepeatedPtrField<HeaderOperation>& operations) {
+  std::vector<LowerCaseString> names;
+  names.reserve(operations.size());
+  // Index of the last REPLACE or REMOVE of each header.
+  absl::flat_hash_map<std::string, int> last_reset;
+  for (int i = 0; i < operations.size(); i++) {
+    names.emplace_back(operations[i].name());
+    switch (operations[i].operation()) {
+      case HeaderOperation_Operation_REPLACE:
+      case HeaderOperation_Operation_REMOVE:
+        if (last_reset.find(names[i].get()) == last_reset.end()) {
+          removals_.push_back(names[i]);
+        }
+        last_reset[names[i].get()] = i;
+        break;
+      case HeaderOperation_Operation_APPEND:
+        break;
+      default:
+        PANIC("unreachable header operation");
+    }
+  }
+
+  for (int i = 0; i < operations.size(); i++) {
+    const auto& operation = operations[i];
+    if (operation.operation() == HeaderOperation_Operation_REMOVE) {
+      continue;
+    }
+    const auto it = last_reset.find(names[i].get());
+    if (it != last_reset.end() && it->second > i) {
+      continue;
+    }
+    additions_.push_back({std::move(names[i]), operation.value()});
+  }
+}
+
+void HeaderOperations::apply(HeaderMap& headers) const {
+  if (!removals_.empty()) {
+    PresentRemovals context{removals_, {}};
+    context.present.resize(removals_.size());
+    headers.iterate(
+        [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+          auto* removals = static_cast<PresentRemovals*>(context);
+          const absl::string_view key = header.key().getStringView();
+          for (size_t i = 0; i < removals->removals.size(); i++) {
+            if (key == removals->removals[i].get()) {
+              removals->present[i] = true;
+              removals->any = true;
+            }
+          }
+          return HeaderMap::Iterate::Continue;
+        },
+        &context);
+    if (context.any) {
+      for (size_t i = 0; i < removals_.size(); i++) {
+        if (context.present[i]) {
+          headers.remove(removals_[i]);
+        }
+      }
+    }
+  }
+
+  for (const auto& addition : additions_) {
+    headers.addCopy(addition.name, addition.value);
+  }
+}
+
+RouteDirectiveHeaderOperationsConstSharedPtr HeaderOperationsCache::get(
+    const ::istio::mixer::v1::RouteDirective& directive,
+    const std::shared_ptr<const void>& owner) {
+  if (directive.request_header_operations().empty() &&
+      directive.response_header_operations().empty()) {
+    static const auto* empty = new RouteDirectiveHeaderOperationsConstSharedPtr(
+        std::make_shared<const RouteDirectiveHeaderOperations>());
+    return *empty;
+  }
+  if (!owner) {
+    return std::make_shared<const RouteDirectiveHeaderOperations>(directive);
+  }
+
+  const auto it = entries_.find(owner.get());
+  if (it != entries_.end()) {
+    return it->second.operations;
+  }
+  // Entries of check results the check cache has replaced are only dropped
+  // here, and a directive is cheap to compile again, so a full cache is
+  // simply reset.
+  if (entries_.size() >= max_size_) {
+    entries_.clear();
+  }
+  auto operations =
+      std::make_shared<const RouteDirectiveHeaderOperations>(directive);
+  entries_.emplace(owner.get(), Entry{owner, operations});
+  return operations;
+}
+
+}  // namespace Mixer
+}  // namespace Http
+}  // namespace Envoy
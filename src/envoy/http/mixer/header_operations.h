@@ -0,0 +1,113 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "envoy/http/header_map.h"
+#include "mixer/v1/check.pb.h"
+
+namespace Envoy {
+namespace Http {
+namespace Mixer {
+
+/**
+ * Header operations of a Mixer route directive, compiled once when the check
+ * response is received. Header names are lower cased up front and the
+ * operations are reduced to their net effect, so applying them scans the
+ * header map once for the headers to remove and then adds the new values,
+ * with the same result as applying the operations one by one.
+ */
+class HeaderOperations {
+ public:
+  HeaderOperations() {}
+  HeaderOperations(const ::google::protobuf::RepeatedPtrField<
+                   ::istio::mixer::v1::HeaderOperation>& operations);
+
+  bool empty() const { return removals_.empty() && additions_.empty(); }
+
+  void apply(HeaderMap& headers) const;
+
+ private:
+  struct Addition {
+    LowerCaseString name;
+    std::string value;
+  };
+
+  // Headers whose existing values are dropped by a REPLACE or REMOVE.
+  std::vector<LowerCaseString> removals_;
+  // Values added by an APPEND or REPLACE that is not followed by a REPLACE
+  // or REMOVE of the same header, in the order of the operations.
+  std::vector<Addition> additions_;
+};
+
+/**
+ * The compiled request and response header operations of a route directive.
+ */
+struct RouteDirectiveHeaderOperations {
+  RouteDirectiveHeaderOperations() {}
+  explicit RouteDirectiveHeaderOperations(
+      const ::istio::mixer::v1::RouteDirective& directive)
+      : request(directive.request_header_operations()),
+        response(directive.response_header_operations()) {}
+
+  const HeaderOperations request;
+  const HeaderOperations response;
+};
+typedef std::shared_ptr<const RouteDirectiveHeaderOperations>
+    RouteDirectiveHeaderOperationsConstSharedPtr;
+
+constexpr size_t kDefaultHeaderOperationsCacheMaxSize = 100;
+
+/**
+ * Compiled header operations of the route directives seen by a worker, keyed
+ * by the check result that owns each directive. Requests served by the same
+ * cached check result share one compiled copy instead of compiling the
+ * directive again. Not thread safe; each worker has its own.
+ */
+class HeaderOperationsCache {
+ public:
+  explicit HeaderOperationsCache(
+      size_t max_size = kDefaultHeaderOperationsCacheMaxSize)
+      : max_size_(max_size) {}
+
+  /**
+   * Returns the compiled header operations of directive, which is owned by
+   * owner. Without an owner, the directive is compiled on every call.
+   */
+  RouteDirectiveHeaderOperationsConstSharedPtr get(
+      const ::istio::mixer::v1::RouteDirective& directive,
+      const std::shared_ptr<const void>& owner);
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    // Keeps the key valid while the entry exists.
+    std::shared_ptr<const void> owner;
+    RouteDirectiveHeaderOperationsConstSharedPtr operations;
+  };
+
+  const size_t max_size_;
+  absl::flat_hash_map<const void*, Entry> entries_;
+};
+
+}  // namespace Mixer
+}  // namespace Http
+}  // namespace Envoy
@@ -0,0 +1,159 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "common/http/header_map_impl.h"
+#include "src/envoy/http/mixer/header_operations.h"
+
+using ::google::protobuf::RepeatedPtrField;
+using ::istio::mixer::v1::HeaderOperation;
+
+namespace Envoy {
+namespace Http {
+namespace Mixer {
+namespace {
+
+// A directive with 20 operations: appends of new headers, replacements of
+// present and missing headers, and removals.
+RepeatedPtrField<HeaderOperation> directive() {
+  const HeaderOperation::Operation kinds[] = {HeaderOperation::APPEND,
+                                              HeaderOperation::REPLACE,
+                                              HeaderOperation::REMOVE};
+  RepeatedPtrField<HeaderOperation> operations;
+  for (int i = 0; i < 20; i++) {
+    auto* operation = operations.Add();
+    operation->set_operation(kinds[i % 3]);
+    operation->set_name("X-Mixer-Directive-Header-" + std::to_string(i % 12));
+    operation->set_value("value-" + std::to_string(i));
+  }
+  return operations;
+}
+
+HeaderMapPtr requestHeaders() {
+  HeaderMapPtr headers(new HeaderMapImpl());
+  headers->addCopy(LowerCaseString(":method"), "GET");
+  headers->addCopy(LowerCaseString(":path"), "/api/v1/products");
+  headers->addCopy(LowerCaseString(":authority"), "productpage.default");
+  headers->addCopy(LowerCaseString("user-agent"), "benchmark");
+  headers->addCopy(LowerCaseString("x-request-id"), "a-request-id");
+  for (int i = 0; i < 12; i += 2) {
+    headers->addCopy(
+        LowerCaseString("x-mixer-directive-header-" + std::to_string(i)),
+        "original");
+  }
+  return headers;
+}
+
+// What the filter used to do for every request.
+void applyOneByOne(const RepeatedPtrField<HeaderOperation>& operations,
+                   HeaderMap& headers) {
+  for (auto const iter : operations) {
+    switch (iter.operation()) {
+      case HeaderOperation::REPLACE:
+        headers.remove(LowerCaseString(iter.name()));
+        headers.addCopy(LowerCaseString(iter.name()), iter.value());
+        break;
+      case HeaderOperation::REMOVE:
+        headers.remove(LowerCaseString(iter.name()));
+        break;
+      case HeaderOperation::APPEND:
+        headers.addCopy(LowerCaseString(iter.name()), iter.value());
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+}  // namespace
+
+static void BM_ApplyOneByOne(benchmark::State& state) {
+  const auto operations = directive();
+  const auto prototype = requestHeaders();
+  for (auto _ : state) {
+    HeaderMapImpl headers(*prototype);
+    applyOneByOne(operations, headers);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(BM_ApplyOneByOne);
+
+// The operations are compiled once per check response and applied to the
+// request and, for response operations, the response headers.
+static void BM_CompileAndApply(benchmark::State& state) {
+  const auto operations = directive();
+  const auto prototype = requestHeaders();
+  for (auto _ : state) {
+    HeaderMapImpl headers(*prototype);
+    HeaderOperations(operations).apply(headers);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(BM_CompileAndApply);
+
+static void BM_ApplyCompiled(benchmark::State& state) {
+  const HeaderOperations operations(directive());
+  const auto prototype = requestHeaders();
+  for (auto _ : state) {
+    HeaderMapImpl headers(*prototype);
+    operations.apply(headers);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(BM_ApplyCompiled);
+
+// What the filter does on a check cache hit: the directive compiled for the
+// first request served by the cached check result is reused.
+static void BM_CachedCompileAndApply(benchmark::State& state) {
+  ::istio::mixer::v1::RouteDirective route_directive;
+  *route_directive.mutable_request_header_operations() = directive();
+  const auto owner = std::make_shared<int>(0);
+  HeaderOperationsCache cache;
+  const auto prototype = requestHeaders();
+  for (auto _ : state) {
+    HeaderMapImpl headers(*prototype);
+    cache.get(route_directive, owner)->request.apply(headers);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(BM_CachedCompileAndApply);
+
+// Copying the headers, which every benchmark above includes.
+static void BM_CopyHeaders(benchmark::State& state) {
+  const auto prototype = requestHeaders();
+  for (auto _ : state) {
+    HeaderMapImpl headers(*prototype);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(BM_CopyHeaders);
+
+}  // namespace Mixer
+}  // namespace Http
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
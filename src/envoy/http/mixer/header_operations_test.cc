@@ -0,0 +1,200 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/http/mixer/header_operations.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_common/utility.h"
+
+using ::google::protobuf::RepeatedPtrField;
+using ::istio::mixer::v1::HeaderOperation;
+
+namespace Envoy {
+namespace Http {
+namespace Mixer {
+namespace {
+
+void addOperation(RepeatedPtrField<HeaderOperation>* operations,
+                  HeaderOperation::Operation operation, const std::string& name,
+                  const std::string& value = "") {
+  auto* header_operation = operations->Add();
+  header_operation->set_operation(operation);
+  header_operation->set_name(name);
+  header_operation->set_value(value);
+}
+
+// Applies the operations one by one, as the filter used to.
+void applyOneByOne(const RepeatedPtrField<HeaderOperation>& operations,
+                   HeaderMap& headers) {
+  for (const auto& operation : operations) {
+    switch (operation.operation()) {
+      case HeaderOperation::REPLACE:
+        headers.remove(LowerCaseString(operation.name()));
+        headers.addCopy(LowerCaseString(operation.name()), operation.value());
+        break;
+      case HeaderOperation::REMOVE:
+        headers.remove(LowerCaseString(operation.name()));
+        break;
+      case HeaderOperation::APPEND:
+        headers.addCopy(LowerCaseString(operation.name()), operation.value());
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+TEST(HeaderOperationsTest, Append) {
+  RepeatedPtrField<HeaderOperation> operations;
+  addOperation(&operations, HeaderOperation::APPEND, "X-Added", "a");
+  addOperation(&operations, HeaderOperation::APPEND, "x-existing", "b");
+  TestHeaderMapImpl headers{{"x-existing", "1"}};
+  HeaderOperations(operations).apply(headers);
+  EXPECT_EQ(headers, TestHeaderMapImpl({{"x-existing", "1"},
+                                        {"x-added", "a"},
+                                        {"x-existing", "b"}}));
+}
+
+TEST(HeaderOperationsTest, Replace) {
+  RepeatedPtrField<HeaderOperation> operations;
+  addOperation(&operations, HeaderOperation::REPLACE, "X-Existing", "a");
+  addOperation(&operations, HeaderOperation::REPLACE, "x-new", "b");
+  addOperation(&operations, HeaderOperation::REPLACE, "content-type", "c");
+  TestHeaderMapImpl headers{{"x-existing", "1"},
+                            {"x-existing", "2"},
+                            {"content-type", "text/plain"},
+                            {"x-other", "3"}};
+  HeaderOperations(operations).apply(headers);
+  EXPECT_EQ(headers, TestHeaderMapImpl({{"x-other", "3"},
+                                        {"x-existing", "a"},
+                                        {"x-new", "b"},
+                                        {"content-type", "c"}}));
+}
+
+TEST(HeaderOperationsTest, Remove) {
+  RepeatedPtrField<HeaderOperation> operations;
+  addOperation(&operations, HeaderOperation::REMOVE, "X-Existing");
+  addOperation(&operations, HeaderOperation::REMOVE, "x-missing");
+  TestHeaderMapImpl headers{
+      {"x-existing", "1"}, {"x-other", "2"}, {"x-existing", "3"}};
+  HeaderOperations(operations).apply(headers);
+  EXPECT_EQ(headers, TestHeaderMapImpl({{"x-other", "2"}}));
+}
+
+TEST(HeaderOperationsTest, OperationsOnTheSameHeader) {
+  RepeatedPtrField<HeaderOperation> operations;
+  // Appended, then removed.
+  addOperation(&operations, HeaderOperation::APPEND, "x-a", "1");
+  addOperation(&operations, HeaderOperation::REMOVE, "x-a");
+  // Removed, then appended.
+  addOperation(&operations, HeaderOperation::REMOVE, "x-b");
+  addOperation(&operations, HeaderOperation::APPEND, "x-b", "2");
+  // Appended, replaced, appended.
+  addOperation(&operations, HeaderOperation::APPEND, "x-c", "3");
+  addOperation(&operations, HeaderOperation::REPLACE, "X-C", "4");
+  addOperation(&operations, HeaderOperation::APPEND, "x-c", "5");
+  TestHeaderMapImpl headers{{"x-a", "0"}, {"x-b", "0"}, {"x-c", "0"}};
+  HeaderOperations(operations).apply(headers);
+  EXPECT_EQ(headers,
+            TestHeaderMapImpl({{"x-b", "2"}, {"x-c", "4"}, {"x-c", "5"}}));
+}
+
+TEST(HeaderOperationsTest, Empty) {
+  EXPECT_TRUE(HeaderOperations().empty());
+  RepeatedPtrField<HeaderOperation> operations;
+  addOperation(&operations, HeaderOperation::REMOVE, "x-a");
+  EXPECT_FALSE(HeaderOperations(operations).empty());
+}
+
+// Random directives give the same headers as applying the operations one by
+// one.
+TEST(HeaderOperationsTest, SameAsOneByOne) {
+  const std::vector<std::string> names{"x-a", "X-A", "x-b", "x-c",
+                                       "content-type", "x-request-id"};
+  const std::vector<HeaderOperation::Operation> kinds{
+      HeaderOperation::REPLACE, HeaderOperation::REMOVE,
+      HeaderOperation::APPEND};
+  std::mt19937 rng(7);
+  for (int round = 0; round < 1000; round++) {
+    RepeatedPtrField<HeaderOperation> operations;
+    const int count = rng() % 8;
+    for (int i = 0; i < count; i++) {
+      addOperation(&operations, kinds[rng() % kinds.size()],
+                   names[rng() % names.size()], std::to_string(i));
+    }
+    TestHeaderMapImpl expected{
+        {"x-a", "0"}, {"x-b", "0"}, {"x-b", "1"}, {"content-type", "text"}};
+    TestHeaderMapImpl headers(expected);
+    applyOneByOne(operations, expected);
+    HeaderOperations(operations).apply(headers);
+    ASSERT_EQ(headers, expected) << operations.size();
+  }
+}
+
+TEST(HeaderOperationsCacheTest, SharedByOwner) {
+  ::istio::mixer::v1::RouteDirective directive;
+  addOperation(directive.mutable_request_header_operations(),
+               HeaderOperation::APPEND, "X-Request", "a");
+  addOperation(directive.mutable_response_header_operations(),
+               HeaderOperation::APPEND, "X-Response", "b");
+  const auto owner = std::make_shared<int>(0);
+  HeaderOperationsCache cache;
+
+  const auto operations = cache.get(directive, owner);
+  EXPECT_EQ(cache.get(directive, owner), operations);
+  EXPECT_EQ(cache.size(), 1U);
+
+  TestHeaderMapImpl request;
+  operations->request.apply(request);
+  EXPECT_EQ(request, TestHeaderMapImpl({{"x-request", "a"}}));
+  TestHeaderMapImpl response;
+  operations->response.apply(response);
+  EXPECT_EQ(response, TestHeaderMapImpl({{"x-response", "b"}}));
+
+  // Another owner, or none, gets its own copy.
+  EXPECT_NE(cache.get(directive, std::make_shared<int>(0)), operations);
+  EXPECT_NE(cache.get(directive, nullptr), operations);
+  EXPECT_EQ(cache.size(), 2U);
+}
+
+TEST(HeaderOperationsCacheTest, EmptyDirectiveIsNotCached) {
+  HeaderOperationsCache cache;
+  const auto operations = cache.get(::istio::mixer::v1::RouteDirective(),
+                                    std::make_shared<int>(0));
+  EXPECT_TRUE(operations->request.empty());
+  EXPECT_TRUE(operations->response.empty());
+  EXPECT_EQ(cache.size(), 0U);
+}
+
+TEST(HeaderOperationsCacheTest, Bounded) {
+  ::istio::mixer::v1::RouteDirective directive;
+  addOperation(directive.mutable_request_header_operations(),
+               HeaderOperation::REMOVE, "x-a");
+  HeaderOperationsCache cache(10);
+  for (int i = 0; i < 25; i++) {
+    cache.get(directive, std::make_shared<int>(i));
+    EXPECT_LE(cache.size(), 10U);
+  }
+}
+
+}  // namespace
+}  // namespace Mixer
+}  // namespace Http
+}  // namespace Envoy
@@ -95,6 +95,18 @@ class ReportData : public ::istio::control::http::ReportData,
     return header_map;
   }
 
+  std::map<std::string, std::string> GetResponseHeaders(
+      const std::set<std::string> &names) const override {
+    std::map<std::string, std::string> header_map;
+    if (response_headers_) {
+      Utils::FindHeaders(*response_headers_, names, header_map);
+    }
+    if (trailers_) {
+      Utils::FindHeaders(*trailers_, names, header_map);
+    }
+    return header_map;
+  }
+
   void GetTracingHeaders(
       std::map<std::string, std::string> &tracing_headers) const override {
     Utils::FindHeaders(*request_headers_, Utils::TracingHeaderSet,
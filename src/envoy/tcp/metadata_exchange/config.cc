@@ -36,11 +36,10 @@ Network::FilterFactoryCb createFilterFactoryHelper(
   MetadataExchangeConfigSharedPtr filter_config(
       std::make_shared<MetadataExchangeConfig>(
           StatPrefix, proto_config.protocol(), filter_direction,
-          context.scope()));
-  return [filter_config,
-          &context](Network::FilterManager& filter_manager) -> void {
-    filter_manager.addFilter(std::make_shared<MetadataExchangeFilter>(
-        filter_config, context.localInfo()));
+          context.scope(), context.localInfo(), context.threadLocal()));
+  return [filter_config](Network::FilterManager& filter_manager) -> void {
+    filter_manager.addFilter(
+        std::make_shared<MetadataExchangeFilter>(filter_config));
   };
 }
 }  // namespace
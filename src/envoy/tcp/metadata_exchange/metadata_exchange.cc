@@ -34,7 +34,7 @@ namespace Tcp {
 namespace MetadataExchange {
 namespace {
 
-std::unique_ptr<::Envoy::Buffer::OwnedImpl> constructProxyHeaderData(
+std::string constructProxyHeaderData(
     const Envoy::ProtobufWkt::Any& proxy_data) {
   MetadataExchangeInitialHeader initial_header;
   std::string proxy_data_str = proxy_data.SerializeAsString();
@@ -44,13 +44,10 @@ std::unique_ptr<::Envoy::Buffer::OwnedImpl> constructProxyHeaderData(
       absl::ghtonl(MetadataExchangeInitialHeader::magic_number);
   initial_header.data_size = absl::ghtonl(proxy_data_str.length());
 
-  ::Envoy::Buffer::OwnedImpl initial_header_buffer{
-      absl::string_view(reinterpret_cast<const char*>(&initial_header),
-                        sizeof(MetadataExchangeInitialHeader))};
-  auto proxy_data_buffer =
-      std::make_unique<::Envoy::Buffer::OwnedImpl>(proxy_data_str);
-  proxy_data_buffer->prepend(initial_header_buffer);
-  return proxy_data_buffer;
+  std::string preamble(reinterpret_cast<const char*>(&initial_header),
+                       sizeof(MetadataExchangeInitialHeader));
+  preamble.append(proxy_data_str);
+  return preamble;
 }
 
 bool serializeToStringDeterministic(const google::protobuf::Struct& metadata,
@@ -69,12 +66,42 @@ bool serializeToStringDeterministic(const google::protobuf::Struct& metadata,
 
 MetadataExchangeConfig::MetadataExchangeConfig(
     const std::string& stat_prefix, const std::string& protocol,
-    const FilterDirection filter_direction, Stats::Scope& scope)
+    const FilterDirection filter_direction, Stats::Scope& scope,
+    const LocalInfo::LocalInfo& local_info, ThreadLocal::SlotAllocator& tls,
+    size_t max_peer_cache_size)
     : scope_(scope),
       stat_prefix_(stat_prefix),
       protocol_(protocol),
       filter_direction_(filter_direction),
-      stats_(generateStats(stat_prefix, scope)) {}
+      stats_(generateStats(stat_prefix, scope)),
+      preamble_(buildPreamble(local_info)),
+      tls_(tls.allocateSlot()) {
+  tls_->set([max_peer_cache_size](Event::Dispatcher&)
+                -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<PeerMetadataCache>(max_peer_cache_size);
+  });
+}
+
+std::string MetadataExchangeConfig::buildPreamble(
+    const LocalInfo::LocalInfo& local_info) {
+  Envoy::ProtobufWkt::Struct data;
+  Envoy::ProtobufWkt::Struct* metadata =
+      (*data.mutable_fields())[ExchangeMetadataHeader].mutable_struct_value();
+  if (local_info.node().has_metadata()) {
+    Wasm::Common::extractNodeMetadataValue(local_info.node().metadata(),
+                                           metadata);
+  }
+  const std::string& metadata_id = local_info.node().id();
+  if (!metadata_id.empty()) {
+    (*data.mutable_fields())[ExchangeMetadataHeaderId].set_string_value(
+        metadata_id);
+  }
+
+  Envoy::ProtobufWkt::Any metadata_any_value;
+  *metadata_any_value.mutable_type_url() = StructTypeUrl;
+  serializeToStringDeterministic(data, metadata_any_value.mutable_value());
+  return constructProxyHeaderData(metadata_any_value);
+}
 
 Network::FilterStatus MetadataExchangeFilter::onData(Buffer::Instance& data,
                                                      bool) {
@@ -177,26 +204,18 @@ void MetadataExchangeFilter::writeNodeMetadata() {
     return;
   }
 
-  Envoy::ProtobufWkt::Struct data;
-  Envoy::ProtobufWkt::Struct* metadata =
-      (*data.mutable_fields())[ExchangeMetadataHeader].mutable_struct_value();
-  getMetadata(metadata);
-  std::string metadata_id = getMetadataId();
-  if (!metadata_id.empty()) {
-    (*data.mutable_fields())[ExchangeMetadataHeaderId].set_string_value(
-        metadata_id);
-  }
-  if (data.fields_size() > 0) {
-    Envoy::ProtobufWkt::Any metadata_any_value;
-    *metadata_any_value.mutable_type_url() = StructTypeUrl;
-    std::string serialized_data;
-    serializeToStringDeterministic(data, &serialized_data);
-    *metadata_any_value.mutable_value() = serialized_data;
-    std::unique_ptr<::Envoy::Buffer::OwnedImpl> buf =
-        constructProxyHeaderData(metadata_any_value);
-    write_callbacks_->injectWriteDataToFilterChain(*buf, false);
-    config_->stats().metadata_added_.inc();
-  }
+  // The preamble is shared by all connections: the slice references the
+  // config's bytes and keeps the config alive until it is written.
+  const absl::string_view preamble = config_->preamble();
+  ::Envoy::Buffer::OwnedImpl buf;
+  buf.addBufferFragment(*new ::Envoy::Buffer::BufferFragmentImpl(
+      preamble.data(), preamble.size(),
+      [config = config_](const void*, size_t,
+                         const ::Envoy::Buffer::BufferFragmentImpl* fragment) {
+        delete fragment;
+      }));
+  write_callbacks_->injectWriteDataToFilterChain(buf, false);
+  config_->stats().metadata_added_.inc();
 
   conn_state_ = ReadingInitialHeader;
 }
@@ -237,11 +256,17 @@ void MetadataExchangeFilter::tryReadProxyData(Buffer::Instance& data) {
     conn_state_ = NeedMoreDataProxyHeader;
     return;
   }
-  std::string proxy_data_buf =
-      std::string(static_cast<const char*>(data.linearize(proxy_data_length_)),
-                  proxy_data_length_);
-  Envoy::ProtobufWkt::Any proxy_data;
-  if (!proxy_data.ParseFromString(proxy_data_buf)) {
+  // Parse the proxy data in place and only copy out the peer metadata, unless
+  // the same bytes were received before.
+  bool cache_hit;
+  const auto peer = config_->peerMetadataCache().get(data, proxy_data_length_,
+                                                     &cache_hit);
+  if (cache_hit) {
+    config_->stats().metadata_cache_hit_.inc();
+  } else {
+    config_->stats().metadata_cache_miss_.inc();
+  }
+  if (!peer) {
     config_->stats().header_not_found_.inc();
     conn_state_ = Invalid;
     return;
@@ -249,24 +274,17 @@ void MetadataExchangeFilter::tryReadProxyData(Buffer::Instance& data) {
   data.drain(proxy_data_length_);
 
   // Set Metadata
-  Envoy::ProtobufWkt::Struct value_struct =
-      Envoy::MessageUtil::anyConvert<Envoy::ProtobufWkt::Struct>(proxy_data);
-  auto key_metadata_it = value_struct.fields().find(ExchangeMetadataHeader);
-  if (key_metadata_it != value_struct.fields().end()) {
-    Envoy::ProtobufWkt::Value val = key_metadata_it->second;
+  if (peer->has_metadata) {
     setFilterState(config_->filter_direction_ == FilterDirection::Downstream
                        ? DownstreamMetadataKey
                        : UpstreamMetadataKey,
-                   val.struct_value().SerializeAsString());
+                   peer->metadata);
   }
-  const auto key_metadata_id_it =
-      value_struct.fields().find(ExchangeMetadataHeaderId);
-  if (key_metadata_id_it != value_struct.fields().end()) {
-    Envoy::ProtobufWkt::Value val = key_metadata_it->second;
+  if (peer->has_id) {
     setFilterState(config_->filter_direction_ == FilterDirection::Downstream
                        ? DownstreamMetadataIdKey
                        : UpstreamMetadataIdKey,
-                   val.string_value());
+                   peer->id);
   }
 }
 
@@ -278,23 +296,6 @@ void MetadataExchangeFilter::setFilterState(const std::string& key,
       StreamInfo::FilterState::StateType::Mutable);
 }
 
-void MetadataExchangeFilter::getMetadata(google::protobuf::Struct* metadata) {
-  if (local_info_.node().has_metadata()) {
-    google::protobuf::Struct node_metadata = local_info_.node().metadata();
-    google::protobuf::Value value_struct;
-
-    const auto status =
-        Wasm::Common::extractNodeMetadataValue(node_metadata, metadata);
-    if (!status.ok()) {
-      return;
-    }
-  }
-}
-
-std::string MetadataExchangeFilter::getMetadataId() {
-  return local_info_.node().id();
-}
-
 }  // namespace MetadataExchange
 }  // namespace Tcp
 }  // namespace Envoy
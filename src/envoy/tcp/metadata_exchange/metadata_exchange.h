@@ -17,6 +17,7 @@
 
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "common/protobuf/protobuf.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/filter.h"
@@ -24,7 +25,9 @@
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/stream_info/filter_state.h"
+#include "envoy/thread_local/thread_local.h"
 #include "src/envoy/tcp/metadata_exchange/config/metadata_exchange.pb.h"
+#include "src/envoy/tcp/metadata_exchange/metadata_exchange_proxy_data.h"
 
 namespace Envoy {
 namespace Tcp {
@@ -38,7 +41,9 @@ namespace MetadataExchange {
   COUNTER(alpn_protocol_found)               \
   COUNTER(initial_header_not_found)          \
   COUNTER(header_not_found)                  \
-  COUNTER(metadata_added)
+  COUNTER(metadata_added)                    \
+  COUNTER(metadata_cache_hit)                \
+  COUNTER(metadata_cache_miss)
 
 /**
  * Struct definition for all MetadataExchange stats. @see stats_macros.h
@@ -61,10 +66,23 @@ class MetadataExchangeConfig {
   MetadataExchangeConfig(const std::string& stat_prefix,
                          const std::string& protocol,
                          const FilterDirection filter_direction,
-                         Stats::Scope& scope);
+                         Stats::Scope& scope,
+                         const LocalInfo::LocalInfo& local_info,
+                         ThreadLocal::SlotAllocator& tls,
+                         size_t max_peer_cache_size = DefaultMaxPeerCacheSize);
 
   const MetadataExchangeStats& stats() { return stats_; }
 
+  // Initial header and proxy data written on every connection. The node
+  // metadata does not change for the life of the config, so the bytes are
+  // computed once.
+  absl::string_view preamble() const { return preamble_; }
+
+  // Peer metadata received on previous connections of this worker.
+  PeerMetadataCache& peerMetadataCache() {
+    return tls_->getTyped<PeerMetadataCache>();
+  }
+
   // Scope for the stats.
   Stats::Scope& scope_;
   // Stat prefix.
@@ -75,13 +93,20 @@ class MetadataExchangeConfig {
   const FilterDirection filter_direction_;
   // Stats for MetadataExchange Filter.
   MetadataExchangeStats stats_;
+  static constexpr size_t DefaultMaxPeerCacheSize = 500;
 
  private:
+  static std::string buildPreamble(const LocalInfo::LocalInfo& local_info);
+
   MetadataExchangeStats generateStats(const std::string& prefix,
                                       Stats::Scope& scope) {
     return MetadataExchangeStats{
         ALL_METADATA_EXCHANGE_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
   }
+
+  const std::string preamble_;
+  // Thread local slot holding the peer metadata cache of each worker.
+  ThreadLocal::SlotPtr tls_;
 };
 
 using MetadataExchangeConfigSharedPtr = std::shared_ptr<MetadataExchangeConfig>;
@@ -91,11 +116,8 @@ using MetadataExchangeConfigSharedPtr = std::shared_ptr<MetadataExchangeConfig>;
  */
 class MetadataExchangeFilter : public Network::Filter {
  public:
-  MetadataExchangeFilter(MetadataExchangeConfigSharedPtr config,
-                         const LocalInfo::LocalInfo& local_info)
-      : config_(config),
-        local_info_(local_info),
-        conn_state_(ConnProtocolNotRead) {}
+  MetadataExchangeFilter(MetadataExchangeConfigSharedPtr config)
+      : config_(config), conn_state_(ConnProtocolNotRead) {}
 
   // Network::ReadFilter
   Network::FilterStatus onData(Buffer::Instance& data,
@@ -124,21 +146,14 @@ class MetadataExchangeFilter : public Network::Filter {
 
   // Tries to read data after initial proxy header. This is currently in the
   // form of google::protobuf::any which encapsulates google::protobuf::struct.
+  // The data is parsed directly from the buffer slices.
   void tryReadProxyData(Buffer::Instance& data);
 
   // Helper function to share the metadata with other filters.
   void setFilterState(const std::string& key, absl::string_view value);
 
-  // Helper function to get Dynamic metadata.
-  void getMetadata(google::protobuf::Struct* metadata);
-
-  // Helper function to get metadata id.
-  std::string getMetadataId();
-
   // Config for MetadataExchange filter.
   MetadataExchangeConfigSharedPtr config_;
-  // LocalInfo instance.
-  const LocalInfo::LocalInfo& local_info_;
   // Read callback instance.
   Network::ReadFilterCallbacks* read_callbacks_{};
   // Write callback instance.
@@ -158,13 +173,6 @@ class MetadataExchangeFilter : public Network::Filter {
   const std::string DownstreamMetadataIdKey =
       "envoy.wasm.metadata_exchange.downstream_id";
 
-  const std::string ExchangeMetadataHeader = "x-envoy-peer-metadata";
-  const std::string ExchangeMetadataHeaderId = "x-envoy-peer-metadata-id";
-
-  // Type url of google::protobug::struct.
-  const std::string StructTypeUrl =
-      "type.googleapis.com/google.protobuf.Struct";
-
   // Captures the state machine of what is going on in the filter.
   enum {
     ConnProtocolNotRead,        // Connection Protocol has not been read yet
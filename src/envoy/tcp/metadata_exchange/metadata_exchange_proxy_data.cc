@@ -0,0 +1,365 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/metadata_exchange/metadata_exchange_proxy_data.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/strings/string_view.h"
+#include "google/protobuf/wire_format_lite.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace MetadataExchange {
+namespace {
+
+using Protobuf::internal::WireFormatLite;
+using Protobuf::io::CodedInputStream;
+
+// Field numbers of google.protobuf.Any, Struct, its map entries and Value.
+constexpr int kAnyTypeUrl = 1;
+constexpr int kAnyValue = 2;
+constexpr int kStructFields = 1;
+constexpr int kEntryKey = 1;
+constexpr int kEntryValue = 2;
+constexpr int kValueLastKind = 6;
+constexpr int kValueStringValue = 3;
+constexpr int kValueStructValue = 5;
+
+// Result of the fast path. Unusual but valid encodings are left to the
+// protobuf library.
+enum class ParseResult { Ok, Error, Unsupported };
+
+bool isLengthDelimited(uint32_t tag) {
+  return WireFormatLite::GetTagWireType(tag) ==
+         WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+}
+
+bool readBytes(CodedInputStream* input, std::string* out) {
+  uint32_t length;
+  return input->ReadVarint32(&length) &&
+         input->ReadString(out, static_cast<int>(length));
+}
+
+// Reads a length delimited message with parse_fn.
+template <typename ParseFn>
+ParseResult readMessage(CodedInputStream* input, ParseFn parse_fn) {
+  uint32_t length;
+  if (!input->ReadVarint32(&length)) {
+    return ParseResult::Error;
+  }
+  const auto limit = input->PushLimit(static_cast<int>(length));
+  const ParseResult result = parse_fn();
+  if (result == ParseResult::Ok && !input->ConsumedEntireMessage()) {
+    return ParseResult::Error;
+  }
+  input->PopLimit(limit);
+  return result;
+}
+
+// Reads a google.protobuf.Value and copies the bytes of the given kind field
+// to out. Other kinds leave out empty.
+ParseResult parseValue(CodedInputStream* input, int kind, std::string* out) {
+  bool has_kind = false;
+  uint32_t tag;
+  while ((tag = input->ReadTag()) != 0) {
+    const int field = WireFormatLite::GetTagFieldNumber(tag);
+    if (field >= 1 && field <= kValueLastKind) {
+      // The kind is a oneof; repeating it would need merge semantics.
+      if (has_kind) {
+        return ParseResult::Unsupported;
+      }
+      has_kind = true;
+      if (field == kind && isLengthDelimited(tag)) {
+        if (!readBytes(input, out)) {
+          return ParseResult::Error;
+        }
+        continue;
+      }
+    }
+    if (!WireFormatLite::SkipField(input, tag)) {
+      return ParseResult::Error;
+    }
+  }
+  return ParseResult::Ok;
+}
+
+// Reads an entry of the Struct fields map. The key is expected before the
+// value, which is how protobuf serializes map entries.
+ParseResult parseEntry(CodedInputStream* input, PeerMetadata* peer) {
+  std::string key;
+  bool has_key = false;
+  bool has_value = false;
+  uint32_t tag;
+  while ((tag = input->ReadTag()) != 0) {
+    const int field = WireFormatLite::GetTagFieldNumber(tag);
+    if (field == kEntryKey && isLengthDelimited(tag)) {
+      if (has_key || !readBytes(input, &key)) {
+        return has_key ? ParseResult::Unsupported : ParseResult::Error;
+      }
+      has_key = true;
+      continue;
+    }
+    if (field == kEntryValue && isLengthDelimited(tag)) {
+      if (!has_key || has_value) {
+        return ParseResult::Unsupported;
+      }
+      has_value = true;
+      ParseResult result = ParseResult::Ok;
+      if (key == ExchangeMetadataHeader) {
+        peer->has_metadata = true;
+        peer->metadata.clear();
+        result = readMessage(input, [&] {
+          return parseValue(input, kValueStructValue, &peer->metadata);
+        });
+      } else if (key == ExchangeMetadataHeaderId) {
+        peer->has_id = true;
+        peer->id.clear();
+        result = readMessage(input, [&] {
+          return parseValue(input, kValueStringValue, &peer->id);
+        });
+      } else if (!WireFormatLite::SkipField(input, tag)) {
+        result = ParseResult::Error;
+      }
+      if (result != ParseResult::Ok) {
+        return result;
+      }
+      continue;
+    }
+    if (!WireFormatLite::SkipField(input, tag)) {
+      return ParseResult::Error;
+    }
+  }
+  // A map entry without a value still adds the key.
+  if (has_key && !has_value) {
+    return ParseResult::Unsupported;
+  }
+  return ParseResult::Ok;
+}
+
+ParseResult parseStruct(CodedInputStream* input, PeerMetadata* peer) {
+  uint32_t tag;
+  while ((tag = input->ReadTag()) != 0) {
+    if (WireFormatLite::GetTagFieldNumber(tag) == kStructFields &&
+        isLengthDelimited(tag)) {
+      const ParseResult result =
+          readMessage(input, [&] { return parseEntry(input, peer); });
+      if (result != ParseResult::Ok) {
+        return result;
+      }
+    } else if (!WireFormatLite::SkipField(input, tag)) {
+      return ParseResult::Error;
+    }
+  }
+  return ParseResult::Ok;
+}
+
+ParseResult parseAny(CodedInputStream* input, PeerMetadata* peer) {
+  bool has_type_url = false;
+  bool has_value = false;
+  uint32_t tag;
+  while ((tag = input->ReadTag()) != 0) {
+    const int field = WireFormatLite::GetTagFieldNumber(tag);
+    if (field == kAnyTypeUrl && isLengthDelimited(tag)) {
+      std::string type_url;
+      if (has_type_url || !readBytes(input, &type_url)) {
+        return has_type_url ? ParseResult::Unsupported : ParseResult::Error;
+      }
+      if (type_url != StructTypeUrl) {
+        return ParseResult::Unsupported;
+      }
+      has_type_url = true;
+    } else if (field == kAnyValue && isLengthDelimited(tag)) {
+      if (has_value) {
+        return ParseResult::Unsupported;
+      }
+      has_value = true;
+      const ParseResult result =
+          readMessage(input, [&] { return parseStruct(input, peer); });
+      if (result != ParseResult::Ok) {
+        return result;
+      }
+    } else if (!WireFormatLite::SkipField(input, tag)) {
+      return ParseResult::Error;
+    }
+  }
+  return has_type_url ? ParseResult::Ok : ParseResult::Unsupported;
+}
+
+// Decodes the proxy data with the protobuf library.
+bool parseProxyDataMessage(const Buffer::Instance& data, uint64_t length,
+                           PeerMetadata* peer) {
+  BufferInputStream stream(data);
+  CodedInputStream input(&stream);
+  input.PushLimit(static_cast<int>(length));
+  ProtobufWkt::Any any;
+  ProtobufWkt::Struct value_struct;
+  if (!any.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage() ||
+      !any.UnpackTo(&value_struct)) {
+    return false;
+  }
+
+  const auto& fields = value_struct.fields();
+  const auto key_metadata_it = fields.find(ExchangeMetadataHeader);
+  if (key_metadata_it != fields.end()) {
+    peer->has_metadata = true;
+    key_metadata_it->second.struct_value().SerializeToString(&peer->metadata);
+  }
+  const auto key_metadata_id_it = fields.find(ExchangeMetadataHeaderId);
+  if (key_metadata_id_it != fields.end()) {
+    peer->has_id = true;
+    peer->id = key_metadata_id_it->second.string_value();
+  }
+  return true;
+}
+
+// FNV-1a over length bytes of the buffer, independent of how the bytes are
+// split into slices.
+uint64_t hashProxyData(const Buffer::Instance& data, uint64_t length) {
+  uint64_t hash = 14695981039346656037ULL;
+  BufferInputStream stream(data);
+  const void* chunk;
+  int size;
+  while (length > 0 && stream.Next(&chunk, &size)) {
+    const auto* bytes = static_cast<const uint8_t*>(chunk);
+    const uint64_t n = std::min<uint64_t>(size, length);
+    for (uint64_t i = 0; i < n; i++) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    length -= n;
+  }
+  return hash;
+}
+
+// Compares length bytes of the buffer with expected.
+bool proxyDataEquals(const Buffer::Instance& data, uint64_t length,
+                     absl::string_view expected) {
+  if (expected.size() != length) {
+    return false;
+  }
+  BufferInputStream stream(data);
+  const void* chunk;
+  int size;
+  while (!expected.empty() && stream.Next(&chunk, &size)) {
+    const size_t n = std::min<size_t>(size, expected.size());
+    if (memcmp(chunk, expected.data(), n) != 0) {
+      return false;
+    }
+    expected.remove_prefix(n);
+  }
+  return expected.empty();
+}
+
+}  // namespace
+
+BufferInputStream::BufferInputStream(const Buffer::Instance& buffer) {
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  slices_.resize(num_slices);
+  buffer.getRawSlices(slices_.data(), num_slices);
+}
+
+bool BufferInputStream::Next(const void** data, int* size) {
+  while (index_ < slices_.size() && offset_ == slices_[index_].len_) {
+    index_++;
+    offset_ = 0;
+  }
+  if (index_ == slices_.size()) {
+    return false;
+  }
+  const auto& slice = slices_[index_];
+  *data = static_cast<const uint8_t*>(slice.mem_) + offset_;
+  *size = static_cast<int>(slice.len_ - offset_);
+  offset_ = slice.len_;
+  byte_count_ += *size;
+  return true;
+}
+
+void BufferInputStream::BackUp(int count) {
+  offset_ -= count;
+  byte_count_ -= count;
+}
+
+bool BufferInputStream::Skip(int count) {
+  const void* data;
+  int size;
+  while (count > 0 && Next(&data, &size)) {
+    if (size > count) {
+      BackUp(size - count);
+      size = count;
+    }
+    count -= size;
+  }
+  return count == 0;
+}
+
+bool parseProxyData(const Buffer::Instance& data, uint64_t length,
+                    PeerMetadata* peer) {
+  {
+    BufferInputStream stream(data);
+    CodedInputStream input(&stream);
+    input.PushLimit(static_cast<int>(length));
+    const ParseResult result = parseAny(&input, peer);
+    if (result == ParseResult::Ok && input.ConsumedEntireMessage()) {
+      return true;
+    }
+    if (result == ParseResult::Error) {
+      return false;
+    }
+  }
+  *peer = PeerMetadata();
+  return parseProxyDataMessage(data, length, peer);
+}
+
+PeerMetadataConstSharedPtr PeerMetadataCache::get(const Buffer::Instance& data,
+                                                  uint64_t length, bool* hit) {
+  const uint64_t hash = hashProxyData(data, length);
+  auto it = entries_.find(hash);
+  if (it != entries_.end() &&
+      proxyDataEquals(data, length, it->second->proxy_data)) {
+    *hit = true;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->peer;
+  }
+
+  *hit = false;
+  auto peer = std::make_shared<PeerMetadata>();
+  if (!parseProxyData(data, length, peer.get())) {
+    return nullptr;
+  }
+  if (max_size_ == 0) {
+    return peer;
+  }
+  if (it != entries_.end()) {
+    // The hash collides with other proxy data, which is replaced.
+    lru_.erase(it->second);
+    entries_.erase(it);
+  } else if (entries_.size() >= max_size_) {
+    entries_.erase(lru_.back().hash);
+    lru_.pop_back();
+  }
+  lru_.emplace_front();
+  Entry& entry = lru_.front();
+  entry.hash = hash;
+  entry.proxy_data.resize(length);
+  data.copyOut(0, length, &entry.proxy_data[0]);
+  entry.peer = peer;
+  entries_.emplace(hash, lru_.begin());
+  return peer;
+}
+
+}  // namespace MetadataExchange
+}  // namespace Tcp
+}  // namespace Envoy
@@ -0,0 +1,123 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/protobuf/protobuf.h"
+#include "envoy/buffer/buffer.h"
+#include "envoy/thread_local/thread_local.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace MetadataExchange {
+
+// Keys of the exchanged google::protobuf::Struct.
+constexpr char ExchangeMetadataHeader[] = "x-envoy-peer-metadata";
+constexpr char ExchangeMetadataHeaderId[] = "x-envoy-peer-metadata-id";
+
+// Type url of google::protobuf::Struct.
+constexpr char StructTypeUrl[] = "type.googleapis.com/google.protobuf.Struct";
+
+/**
+ * Peer metadata carried by the proxy data, in the form shared with other
+ * filters.
+ */
+struct PeerMetadata {
+  // Serialized google::protobuf::Struct of the peer node metadata.
+  std::string metadata;
+  bool has_metadata{false};
+  // Peer node id.
+  std::string id;
+  bool has_id{false};
+};
+
+using PeerMetadataConstSharedPtr = std::shared_ptr<const PeerMetadata>;
+
+/**
+ * ZeroCopyInputStream over the slices of a buffer. The buffer is neither
+ * copied nor drained, and must outlive the stream.
+ */
+class BufferInputStream : public Protobuf::io::ZeroCopyInputStream {
+ public:
+  BufferInputStream(const Buffer::Instance& buffer);
+
+  // Protobuf::io::ZeroCopyInputStream
+  bool Next(const void** data, int* size) override;
+  void BackUp(int count) override;
+  bool Skip(int count) override;
+  int64_t ByteCount() const override { return byte_count_; }
+
+ private:
+  std::vector<Buffer::RawSlice> slices_;
+  // Slice being read and offset of the next byte in it.
+  size_t index_{0};
+  uint64_t offset_{0};
+  int64_t byte_count_{0};
+};
+
+/**
+ * Reads the peer metadata from length bytes of proxy data, a
+ * google::protobuf::Any wrapping a google::protobuf::Struct. The nested
+ * metadata Struct is copied out in its serialized form without decoding the
+ * Any or the Struct. Returns false if the proxy data cannot be parsed.
+ */
+bool parseProxyData(const Buffer::Instance& data, uint64_t length,
+                    PeerMetadata* peer);
+
+/**
+ * Bounded cache of parsed peer metadata keyed by the raw proxy data. Within a
+ * mesh, a peer sends the same bytes on every connection. Each worker has its
+ * own cache in a thread local slot, so it needs no locking. The least recently
+ * used entry is evicted when the cache is full.
+ */
+class PeerMetadataCache : public ThreadLocal::ThreadLocalObject {
+ public:
+  PeerMetadataCache(size_t max_size) : max_size_(max_size) {}
+
+  /**
+   * Returns the peer metadata in length bytes of proxy data at the start of
+   * data, parsing and caching it on a miss, or nullptr if the proxy data
+   * cannot be parsed. hit is set to whether the cache had the entry.
+   */
+  PeerMetadataConstSharedPtr get(const Buffer::Instance& data, uint64_t length,
+                                 bool* hit);
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    // Raw proxy data, compared on lookup to rule out hash collisions.
+    std::string proxy_data;
+    PeerMetadataConstSharedPtr peer;
+  };
+
+  const size_t max_size_;
+  // Entries from the most to the least recently used.
+  std::list<Entry> lru_;
+  // Keyed by the hash of the raw proxy data.
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> entries_;
+};
+
+}  // namespace MetadataExchange
+}  // namespace Tcp
+}  // namespace Envoy
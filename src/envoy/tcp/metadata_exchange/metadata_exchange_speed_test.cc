@@ -0,0 +1,174 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+#include "src/envoy/tcp/metadata_exchange/metadata_exchange.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Tcp {
+namespace MetadataExchange {
+namespace {
+
+// Sets up the mocks shared by all connections of a benchmark.
+class ConnectionFixture {
+ public:
+  ConnectionFixture() {
+    node_.set_id(
+        "sidecar~10.44.0.7~productpage-v1-84975bc778-pxz2w.default~default."
+        "svc.cluster.local");
+    auto& fields = *node_.mutable_metadata()->mutable_fields();
+    fields["EXCHANGE_KEYS"].set_string_value(
+        "NAME,NAMESPACE,INSTANCE_IPS,LABELS,OWNER,PLATFORM_METADATA,"
+        "WORKLOAD_NAME,CANONICAL_TELEMETRY_SERVICE,MESH_ID,SERVICE_ACCOUNT");
+    fields["NAME"].set_string_value("productpage-v1-84975bc778-pxz2w");
+    fields["NAMESPACE"].set_string_value("default");
+    fields["INSTANCE_IPS"].set_string_value("10.44.0.7");
+    fields["OWNER"].set_string_value(
+        "kubernetes://apis/apps/v1/namespaces/default/deployments/"
+        "productpage-v1");
+    fields["WORKLOAD_NAME"].set_string_value("productpage-v1");
+    fields["MESH_ID"].set_string_value("mesh");
+    fields["SERVICE_ACCOUNT"].set_string_value("bookinfo-productpage");
+    auto& labels = *fields["LABELS"].mutable_struct_value()->mutable_fields();
+    labels["app"].set_string_value("productpage");
+    labels["version"].set_string_value("v1");
+    labels["pod-template-hash"].set_string_value("84975bc778");
+
+    ON_CALL(local_info_, node()).WillByDefault(ReturnRef(node_));
+    ON_CALL(read_filter_callbacks_.connection_, nextProtocol())
+        .WillByDefault(Return("istio2"));
+    ON_CALL(read_filter_callbacks_.connection_, streamInfo())
+        .WillByDefault(ReturnRef(stream_info_));
+    ON_CALL(write_filter_callbacks_, injectWriteDataToFilterChain(_, _))
+        .WillByDefault(Invoke([](Buffer::Instance& data, bool) {
+          benchmark::DoNotOptimize(data.length());
+          data.drain(data.length());
+        }));
+  }
+
+  MetadataExchangeConfigSharedPtr newConfig(
+      size_t max_peer_cache_size =
+          MetadataExchangeConfig::DefaultMaxPeerCacheSize) {
+    return std::make_shared<MetadataExchangeConfig>(
+        "metadata_exchange.", "istio2", FilterDirection::Upstream, store_,
+        local_info_, tls_, max_peer_cache_size);
+  }
+
+  // Runs the part of a new connection that writes the node metadata.
+  void newConnection(MetadataExchangeConfigSharedPtr config) {
+    MetadataExchangeFilter filter(config);
+    filter.initializeReadFilterCallbacks(read_filter_callbacks_);
+    filter.initializeWriteFilterCallbacks(write_filter_callbacks_);
+    Buffer::OwnedImpl data;
+    filter.onWrite(data, false);
+  }
+
+  // Runs a new connection that receives the peer's proxy data.
+  void newConnection(MetadataExchangeConfigSharedPtr config,
+                     absl::string_view peer_preamble) {
+    MetadataExchangeFilter filter(config);
+    filter.initializeReadFilterCallbacks(read_filter_callbacks_);
+    filter.initializeWriteFilterCallbacks(write_filter_callbacks_);
+    Buffer::OwnedImpl data(peer_preamble);
+    filter.onData(data, false);
+  }
+
+ private:
+  envoy::api::v2::core::Node node_;
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Network::MockReadFilterCallbacks> read_filter_callbacks_;
+  NiceMock<Network::MockWriteFilterCallbacks> write_filter_callbacks_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+};
+
+}  // namespace
+
+// New connections with the preamble computed once per config.
+static void BM_NewConnection(benchmark::State& state) {
+  ConnectionFixture fixture;
+  auto config = fixture.newConfig();
+  for (auto _ : state) {
+    fixture.newConnection(config);
+  }
+}
+BENCHMARK(BM_NewConnection);
+
+// New connections that build the preamble every time, as the filter used to.
+static void BM_NewConnectionBuildPreamble(benchmark::State& state) {
+  ConnectionFixture fixture;
+  for (auto _ : state) {
+    fixture.newConnection(fixture.newConfig());
+  }
+}
+BENCHMARK(BM_NewConnectionBuildPreamble);
+
+// New connections that read the peer metadata. The peer sends the same kind
+// of node metadata as the local node. After the first connection, the peer
+// metadata comes from the cache.
+static void BM_NewConnectionReadProxyData(benchmark::State& state) {
+  ConnectionFixture fixture;
+  auto config = fixture.newConfig();
+  const std::string peer_preamble(config->preamble());
+  for (auto _ : state) {
+    fixture.newConnection(config, peer_preamble);
+  }
+}
+BENCHMARK(BM_NewConnectionReadProxyData);
+
+// New connections alternating between two peers with a single entry cache,
+// so that every connection misses the cache.
+static void BM_NewConnectionReadProxyDataCacheMiss(benchmark::State& state) {
+  ConnectionFixture fixture;
+  auto config = fixture.newConfig(1);
+  std::string peer_preambles[2] = {std::string(config->preamble()),
+                                   std::string(config->preamble())};
+  // Change a byte of the metadata of the second peer.
+  auto& last = peer_preambles[1][peer_preambles[1].size() - 1];
+  last = last == 'a' ? 'b' : 'a';
+  size_t i = 0;
+  for (auto _ : state) {
+    fixture.newConnection(config, peer_preambles[i++ % 2]);
+  }
+}
+BENCHMARK(BM_NewConnectionReadProxyDataCacheMiss);
+
+}  // namespace MetadataExchange
+}  // namespace Tcp
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -17,6 +17,7 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/protobuf/protobuf.h"
+#include "extensions/common/wasm/wasm_state.h"
 #include "gmock/gmock.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
@@ -24,8 +25,11 @@
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/protobuf/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 
 using ::google::protobuf::util::MessageDifferencer;
+using testing::_;
+using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
@@ -51,6 +55,20 @@ void ConstructProxyHeaderData(::Envoy::Buffer::OwnedImpl& serialized_header,
   serialized_header.add(::Envoy::Buffer::OwnedImpl{serialized_proxy_header});
 }
 
+// Adds data to buffer in fragments of fragment_size bytes, each in its own
+// slice. data must outlive the buffer.
+void addFragmented(::Envoy::Buffer::Instance& buffer, absl::string_view data,
+                   size_t fragment_size) {
+  for (size_t offset = 0; offset < data.size(); offset += fragment_size) {
+    buffer.addBufferFragment(*new ::Envoy::Buffer::BufferFragmentImpl(
+        data.data() + offset, std::min(fragment_size, data.size() - offset),
+        [](const void*, size_t,
+           const ::Envoy::Buffer::BufferFragmentImpl* fragment) {
+          delete fragment;
+        }));
+  }
+}
+
 }  // namespace
 
 class MetadataExchangeFilterTest : public testing::Test {
@@ -58,11 +76,6 @@ class MetadataExchangeFilterTest : public testing::Test {
   MetadataExchangeFilterTest() { ENVOY_LOG_MISC(info, "test"); }
 
   void initialize() {
-    config_ = std::make_shared<MetadataExchangeConfig>(
-        stat_prefix_, "istio2", FilterDirection::Downstream, scope_);
-    filter_ = std::make_unique<MetadataExchangeFilter>(config_, local_info_);
-    filter_->initializeReadFilterCallbacks(read_filter_callbacks_);
-    filter_->initializeWriteFilterCallbacks(write_filter_callbacks_);
     metadata_node_.set_id("test");
     auto node_metadata_map =
         metadata_node_.mutable_metadata()->mutable_fields();
@@ -72,6 +85,35 @@ class MetadataExchangeFilterTest : public testing::Test {
     EXPECT_CALL(read_filter_callbacks_.connection_, streamInfo())
         .WillRepeatedly(ReturnRef(stream_info_));
     EXPECT_CALL(local_info_, node()).WillRepeatedly(ReturnRef(metadata_node_));
+    config_ = std::make_shared<MetadataExchangeConfig>(
+        stat_prefix_, "istio2", FilterDirection::Downstream, scope_,
+        local_info_, tls_);
+    filter_ = std::make_unique<MetadataExchangeFilter>(config_);
+    filter_->initializeReadFilterCallbacks(read_filter_callbacks_);
+    filter_->initializeWriteFilterCallbacks(write_filter_callbacks_);
+  }
+
+  // Serialized initial header and proxy data carrying productpage_value_.
+  std::string productpagePreamble(const std::string& id) {
+    Envoy::ProtobufWkt::Struct data;
+    *(*data.mutable_fields())["x-envoy-peer-metadata"].mutable_struct_value() =
+        productpage_value_;
+    if (!id.empty()) {
+      (*data.mutable_fields())["x-envoy-peer-metadata-id"].set_string_value(
+          id);
+    }
+    Envoy::ProtobufWkt::Any any_value;
+    any_value.PackFrom(data);
+    ::Envoy::Buffer::OwnedImpl buffer;
+    MetadataExchangeInitialHeader initial_header;
+    ConstructProxyHeaderData(buffer, any_value, &initial_header);
+    return buffer.toString();
+  }
+
+  const std::string& filterState(const std::string& key) {
+    return stream_info_.filterState()
+        .getDataReadOnly<::Envoy::Extensions::Common::Wasm::WasmState>(key)
+        .value();
   }
 
   void initializeStructValues() {
@@ -95,6 +137,7 @@ class MetadataExchangeFilterTest : public testing::Test {
   NiceMock<Network::MockWriteFilterCallbacks> write_filter_callbacks_;
   Network::MockConnection connection_;
   NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
   NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info_;
   envoy::api::v2::core::Node metadata_node_;
 };
@@ -126,6 +169,260 @@ TEST_F(MetadataExchangeFilterTest, MetadataExchangeFound) {
   EXPECT_EQ(1UL, config_->stats().alpn_protocol_found_.value());
 }
 
+TEST_F(MetadataExchangeFilterTest, PrecomputedPreamble) {
+  initialize();
+  initializeStructValues();
+
+  EXPECT_CALL(read_filter_callbacks_.connection_, nextProtocol())
+      .WillRepeatedly(Return("istio2"));
+
+  // What used to be built on every connection.
+  Envoy::ProtobufWkt::Struct data;
+  *(*data.mutable_fields())["x-envoy-peer-metadata"].mutable_struct_value() =
+      details_value_;
+  (*data.mutable_fields())["x-envoy-peer-metadata-id"].set_string_value(
+      "test");
+  Envoy::ProtobufWkt::Any any_value;
+  *any_value.mutable_type_url() = "type.googleapis.com/google.protobuf.Struct";
+  {
+    google::protobuf::io::StringOutputStream output(any_value.mutable_value());
+    google::protobuf::io::CodedOutputStream coded_output(&output);
+    coded_output.SetSerializationDeterministic(true);
+    data.SerializeToCodedStream(&coded_output);
+  }
+  ::Envoy::Buffer::OwnedImpl want;
+  MetadataExchangeInitialHeader initial_header;
+  ConstructProxyHeaderData(want, any_value, &initial_header);
+  EXPECT_EQ(want.toString(), config_->preamble());
+
+  // Every connection writes the same bytes.
+  std::vector<std::string> written;
+  EXPECT_CALL(write_filter_callbacks_, injectWriteDataToFilterChain(_, false))
+      .WillRepeatedly(Invoke([&written](Buffer::Instance& buf, bool) {
+        written.push_back(buf.toString());
+        buf.drain(buf.length());
+      }));
+  for (int i = 0; i < 3; i++) {
+    MetadataExchangeFilter filter(config_);
+    filter.initializeReadFilterCallbacks(read_filter_callbacks_);
+    filter.initializeWriteFilterCallbacks(write_filter_callbacks_);
+    ::Envoy::Buffer::OwnedImpl empty;
+    filter.onWrite(empty, false);
+  }
+  ASSERT_EQ(3UL, written.size());
+  for (const auto& bytes : written) {
+    EXPECT_EQ(want.toString(), bytes);
+  }
+  EXPECT_EQ(3UL, config_->stats().metadata_added_.value());
+}
+
+TEST_F(MetadataExchangeFilterTest, FragmentedProxyData) {
+  initialize();
+  initializeStructValues();
+
+  EXPECT_CALL(read_filter_callbacks_.connection_, nextProtocol())
+      .WillRepeatedly(Return("istio2"));
+
+  const std::string preamble = productpagePreamble("productpage-id");
+  ::Envoy::Buffer::OwnedImpl data;
+  addFragmented(data, preamble, 1);
+  data.add("world");
+
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue,
+            filter_->onData(data, false));
+  EXPECT_EQ(data.toString(), "world");
+  EXPECT_EQ(0UL, config_->stats().header_not_found_.value());
+
+  Envoy::ProtobufWkt::Struct peer_metadata;
+  ASSERT_TRUE(peer_metadata.ParseFromString(
+      filterState("envoy.wasm.metadata_exchange.downstream")));
+  EXPECT_THAT(peer_metadata, MapEq(productpage_value_));
+  EXPECT_EQ("productpage-id",
+            filterState("envoy.wasm.metadata_exchange.downstream_id"));
+}
+
+TEST_F(MetadataExchangeFilterTest, ProxyDataInSeveralReads) {
+  initialize();
+  initializeStructValues();
+
+  EXPECT_CALL(read_filter_callbacks_.connection_, nextProtocol())
+      .WillRepeatedly(Return("istio2"));
+
+  const std::string preamble = productpagePreamble("");
+  const size_t half = preamble.size() / 2;
+  ::Envoy::Buffer::OwnedImpl data;
+  addFragmented(data, absl::string_view(preamble).substr(0, half), 7);
+  EXPECT_EQ(Envoy::Network::FilterStatus::StopIteration,
+            filter_->onData(data, false));
+
+  addFragmented(data, absl::string_view(preamble).substr(half), 7);
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue,
+            filter_->onData(data, false));
+  EXPECT_EQ(0UL, data.length());
+
+  Envoy::ProtobufWkt::Struct peer_metadata;
+  ASSERT_TRUE(peer_metadata.ParseFromString(
+      filterState("envoy.wasm.metadata_exchange.downstream")));
+  EXPECT_THAT(peer_metadata, MapEq(productpage_value_));
+  EXPECT_FALSE(stream_info_.filterState().hasDataWithName(
+      "envoy.wasm.metadata_exchange.downstream_id"));
+}
+
+TEST_F(MetadataExchangeFilterTest, ProxyDataNotStruct) {
+  initialize();
+
+  EXPECT_CALL(read_filter_callbacks_.connection_, nextProtocol())
+      .WillRepeatedly(Return("istio2"));
+
+  ::Envoy::Buffer::OwnedImpl data;
+  MetadataExchangeInitialHeader initial_header;
+  Envoy::ProtobufWkt::Any any_value;
+  any_value.PackFrom(Envoy::ProtobufWkt::Value());
+  ConstructProxyHeaderData(data, any_value, &initial_header);
+
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue,
+            filter_->onData(data, false));
+  EXPECT_EQ(1UL, config_->stats().header_not_found_.value());
+}
+
+TEST_F(MetadataExchangeFilterTest, PeerMetadataCache) {
+  initialize();
+  initializeStructValues();
+
+  EXPECT_CALL(read_filter_callbacks_.connection_, nextProtocol())
+      .WillRepeatedly(Return("istio2"));
+
+  // Many connections from the same peer, each read in different slices.
+  const std::string preamble = productpagePreamble("productpage-id");
+  for (size_t i = 0; i < 10; i++) {
+    MetadataExchangeFilter filter(config_);
+    filter.initializeReadFilterCallbacks(read_filter_callbacks_);
+    filter.initializeWriteFilterCallbacks(write_filter_callbacks_);
+    ::Envoy::Buffer::OwnedImpl data;
+    addFragmented(data, preamble, i + 1);
+    EXPECT_EQ(Envoy::Network::FilterStatus::Continue,
+              filter.onData(data, false));
+
+    Envoy::ProtobufWkt::Struct peer_metadata;
+    ASSERT_TRUE(peer_metadata.ParseFromString(
+        filterState("envoy.wasm.metadata_exchange.downstream")));
+    EXPECT_THAT(peer_metadata, MapEq(productpage_value_));
+    EXPECT_EQ("productpage-id",
+              filterState("envoy.wasm.metadata_exchange.downstream_id"));
+  }
+  EXPECT_EQ(1UL, config_->stats().metadata_cache_miss_.value());
+  EXPECT_EQ(9UL, config_->stats().metadata_cache_hit_.value());
+  EXPECT_EQ(1UL, config_->peerMetadataCache().size());
+
+  // Another workload of the same peer sends different bytes.
+  const std::string other_preamble = productpagePreamble("productpage-id-2");
+  MetadataExchangeFilter filter(config_);
+  filter.initializeReadFilterCallbacks(read_filter_callbacks_);
+  filter.initializeWriteFilterCallbacks(write_filter_callbacks_);
+  ::Envoy::Buffer::OwnedImpl data(other_preamble);
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter.onData(data, false));
+  EXPECT_EQ("productpage-id-2",
+            filterState("envoy.wasm.metadata_exchange.downstream_id"));
+  EXPECT_EQ(2UL, config_->stats().metadata_cache_miss_.value());
+  EXPECT_EQ(2UL, config_->peerMetadataCache().size());
+}
+
+namespace {
+
+// Serialized proxy data of a peer with the given id.
+std::string proxyData(const std::string& id) {
+  Envoy::ProtobufWkt::Struct data;
+  (*data.mutable_fields())["x-envoy-peer-metadata-id"].set_string_value(id);
+  Envoy::ProtobufWkt::Any any_value;
+  any_value.PackFrom(data);
+  return any_value.SerializeAsString();
+}
+
+// Looks up the proxy data of a peer and returns whether it was cached.
+bool cacheHit(PeerMetadataCache& cache, const std::string& id) {
+  const std::string bytes = proxyData(id);
+  ::Envoy::Buffer::OwnedImpl buffer(bytes);
+  bool hit;
+  auto peer = cache.get(buffer, bytes.size(), &hit);
+  EXPECT_NE(nullptr, peer);
+  if (peer) {
+    EXPECT_EQ(id, peer->id);
+  }
+  return hit;
+}
+
+}  // namespace
+
+TEST(ProxyDataTest, PeerMetadataCacheEvictsLeastRecentlyUsed) {
+  PeerMetadataCache cache(3);
+  EXPECT_FALSE(cacheHit(cache, "a"));
+  EXPECT_FALSE(cacheHit(cache, "b"));
+  EXPECT_FALSE(cacheHit(cache, "c"));
+  // Using a makes b the least recently used entry.
+  EXPECT_TRUE(cacheHit(cache, "a"));
+  EXPECT_FALSE(cacheHit(cache, "d"));
+  EXPECT_EQ(3UL, cache.size());
+  EXPECT_TRUE(cacheHit(cache, "a"));
+  EXPECT_TRUE(cacheHit(cache, "c"));
+  EXPECT_TRUE(cacheHit(cache, "d"));
+  EXPECT_FALSE(cacheHit(cache, "b"));
+}
+
+TEST(ProxyDataTest, PeerMetadataCacheIsBounded) {
+  PeerMetadataCache cache(4);
+  for (int i = 0; i < 10; i++) {
+    Envoy::ProtobufWkt::Struct data;
+    (*data.mutable_fields())["x-envoy-peer-metadata-id"].set_string_value(
+        std::to_string(i));
+    Envoy::ProtobufWkt::Any any_value;
+    any_value.PackFrom(data);
+    const std::string bytes = any_value.SerializeAsString();
+    ::Envoy::Buffer::OwnedImpl buffer(bytes);
+
+    bool hit;
+    auto peer = cache.get(buffer, bytes.size(), &hit);
+    ASSERT_NE(nullptr, peer);
+    EXPECT_FALSE(hit);
+    EXPECT_EQ(std::to_string(i), peer->id);
+    EXPECT_LE(cache.size(), 4UL);
+
+    cache.get(buffer, bytes.size(), &hit);
+    EXPECT_TRUE(hit);
+  }
+}
+
+TEST(ProxyDataTest, UnusualEncoding) {
+  // A map entry with the value before the key is valid, and is handled by
+  // the protobuf library.
+  Envoy::ProtobufWkt::Value id;
+  id.set_string_value("productpage-id");
+  const std::string key = "x-envoy-peer-metadata-id";
+  std::string entry;
+  entry.push_back(0x12);
+  entry.push_back(static_cast<char>(id.ByteSizeLong()));
+  entry.append(id.SerializeAsString());
+  entry.push_back(0x0a);
+  entry.push_back(static_cast<char>(key.size()));
+  entry.append(key);
+  std::string fields;
+  fields.push_back(0x0a);
+  fields.push_back(static_cast<char>(entry.size()));
+  fields.append(entry);
+
+  Envoy::ProtobufWkt::Any any_value;
+  any_value.set_type_url("type.googleapis.com/google.protobuf.Struct");
+  any_value.set_value(fields);
+  const std::string bytes = any_value.SerializeAsString();
+  ::Envoy::Buffer::OwnedImpl data;
+  addFragmented(data, bytes, 3);
+
+  PeerMetadata peer;
+  ASSERT_TRUE(parseProxyData(data, bytes.size(), &peer));
+  EXPECT_FALSE(peer.has_metadata);
+  EXPECT_TRUE(peer.has_id);
+  EXPECT_EQ("productpage-id", peer.id);
+}
+
 TEST_F(MetadataExchangeFilterTest, MetadataExchangeNotFound) {
   initialize();
 
@@ -72,6 +72,11 @@ class Config {
     return report_interval_ms_;
   }
 
+  // Whether filter metadata is needed, it is only sent in reports.
+  bool report_filter_metadata() const {
+    return !config_pb_.disable_report_calls();
+  }
+
  private:
   // The Tcp client config.
   ::istio::mixer::v1::config::client::TcpClientConfig config_pb_;
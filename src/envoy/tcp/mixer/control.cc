@@ -25,6 +25,13 @@ using ::istio::utils::LocalNode;
 namespace Envoy {
 namespace Tcp {
 namespace Mixer {
+namespace {
+
+// Periodical reports of connections due within a tenth of the report
+// interval of each other are sent together.
+constexpr int kReportCoalescingDivisor = 10;
+
+}  // namespace
 
 Control::Control(ControlDataSharedPtr control_data,
                  Upstream::ClusterManager& cm, Event::Dispatcher& dispatcher,
@@ -32,6 +39,11 @@ Control::Control(ControlDataSharedPtr control_data,
                  const LocalInfo::LocalInfo& local_info)
     : control_data_(control_data),
       dispatcher_(dispatcher),
+      report_scheduler_(
+          dispatcher, dispatcher.timeSource(),
+          control_data_->config().report_interval_ms(),
+          control_data_->config().report_interval_ms() /
+              kReportCoalescingDivisor),
       check_client_factory_(Utils::GrpcClientFactoryForCluster(
           control_data_->config().check_cluster(), cm, scope,
           dispatcher.timeSource())),
@@ -56,6 +68,9 @@ Control::Control(ControlDataSharedPtr control_data,
 
   ::istio::control::tcp::Controller::Options options(
       control_data_->config().config_pb(), local_node);
+  Utils::ExtractCheckCacheRefresh(local_info.node(),
+                                  &options.check_cache_refresh_ahead_ms,
+                                  &options.check_cache_max_stale_ms);
 
   Utils::CreateEnvironment(dispatcher, random, *check_client_factory_,
                            *report_client_factory_,
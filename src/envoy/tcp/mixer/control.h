@@ -24,6 +24,7 @@
 #include "include/istio/control/tcp/controller.h"
 #include "include/istio/utils/local_attributes.h"
 #include "src/envoy/tcp/mixer/config.h"
+#include "src/envoy/tcp/mixer/report_scheduler.h"
 #include "src/envoy/utils/stats.h"
 
 namespace Envoy {
@@ -64,6 +65,8 @@ class Control final : public ThreadLocal::ThreadLocalObject {
 
   const Config& config() const { return control_data_->config(); }
 
+  ReportScheduler& reportScheduler() { return report_scheduler_; }
+
  private:
   // Call controller to get statistics.
   bool GetStats(::istio::mixerclient::Statistics* stat);
@@ -74,6 +77,9 @@ class Control final : public ThreadLocal::ThreadLocalObject {
   // dispatcher.
   Event::Dispatcher& dispatcher_;
 
+  // Schedules the periodical reports of all connections of this worker.
+  ReportScheduler report_scheduler_;
+
   // Pre-serialized attributes_for_mixer_proxy.
   std::string serialized_forward_attributes_;
 
@@ -16,7 +16,6 @@
 #include "src/envoy/tcp/mixer/filter.h"
 
 #include "common/common/enum_to_int.h"
-#include "extensions/filters/network/well_known_names.h"
 #include "src/envoy/utils/utils.h"
 
 using ::google::protobuf::util::Status;
@@ -26,7 +25,9 @@ namespace Envoy {
 namespace Tcp {
 namespace Mixer {
 
-Filter::Filter(Control &control) : control_(control) {
+Filter::Filter(Control &control)
+    : control_(control),
+      filter_metadata_cache_(control.config().report_filter_metadata()) {
   ENVOY_LOG(debug, "Called tcp filter: {}", __func__);
 }
 
@@ -63,31 +64,6 @@ void Filter::callCheck() {
   calling_check_ = false;
 }
 
-// TODO(venilnoronha): rewrite this to deep-clone dynamic metadata for all
-// filters.
-void Filter::cacheFilterMetadata(
-    const ::google::protobuf::Map<std::string, ::google::protobuf::Struct>
-        &filter_metadata) {
-  for (auto &filter_pair : filter_metadata) {
-    if (filter_pair.first ==
-        Extensions::NetworkFilters::NetworkFilterNames::get().MongoProxy) {
-      if (cached_filter_metadata_.count(filter_pair.first) == 0) {
-        ProtobufWkt::Struct dynamic_metadata;
-        cached_filter_metadata_[filter_pair.first] = dynamic_metadata;
-      }
-
-      auto &cached_fields =
-          *cached_filter_metadata_[filter_pair.first].mutable_fields();
-      for (const auto &message_pair : filter_pair.second.fields()) {
-        cached_fields[message_pair.first].mutable_list_value()->CopyFrom(
-            message_pair.second.list_value());
-      }
-    }
-  }
-}
-
-void Filter::clearCachedFilterMetadata() { cached_filter_metadata_.clear(); }
-
 // Network::ReadFilter
 Network::FilterStatus Filter::onData(Buffer::Instance &data, bool) {
   if (state_ == State::NotStarted) {
@@ -106,10 +82,10 @@ Network::FilterStatus Filter::onData(Buffer::Instance &data, bool) {
   // off by the time the event is fired. Therefore, we append metadata from each
   // onData call to a local cache and send it all at once when the timer event
   // occurs. The local cache is cleared after reporting it on the timer event.
-  cacheFilterMetadata(filter_callbacks_->connection()
-                          .streamInfo()
-                          .dynamicMetadata()
-                          .filter_metadata());
+  filter_metadata_cache_.merge(filter_callbacks_->connection()
+                                   .streamInfo()
+                                   .dynamicMetadata()
+                                   .filter_metadata());
 
   return (state_ == State::Calling || filter_callbacks_->connection().state() !=
                                           Network::Connection::State::Open)
@@ -160,9 +136,8 @@ void Filter::completeCheck(const CheckResponseInfo &info) {
       filter_callbacks_->continueReading();
     }
     handler_->Report(this, ConnectionEvent::OPEN);
-    report_timer_ =
-        control_.dispatcher().createTimer([this]() { OnReportTimer(); });
-    report_timer_->enableTimer(control_.config().report_interval_ms());
+    scheduled_report_ =
+        control_.reportScheduler().schedule([this]() { OnReportTimer(); });
   }
 }
 
@@ -180,9 +155,7 @@ void Filter::onEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
     if (state_ != State::Closed && handler_) {
-      if (report_timer_) {
-        report_timer_->disableTimer();
-      }
+      scheduled_report_.reset();
       handler_->Report(this, ConnectionEvent::CLOSE);
     }
     cancelCheck();
@@ -228,7 +201,7 @@ bool Filter::GetDestinationUID(std::string *uid) const {
 
 const ::google::protobuf::Map<std::string, ::google::protobuf::Struct>
     &Filter::GetDynamicFilterState() const {
-  return cached_filter_metadata_;
+  return filter_metadata_cache_.get();
 }
 
 void Filter::GetReportInfo(
@@ -249,8 +222,7 @@ std::string Filter::GetConnectionId() const {
 
 void Filter::OnReportTimer() {
   handler_->Report(this, ConnectionEvent::CONTINUE);
-  clearCachedFilterMetadata();
-  report_timer_->enableTimer(control_.config().report_interval_ms());
+  filter_metadata_cache_.clear();
 }
 
 }  // namespace Mixer
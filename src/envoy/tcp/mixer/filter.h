@@ -21,6 +21,7 @@
 #include "google/protobuf/struct.pb.h"
 #include "include/istio/mixerclient/check_response.h"
 #include "src/envoy/tcp/mixer/control.h"
+#include "src/envoy/tcp/mixer/filter_metadata_cache.h"
 
 namespace Envoy {
 namespace Tcp {
@@ -66,14 +67,9 @@ class Filter : public Network::Filter,
       ::istio::control::tcp::ReportData::ReportInfo *data) const override;
   std::string GetConnectionId() const override;
 
-  void cacheFilterMetadata(
-      const ::google::protobuf::Map<std::string, ::google::protobuf::Struct>
-          &filter_metadata);
-  void clearCachedFilterMetadata();
-
  private:
   enum class State { NotStarted, Calling, Completed, Closed };
-  // This function is invoked when timer event fires.
+  // This function is invoked by the report scheduler.
   // It sends periodical delta reports.
   void OnReportTimer();
 
@@ -101,11 +97,10 @@ class Filter : public Network::Filter,
   // send bytes
   uint64_t send_bytes_{};
   // cached filter metadata
-  ::google::protobuf::Map<std::string, ::google::protobuf::Struct>
-      cached_filter_metadata_{};
+  FilterMetadataCache filter_metadata_cache_;
 
-  // Timer that periodically sends reports.
-  Event::TimerPtr report_timer_;
+  // Periodical reports, scheduled once the connection is allowed.
+  ReportScheduler::HandlePtr scheduled_report_;
   // start_time
   std::chrono::time_point<std::chrono::system_clock> start_time_;
 };
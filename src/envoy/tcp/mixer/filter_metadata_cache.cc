@@ -0,0 +1,72 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/mixer/filter_metadata_cache.h"
+
+#include "extensions/filters/network/well_known_names.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+// Whether two lists of strings, which is what the mongo_proxy filter sets,
+// are equal. Lists with other values are never considered equal.
+bool equalStringLists(const ::google::protobuf::ListValue& a,
+                      const ::google::protobuf::ListValue& b) {
+  if (a.values_size() != b.values_size()) {
+    return false;
+  }
+  for (int i = 0; i < a.values_size(); i++) {
+    const auto& x = a.values(i);
+    const auto& y = b.values(i);
+    if (x.kind_case() != ::google::protobuf::Value::kStringValue ||
+        y.kind_case() != ::google::protobuf::Value::kStringValue ||
+        x.string_value() != y.string_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// TODO(venilnoronha): rewrite this to deep-clone dynamic metadata for all
+// filters.
+void FilterMetadataCache::merge(const FilterMetadata& filter_metadata) {
+  if (!enabled_ || filter_metadata.empty()) {
+    return;
+  }
+  const std::string& name =
+      Extensions::NetworkFilters::NetworkFilterNames::get().MongoProxy;
+  const auto it = filter_metadata.find(name);
+  if (it == filter_metadata.end() || it->second.fields().empty()) {
+    return;
+  }
+
+  // Only the list values are reported. A connection mostly repeats the same
+  // operations, whose lists are already cached.
+  auto& cached_fields = *cached_[name].mutable_fields();
+  for (const auto& message_pair : it->second.fields()) {
+    auto* cached_list = cached_fields[message_pair.first].mutable_list_value();
+    if (!equalStringLists(*cached_list, message_pair.second.list_value())) {
+      cached_list->CopyFrom(message_pair.second.list_value());
+    }
+  }
+}
+
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
@@ -0,0 +1,60 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "google/protobuf/map.h"
+#include "google/protobuf/struct.pb.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+
+/**
+ * Accumulates the dynamic metadata of the filters whose metadata is sent as
+ * report attributes, currently only the mongo_proxy filter. Such filters
+ * clear their metadata on every read, so it is merged here on every read and
+ * reported when the periodical report is sent.
+ *
+ * Nothing is copied when the config does not send reports, and filters whose
+ * metadata is not reported are skipped without being looked at.
+ */
+class FilterMetadataCache {
+ public:
+  using FilterMetadata =
+      ::google::protobuf::Map<std::string, ::google::protobuf::Struct>;
+
+  FilterMetadataCache(bool enabled) : enabled_(enabled) {}
+
+  bool enabled() const { return enabled_; }
+
+  // Merges the reported filters' metadata, the latest value of a field wins.
+  void merge(const FilterMetadata& filter_metadata);
+
+  // The merged metadata, in the form of report attributes.
+  const FilterMetadata& get() const { return cached_; }
+
+  void clear() { cached_.clear(); }
+
+ private:
+  const bool enabled_;
+  FilterMetadata cached_;
+};
+
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
@@ -0,0 +1,89 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "extensions/filters/network/well_known_names.h"
+#include "src/envoy/tcp/mixer/filter_metadata_cache.h"
+#include "src/istio/utils/allocation_counter.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+// Dynamic metadata of a connection: the mongo_proxy filter metadata with
+// the given number of resources, next to the metadata of another filter.
+FilterMetadataCache::FilterMetadata connectionMetadata(int resources) {
+  FilterMetadataCache::FilterMetadata filter_metadata;
+  auto& mongo =
+      *filter_metadata[Extensions::NetworkFilters::NetworkFilterNames::get()
+                           .MongoProxy]
+           .mutable_fields();
+  for (int i = 0; i < resources; i++) {
+    const std::string resource = "db.collection" + std::to_string(i);
+    auto* list = mongo[resource].mutable_list_value();
+    list->add_values()->set_string_value("query");
+    list->add_values()->set_string_value("insert");
+  }
+  (*filter_metadata["envoy.other"].mutable_fields())["key"].set_string_value(
+      "value");
+  return filter_metadata;
+}
+
+// Ten reads between two reports.
+void mergeAndReport(benchmark::State& state, bool enabled) {
+  const auto filter_metadata = connectionMetadata(state.range(0));
+  FilterMetadataCache cache(enabled);
+  const uint64_t start = ::istio::utils::AllocationCount();
+  for (auto _ : state) {
+    for (int i = 0; i < 10; i++) {
+      cache.merge(filter_metadata);
+    }
+    benchmark::DoNotOptimize(cache.get());
+    cache.clear();
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(::istio::utils::AllocationCount() - start,
+                         benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace
+
+static void BM_MergeReported(benchmark::State& state) {
+  mergeAndReport(state, true);
+}
+BENCHMARK(BM_MergeReported)->Arg(1)->Arg(10);
+
+static void BM_MergeWithoutReports(benchmark::State& state) {
+  mergeAndReport(state, false);
+}
+BENCHMARK(BM_MergeWithoutReports)->Arg(1)->Arg(10);
+
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
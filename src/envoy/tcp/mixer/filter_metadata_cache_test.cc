@@ -0,0 +1,106 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/mixer/filter_metadata_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "extensions/filters/network/well_known_names.h"
+#include "gtest/gtest.h"
+
+using ::google::protobuf::Struct;
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+const std::string& mongoProxy() {
+  return Extensions::NetworkFilters::NetworkFilterNames::get().MongoProxy;
+}
+
+// Metadata as the mongo_proxy filter sets it: operations per resource.
+Struct mongoMetadata(const std::string& resource,
+                     const std::vector<std::string>& operations) {
+  Struct metadata;
+  auto* list = (*metadata.mutable_fields())[resource].mutable_list_value();
+  for (const auto& operation : operations) {
+    list->add_values()->set_string_value(operation);
+  }
+  return metadata;
+}
+
+std::vector<std::string> operations(const FilterMetadataCache& cache,
+                                    const std::string& resource) {
+  std::vector<std::string> out;
+  const auto& fields = cache.get().at(mongoProxy()).fields();
+  for (const auto& value : fields.at(resource).list_value().values()) {
+    out.push_back(value.string_value());
+  }
+  return out;
+}
+
+TEST(FilterMetadataCacheTest, ReportedMetadataIsCached) {
+  FilterMetadataCache cache(true);
+  FilterMetadataCache::FilterMetadata filter_metadata;
+  filter_metadata[mongoProxy()] = mongoMetadata("db.users", {"query"});
+  (*filter_metadata["envoy.other"].mutable_fields())["key"].set_string_value(
+      "value");
+  cache.merge(filter_metadata);
+
+  EXPECT_EQ(cache.get().size(), 1U);
+  EXPECT_EQ(operations(cache, "db.users"), std::vector<std::string>{"query"});
+
+  // The mongo_proxy filter clears its metadata on every read; later reads
+  // add resources and replace the operations of known ones.
+  filter_metadata.clear();
+  filter_metadata[mongoProxy()] = mongoMetadata("db.users", {"insert"});
+  (*filter_metadata[mongoProxy()].mutable_fields())["db.orders"] =
+      mongoMetadata("db.orders", {"query", "delete"}).fields().at("db.orders");
+  cache.merge(filter_metadata);
+  EXPECT_EQ(operations(cache, "db.users"), std::vector<std::string>{"insert"});
+  EXPECT_EQ(operations(cache, "db.orders"),
+            std::vector<std::string>({"query", "delete"}));
+
+  // Reads without metadata keep what was merged until the report.
+  cache.merge(FilterMetadataCache::FilterMetadata());
+  EXPECT_EQ(cache.get().at(mongoProxy()).fields().size(), 2U);
+
+  cache.clear();
+  EXPECT_TRUE(cache.get().empty());
+}
+
+TEST(FilterMetadataCacheTest, OtherFiltersAreNotCached) {
+  FilterMetadataCache cache(true);
+  FilterMetadataCache::FilterMetadata filter_metadata;
+  (*filter_metadata["envoy.other"].mutable_fields())["key"].set_string_value(
+      "value");
+  cache.merge(filter_metadata);
+  EXPECT_TRUE(cache.get().empty());
+}
+
+TEST(FilterMetadataCacheTest, NothingIsCachedWithoutReports) {
+  FilterMetadataCache cache(false);
+  FilterMetadataCache::FilterMetadata filter_metadata;
+  filter_metadata[mongoProxy()] = mongoMetadata("db.users", {"query"});
+  cache.merge(filter_metadata);
+  EXPECT_TRUE(cache.get().empty());
+}
+
+}  // namespace
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
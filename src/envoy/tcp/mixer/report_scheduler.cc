@@ -0,0 +1,91 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/mixer/report_scheduler.h"
+
+#include <algorithm>
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+// Rounds up so that the timer never fires before the first entry is due.
+std::chrono::milliseconds timeUntil(MonotonicTime due, MonotonicTime now) {
+  if (due <= now) {
+    return std::chrono::milliseconds(0);
+  }
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(due - now);
+  if (now + ms < due) {
+    ms += std::chrono::milliseconds(1);
+  }
+  return ms;
+}
+
+}  // namespace
+
+ReportScheduler::ReportScheduler(Event::Dispatcher& dispatcher,
+                                 TimeSource& time_source,
+                                 std::chrono::milliseconds report_interval,
+                                 std::chrono::milliseconds coalescing_window)
+    : dispatcher_(dispatcher),
+      time_source_(time_source),
+      report_interval_(report_interval),
+      // A window as long as the interval would report a connection again in
+      // the pass that rescheduled it.
+      coalescing_window_(std::min(coalescing_window, report_interval / 2)) {}
+
+ReportScheduler::HandlePtr ReportScheduler::schedule(ReportFunc report) {
+  const bool was_empty = entries_.empty();
+  auto entry = entries_.insert(
+      entries_.end(), Entry{time_source_.monotonicTime() + report_interval_,
+                            std::move(report)});
+  if (was_empty) {
+    if (!timer_) {
+      timer_ = dispatcher_.createTimer([this]() { onTimer(); });
+    }
+    timer_->enableTimer(report_interval_);
+  }
+  return std::make_unique<HandleImpl>(*this, entry);
+}
+
+void ReportScheduler::remove(EntryList::iterator entry) {
+  entries_.erase(entry);
+  // The timer stays armed for a removed first entry; it will find nothing or
+  // little due and rearm itself.
+  if (entries_.empty()) {
+    timer_->disableTimer();
+  }
+}
+
+void ReportScheduler::onTimer() {
+  const MonotonicTime now = time_source_.monotonicTime();
+  const MonotonicTime deadline = now + coalescing_window_;
+  // Rescheduled entries move to the back with a due time past the deadline,
+  // which ends the pass.
+  while (!entries_.empty() && entries_.front().due <= deadline) {
+    auto entry = entries_.begin();
+    entry->due = now + report_interval_;
+    entries_.splice(entries_.end(), entries_, entry);
+    entry->report();
+  }
+  if (!entries_.empty()) {
+    timer_->enableTimer(timeUntil(entries_.front().due, now));
+  }
+}
+
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
@@ -0,0 +1,97 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+
+/**
+ * Schedules the periodical delta reports of all connections of a worker with
+ * a single timer. The report interval is the same for every connection, so
+ * connections are kept in the order they are due and the timer is armed for
+ * the first one. When it fires, every connection due within the coalescing
+ * window is reported in the same pass, which lets their reports share a
+ * ReportBatch flush instead of waking the worker once per connection.
+ */
+class ReportScheduler {
+ public:
+  using ReportFunc = std::function<void()>;
+
+  /**
+   * A scheduled connection. Destroying the handle stops its reports.
+   */
+  class Handle {
+   public:
+    virtual ~Handle() {}
+  };
+  using HandlePtr = std::unique_ptr<Handle>;
+
+  ReportScheduler(Event::Dispatcher& dispatcher, TimeSource& time_source,
+                  std::chrono::milliseconds report_interval,
+                  std::chrono::milliseconds coalescing_window);
+
+  /**
+   * Calls report every report interval until the returned handle is
+   * destroyed. report must not destroy its own handle.
+   */
+  HandlePtr schedule(ReportFunc report);
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    MonotonicTime due;
+    ReportFunc report;
+  };
+  using EntryList = std::list<Entry>;
+
+  class HandleImpl : public Handle {
+   public:
+    HandleImpl(ReportScheduler& scheduler, EntryList::iterator entry)
+        : scheduler_(scheduler), entry_(entry) {}
+    ~HandleImpl() { scheduler_.remove(entry_); }
+
+   private:
+    ReportScheduler& scheduler_;
+    EntryList::iterator entry_;
+  };
+
+  void onTimer();
+  void remove(EntryList::iterator entry);
+
+  Event::Dispatcher& dispatcher_;
+  TimeSource& time_source_;
+  const std::chrono::milliseconds report_interval_;
+  const std::chrono::milliseconds coalescing_window_;
+  // Created with the first scheduled connection.
+  Event::TimerPtr timer_;
+  // Scheduled connections in the order they are due.
+  EntryList entries_;
+};
+
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
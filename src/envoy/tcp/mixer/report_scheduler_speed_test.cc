@@ -0,0 +1,152 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/envoy/tcp/mixer/report_scheduler.h"
+#include "test/mocks/event/mocks.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+constexpr std::chrono::milliseconds kReportInterval(10000);
+constexpr int kIntervals = 5;
+
+class FakeTimeSource : public TimeSource {
+ public:
+  SystemTime systemTime() override {
+    return SystemTime(now_.time_since_epoch());
+  }
+  MonotonicTime monotonicTime() override { return now_; }
+
+  void advanceTo(MonotonicTime time) { now_ = time; }
+
+ private:
+  MonotonicTime now_{std::chrono::seconds(1)};
+};
+
+// Drives a scheduler with a fake timer and fake time.
+class SchedulerHarness {
+ public:
+  explicit SchedulerHarness(std::chrono::milliseconds coalescing_window)
+      : timer_(new NiceMock<Event::MockTimer>()),
+        scheduler_(dispatcher_, time_source_, kReportInterval,
+                   coalescing_window) {
+    ON_CALL(dispatcher_, createTimer_(_))
+        .WillByDefault(DoAll(SaveArg<0>(&timer_cb_), Return(timer_)));
+    ON_CALL(*timer_, enableTimer(_, _))
+        .WillByDefault(Invoke(
+            [this](const std::chrono::milliseconds& duration,
+                   const ScopeTrackedObject*) {
+              armed_ = true;
+              deadline_ = time_source_.monotonicTime() + duration;
+            }));
+    ON_CALL(*timer_, disableTimer()).WillByDefault(Invoke([this]() {
+      armed_ = false;
+    }));
+  }
+
+  // Advances the time by duration, firing the timer whenever it is due.
+  void advance(std::chrono::milliseconds duration) {
+    const MonotonicTime end = time_source_.monotonicTime() + duration;
+    while (armed_ && deadline_ <= end) {
+      time_source_.advanceTo(deadline_);
+      armed_ = false;
+      timer_events_++;
+      timer_cb_();
+    }
+    time_source_.advanceTo(end);
+  }
+
+  ReportScheduler& scheduler() { return scheduler_; }
+  uint64_t timerEvents() const { return timer_events_; }
+
+ private:
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  // Owned by the scheduler once created.
+  Event::MockTimer* timer_;
+  FakeTimeSource time_source_;
+  ReportScheduler scheduler_;
+
+  Event::TimerCb timer_cb_;
+  bool armed_{false};
+  MonotonicTime deadline_;
+  uint64_t timer_events_{0};
+};
+
+// Opens the given number of connections evenly over one report interval and
+// keeps them open for several intervals.
+void reportConnections(benchmark::State& state,
+                       std::chrono::milliseconds coalescing_window) {
+  const int connections = state.range(0);
+  const auto spacing = std::max(kReportInterval / connections,
+                                std::chrono::milliseconds(1));
+  SchedulerHarness harness(coalescing_window);
+  uint64_t reports = 0;
+  std::vector<ReportScheduler::HandlePtr> handles;
+  handles.reserve(connections);
+  for (auto _ : state) {
+    for (int i = 0; i < connections; i++) {
+      handles.push_back(
+          harness.scheduler().schedule([&reports]() { reports++; }));
+      harness.advance(spacing);
+    }
+    harness.advance(kReportInterval * (kIntervals - 1));
+    handles.clear();
+  }
+  state.counters["timer_events"] = benchmark::Counter(
+      harness.timerEvents(), benchmark::Counter::kAvgIterations);
+  state.counters["reports"] =
+      benchmark::Counter(reports, benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace
+
+// Every connection is reported by its own timer event.
+static void BM_ReportUncoalesced(benchmark::State& state) {
+  reportConnections(state, std::chrono::milliseconds(0));
+}
+BENCHMARK(BM_ReportUncoalesced)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_ReportCoalesced(benchmark::State& state) {
+  reportConnections(state, std::chrono::milliseconds(1000));
+}
+BENCHMARK(BM_ReportCoalesced)->Arg(100)->Arg(1000)->Arg(10000);
+
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,174 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/mixer/report_scheduler.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "test/mocks/event/mocks.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Tcp {
+namespace Mixer {
+namespace {
+
+constexpr std::chrono::milliseconds kReportInterval(10000);
+constexpr std::chrono::milliseconds kCoalescingWindow(1000);
+
+class FakeTimeSource : public TimeSource {
+ public:
+  SystemTime systemTime() override {
+    return SystemTime(now_.time_since_epoch());
+  }
+  MonotonicTime monotonicTime() override { return now_; }
+
+  void advance(std::chrono::milliseconds duration) { now_ += duration; }
+
+ private:
+  MonotonicTime now_{std::chrono::seconds(1)};
+};
+
+class ReportSchedulerTest : public testing::Test {
+ public:
+  ReportSchedulerTest()
+      : timer_(new NiceMock<Event::MockTimer>()),
+        scheduler_(dispatcher_, time_source_, kReportInterval,
+                   kCoalescingWindow) {
+    EXPECT_CALL(dispatcher_, createTimer_(_))
+        .WillOnce(DoAll(SaveArg<0>(&timer_cb_), Return(timer_)));
+    ON_CALL(*timer_, enableTimer(_, _))
+        .WillByDefault(Invoke(
+            [this](const std::chrono::milliseconds& duration,
+                   const ScopeTrackedObject*) {
+              armed_ = true;
+              deadline_ = time_source_.monotonicTime() + duration;
+            }));
+    ON_CALL(*timer_, disableTimer()).WillByDefault(Invoke([this]() {
+      armed_ = false;
+    }));
+  }
+
+  // Advances the time by duration, firing the timer whenever it is due.
+  void advance(std::chrono::milliseconds duration) {
+    const MonotonicTime end = time_source_.monotonicTime() + duration;
+    while (armed_ && deadline_ <= end) {
+      advanceTo(deadline_);
+      armed_ = false;
+      timer_fired_++;
+      timer_cb_();
+    }
+    advanceTo(end);
+  }
+
+  void advanceTo(MonotonicTime time) {
+    time_source_.advance(std::chrono::duration_cast<std::chrono::milliseconds>(
+        time - time_source_.monotonicTime()));
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  // Owned by the scheduler once created.
+  Event::MockTimer* timer_;
+  FakeTimeSource time_source_;
+  ReportScheduler scheduler_;
+
+  Event::TimerCb timer_cb_;
+  bool armed_{false};
+  MonotonicTime deadline_;
+  int timer_fired_{0};
+};
+
+TEST_F(ReportSchedulerTest, ReportsEveryInterval) {
+  int reports = 0;
+  auto handle = scheduler_.schedule([&reports]() { reports++; });
+
+  advance(kReportInterval - std::chrono::milliseconds(1));
+  EXPECT_EQ(reports, 0);
+  advance(std::chrono::milliseconds(1));
+  EXPECT_EQ(reports, 1);
+  advance(kReportInterval * 2);
+  EXPECT_EQ(reports, 3);
+
+  // Destroying the handle stops the reports and the timer.
+  handle.reset();
+  EXPECT_FALSE(armed_);
+  advance(kReportInterval * 2);
+  EXPECT_EQ(reports, 3);
+  EXPECT_EQ(scheduler_.size(), 0U);
+}
+
+TEST_F(ReportSchedulerTest, CoalescesDueConnections) {
+  std::vector<int> reports(3);
+  auto first = scheduler_.schedule([&reports]() { reports[0]++; });
+  advance(std::chrono::milliseconds(500));
+  auto second = scheduler_.schedule([&reports]() { reports[1]++; });
+  advance(std::chrono::milliseconds(2000));
+  auto third = scheduler_.schedule([&reports]() { reports[2]++; });
+
+  // The first two connections are due within the coalescing window and are
+  // reported by the same timer event.
+  advance(kReportInterval - std::chrono::milliseconds(2500));
+  EXPECT_EQ(timer_fired_, 1);
+  EXPECT_EQ(reports, std::vector<int>({1, 1, 0}));
+
+  advance(std::chrono::milliseconds(2500));
+  EXPECT_EQ(timer_fired_, 2);
+  EXPECT_EQ(reports, std::vector<int>({1, 1, 1}));
+
+  // A removed connection is no longer reported.
+  second.reset();
+  advance(kReportInterval);
+  EXPECT_EQ(reports, std::vector<int>({2, 1, 2}));
+}
+
+// Opens a connection every millisecond for one report interval and keeps
+// them open for several intervals. A timer per connection would create
+// 10000 timers and fire 10000 times per interval.
+TEST_F(ReportSchedulerTest, ManyConnections) {
+  constexpr int kConnections = 10000;
+  constexpr int kIntervals = 5;
+  int reports = 0;
+  std::vector<ReportScheduler::HandlePtr> handles;
+
+  for (int i = 0; i < kConnections; i++) {
+    handles.push_back(scheduler_.schedule([&reports]() { reports++; }));
+    advance(std::chrono::milliseconds(1));
+  }
+  advance(kReportInterval * kIntervals - kReportInterval);
+
+  // Every connection has been open for four to five intervals. Coalesced
+  // connections are reported a little early, never late.
+  EXPECT_GE(reports, kConnections * (kIntervals - 1));
+  EXPECT_LE(reports, kConnections * kIntervals);
+  // One timer for all connections, firing at most once per coalescing window.
+  EXPECT_LE(timer_fired_, kIntervals * (kReportInterval / kCoalescingWindow));
+
+  handles.clear();
+  EXPECT_EQ(scheduler_.size(), 0U);
+  EXPECT_FALSE(armed_);
+}
+
+}  // namespace
+}  // namespace Mixer
+}  // namespace Tcp
+}  // namespace Envoy
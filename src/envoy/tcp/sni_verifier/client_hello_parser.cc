@@ -0,0 +1,256 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/envoy/tcp/sni_verifier/client_hello_parser.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Envoy {
+namespace Tcp {
+namespace SniVerifier {
+namespace {
+
+constexpr uint8_t kContentTypeHandshake = 22;
+constexpr uint8_t kHandshakeTypeClientHello = 1;
+constexpr size_t kRecordHeaderSize = 5;
+constexpr size_t kHandshakeHeaderSize = 4;
+// RFC 8446 5.1: the record length must not exceed 2^14 bytes.
+constexpr size_t kMaxRecordSize = 16384;
+constexpr uint16_t kMinClientVersion = 0x0301;  // TLS 1.0
+constexpr uint16_t kExtensionServerName = 0;
+constexpr uint8_t kNameTypeHostName = 0;
+constexpr size_t kMaxHostNameSize = 255;
+
+// Reader is a bounds checked cursor over a byte range, in the spirit of
+// BoringSSL's CBS.
+class Reader {
+ public:
+  Reader() {}
+  Reader(const uint8_t* data, size_t len) : data_(data), len_(len) {}
+
+  size_t size() const { return len_; }
+  const uint8_t* data() const { return data_; }
+
+  bool readU8(uint8_t* out) {
+    if (len_ < 1) {
+      return false;
+    }
+    *out = data_[0];
+    skip(1);
+    return true;
+  }
+
+  bool readU16(uint16_t* out) {
+    if (len_ < 2) {
+      return false;
+    }
+    *out = static_cast<uint16_t>((data_[0] << 8) | data_[1]);
+    skip(2);
+    return true;
+  }
+
+  bool skipBytes(size_t n) {
+    if (len_ < n) {
+      return false;
+    }
+    skip(n);
+    return true;
+  }
+
+  bool readBytes(size_t n, Reader* out) {
+    if (len_ < n) {
+      return false;
+    }
+    *out = Reader(data_, n);
+    skip(n);
+    return true;
+  }
+
+  bool readU8Prefixed(Reader* out) {
+    uint8_t n;
+    return readU8(&n) && readBytes(n, out);
+  }
+
+  bool readU16Prefixed(Reader* out) {
+    uint16_t n;
+    return readU16(&n) && readBytes(n, out);
+  }
+
+ private:
+  void skip(size_t n) {
+    data_ += n;
+    len_ -= n;
+  }
+
+  const uint8_t* data_{nullptr};
+  size_t len_{0};
+};
+
+}  // namespace
+
+ClientHelloParser::Result ClientHelloParser::onData(const void* data,
+                                                    size_t len) {
+  len = std::min(len, max_size_ - data_.size());
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  data_.insert(data_.end(), bytes, bytes + len);
+  if (result_ == Result::NeedMoreData) {
+    result_ = parse();
+  }
+  return result_;
+}
+
+ClientHelloParser::Result ClientHelloParser::parse() {
+  while (offset_ < data_.size()) {
+    if (record_remaining_ == 0) {
+      // The first byte is enough to tell that this is not TLS at all.
+      if (records_ == 0 && data_[0] != kContentTypeHandshake) {
+        return Result::NotTls;
+      }
+      if (data_.size() - offset_ < kRecordHeaderSize) {
+        break;
+      }
+      const uint8_t* header = &data_[offset_];
+      const size_t length = (header[3] << 8) | header[4];
+      if (header[0] != kContentTypeHandshake || header[1] != 3) {
+        return records_ == 0 ? Result::NotTls : Result::Error;
+      }
+      if (length == 0 || length > kMaxRecordSize) {
+        return Result::Error;
+      }
+      offset_ += kRecordHeaderSize;
+      record_remaining_ = length;
+      records_++;
+      continue;
+    }
+
+    // Consume the part of the current record that is available.
+    const size_t available = std::min(record_remaining_, data_.size() - offset_);
+    if (!fragments_.empty() &&
+        fragments_.back().first + fragments_.back().second == offset_) {
+      fragments_.back().second += available;
+    } else {
+      fragments_.emplace_back(offset_, available);
+    }
+    offset_ += available;
+    record_remaining_ -= available;
+    handshake_size_ += available;
+
+    if (message_size_ == 0 && handshake_size_ >= kHandshakeHeaderSize) {
+      uint8_t header[kHandshakeHeaderSize];
+      copyHandshake(0, kHandshakeHeaderSize, header);
+      if (header[0] != kHandshakeTypeClientHello) {
+        return Result::Error;
+      }
+      message_size_ = kHandshakeHeaderSize +
+                      ((header[1] << 16) | (header[2] << 8) | header[3]);
+      if (message_size_ > max_size_) {
+        return Result::TooLarge;
+      }
+    }
+
+    if (message_size_ != 0 && handshake_size_ >= message_size_) {
+      const size_t body_size = message_size_ - kHandshakeHeaderSize;
+      if (fragments_.size() == 1) {
+        // Common case: the ClientHello arrived in a single record.
+        return parseClientHello(
+            &data_[fragments_[0].first + kHandshakeHeaderSize], body_size);
+      }
+      std::vector<uint8_t> body(body_size);
+      copyHandshake(kHandshakeHeaderSize, body_size, body.data());
+      return parseClientHello(body.data(), body_size);
+    }
+  }
+
+  if (data_.size() == max_size_) {
+    return Result::TooLarge;
+  }
+  return Result::NeedMoreData;
+}
+
+void ClientHelloParser::copyHandshake(size_t pos, size_t len,
+                                      uint8_t* out) const {
+  for (const auto& fragment : fragments_) {
+    if (len == 0) {
+      break;
+    }
+    if (pos >= fragment.second) {
+      pos -= fragment.second;
+      continue;
+    }
+    const size_t n = std::min(len, fragment.second - pos);
+    memcpy(out, &data_[fragment.first + pos], n);
+    out += n;
+    len -= n;
+    pos = 0;
+  }
+}
+
+ClientHelloParser::Result ClientHelloParser::parseClientHello(
+    const uint8_t* data, size_t len) {
+  Reader hello(data, len);
+  uint16_t client_version;
+  Reader session_id, cipher_suites, compression_methods;
+  if (!hello.readU16(&client_version) || client_version < kMinClientVersion ||
+      !hello.skipBytes(32 /* random */) ||
+      !hello.readU8Prefixed(&session_id) || session_id.size() > 32 ||
+      !hello.readU16Prefixed(&cipher_suites) || cipher_suites.size() < 2 ||
+      cipher_suites.size() % 2 != 0 ||
+      !hello.readU8Prefixed(&compression_methods) ||
+      compression_methods.size() < 1) {
+    return Result::Error;
+  }
+
+  // Extensions are optional.
+  if (hello.size() == 0) {
+    return Result::Done;
+  }
+  Reader extensions;
+  if (!hello.readU16Prefixed(&extensions) || hello.size() != 0) {
+    return Result::Error;
+  }
+
+  bool seen_server_name = false;
+  while (extensions.size() > 0) {
+    uint16_t type;
+    Reader extension;
+    if (!extensions.readU16(&type) || !extensions.readU16Prefixed(&extension)) {
+      return Result::Error;
+    }
+    if (type != kExtensionServerName) {
+      continue;
+    }
+    // Follows the checks BoringSSL applies to the server_name extension: a
+    // single, non-empty host_name entry without NUL bytes.
+    Reader server_name_list, host_name;
+    uint8_t name_type;
+    if (seen_server_name || !extension.readU16Prefixed(&server_name_list) ||
+        extension.size() != 0 || !server_name_list.readU8(&name_type) ||
+        !server_name_list.readU16Prefixed(&host_name) ||
+        server_name_list.size() != 0 || name_type != kNameTypeHostName ||
+        host_name.size() == 0 || host_name.size() > kMaxHostNameSize ||
+        memchr(host_name.data(), 0, host_name.size()) != nullptr) {
+      return Result::Error;
+    }
+    seen_server_name = true;
+    server_name_.assign(reinterpret_cast<const char*>(host_name.data()),
+                        host_name.size());
+  }
+  return Result::Done;
+}
+
+}  // namespace SniVerifier
+}  // namespace Tcp
+}  // namespace Envoy
@@ -0,0 +1,98 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace SniVerifier {
+
+/**
+ * Incremental parser that extracts the SNI from a TLS ClientHello without
+ * running a TLS handshake. Bytes are appended as they arrive; record headers
+ * and the handshake header are parsed once, and the ClientHello body is
+ * parsed once when it is complete, so the work is linear in the size of the
+ * ClientHello regardless of how it is fragmented.
+ *
+ * The parser is deliberately strict. Anything it does not fully understand is
+ * reported as Result::Error, and callers are expected to fall back to a full
+ * TLS implementation over data().
+ */
+class ClientHelloParser {
+ public:
+  enum class Result {
+    // More data is needed to complete the ClientHello.
+    NeedMoreData,
+    // The ClientHello was parsed, serverName() is valid.
+    Done,
+    // The data does not start with a TLS handshake record.
+    NotTls,
+    // The ClientHello does not fit in max_size bytes.
+    TooLarge,
+    // The data could not be parsed.
+    Error,
+  };
+
+  ClientHelloParser(size_t max_size) : max_size_(max_size) {}
+
+  /**
+   * Appends up to max_size bytes in total and continues parsing. Once a final
+   * result is returned, further calls return it again and only buffer data.
+   */
+  Result onData(const void* data, size_t len);
+
+  // The SNI from the server_name extension, empty if it was not present.
+  absl::string_view serverName() const { return server_name_; }
+
+  // All bytes buffered so far.
+  const uint8_t* data() const { return data_.data(); }
+  size_t size() const { return data_.size(); }
+
+ private:
+  Result parse();
+  Result parseClientHello(const uint8_t* data, size_t len);
+  void copyHandshake(size_t pos, size_t len, uint8_t* out) const;
+
+  const size_t max_size_;
+  Result result_{Result::NeedMoreData};
+  std::vector<uint8_t> data_;
+
+  // Offset in data_ of the first byte that has not been parsed yet.
+  size_t offset_{0};
+  // Bytes of the current record's payload that have not been received yet.
+  size_t record_remaining_{0};
+  size_t records_{0};
+
+  // The handshake payload as (offset, length) ranges of data_, one per
+  // record.
+  std::vector<std::pair<size_t, size_t>> fragments_;
+  size_t handshake_size_{0};
+  // Length of the ClientHello including its header, 0 until known.
+  size_t message_size_{0};
+
+  std::string server_name_;
+};
+
+}  // namespace SniVerifier
+}  // namespace Tcp
+}  // namespace Envoy
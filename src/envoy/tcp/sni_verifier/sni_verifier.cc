@@ -18,6 +18,7 @@
 
 #include "src/envoy/tcp/sni_verifier/sni_verifier.h"
 
+#include "absl/container/fixed_array.h"
 #include "common/common/assert.h"
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/exception.h"
@@ -63,11 +64,7 @@ bssl::UniquePtr<SSL> Config::newSsl() {
 }
 
 Filter::Filter(const ConfigSharedPtr config)
-    : config_(config),
-      ssl_(config_->newSsl()),
-      buf_(std::make_unique<uint8_t[]>(config_->maxClientHelloSize())) {
-  SSL_set_accept_state(ssl_.get());
-}
+    : config_(config), parser_(config_->maxClientHelloSize()) {}
 
 Network::FilterStatus Filter::onData(Buffer::Instance& data, bool) {
   ENVOY_CONN_LOG(trace, "SniVerifier: got {} bytes",
@@ -77,23 +74,55 @@ Network::FilterStatus Filter::onData(Buffer::Instance& data, bool) {
                      : Network::FilterStatus::StopIteration;
   }
 
-  size_t left_space_in_buf = config_->maxClientHelloSize() - read_;
-  size_t data_to_read =
-      (data.length() < left_space_in_buf) ? data.length() : left_space_in_buf;
-  data.copyOut(0, data_to_read, buf_.get() + read_);
-
-  auto start_handshake_data =
-      restart_handshake_ ? buf_.get() : buf_.get() + read_;
-  auto handshake_size =
-      restart_handshake_ ? read_ + data_to_read : data_to_read;
-
-  read_ += data_to_read;
-  parseClientHello(start_handshake_data, handshake_size);
+  // The parser buffers the data (up to the maximal ClientHello size) and
+  // only looks at bytes it has not seen before.
+  auto result = ClientHelloParser::Result::NeedMoreData;
+  const uint64_t num_slices = data.getRawSlices(nullptr, 0);
+  absl::FixedArray<Buffer::RawSlice> slices(num_slices);
+  data.getRawSlices(slices.begin(), num_slices);
+  for (const auto& slice : slices) {
+    result = parser_.onData(slice.mem_, slice.len_);
+  }
+  onParserResult(result);
 
   return is_match_ ? Network::FilterStatus::Continue
                    : Network::FilterStatus::StopIteration;
 }
 
+void Filter::onParserResult(ClientHelloParser::Result result) {
+  switch (result) {
+    case ClientHelloParser::Result::NeedMoreData:
+      return;
+    case ClientHelloParser::Result::Done:
+      onServername(parser_.serverName());
+      config_->stats().tls_found_.inc();
+      done(true);
+      return;
+    case ClientHelloParser::Result::NotTls:
+      config_->stats().tls_not_found_.inc();
+      done(false);
+      return;
+    case ClientHelloParser::Result::TooLarge:
+      config_->stats().client_hello_too_large_.inc();
+      done(false);
+      return;
+    case ClientHelloParser::Result::Error:
+      break;
+  }
+
+  // The parser does not understand this ClientHello, let BoringSSL decide.
+  if (!ssl_) {
+    ENVOY_LOG(debug, "sni_verifier: falling back to BoringSSL");
+    config_->stats().parser_fallback_.inc();
+    ssl_ = config_->newSsl();
+    SSL_set_accept_state(ssl_.get());
+    restart_handshake_ = true;
+  }
+  const uint64_t start = restart_handshake_ ? 0 : read_;
+  read_ = parser_.size();
+  parseClientHello(parser_.data() + start, read_ - start);
+}
+
 void Filter::onServername(absl::string_view servername) {
   if (!servername.empty()) {
     config_->stats().inner_sni_found_.inc();
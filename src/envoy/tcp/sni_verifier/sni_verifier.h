@@ -19,6 +19,7 @@
 #include "envoy/network/filter.h"
 #include "envoy/stats/scope.h"
 #include "openssl/ssl.h"
+#include "src/envoy/tcp/sni_verifier/client_hello_parser.h"
 
 namespace Envoy {
 namespace Tcp {
@@ -33,7 +34,8 @@ namespace SniVerifier {
   COUNTER(tls_not_found)            \
   COUNTER(inner_sni_found)          \
   COUNTER(inner_sni_not_found)      \
-  COUNTER(snis_do_not_match)
+  COUNTER(snis_do_not_match)        \
+  COUNTER(parser_fallback)
 
 /**
  * Definition of all stats for the SNI verifier. @see stats_macros.h
@@ -81,6 +83,7 @@ class Filter : public Network::ReadFilter,
   }
 
  private:
+  void onParserResult(ClientHelloParser::Result result);
   void parseClientHello(const void* data, size_t len);
   void done(bool success);
   void onServername(absl::string_view name);
@@ -88,15 +91,19 @@ class Filter : public Network::ReadFilter,
   ConfigSharedPtr config_;
   Network::ReadFilterCallbacks* read_callbacks_{};
 
+  // Extracts the SNI without a TLS handshake, and buffers the ClientHello for
+  // the BoringSSL fallback.
+  ClientHelloParser parser_;
+
+  // Only created when falling back to BoringSSL.
   bssl::UniquePtr<SSL> ssl_;
+  // Number of buffered bytes already passed to BoringSSL.
   uint64_t read_{0};
   bool clienthello_success_{false};
   bool done_{false};
   bool is_match_{false};
   bool restart_handshake_{false};
 
-  std::unique_ptr<uint8_t[]> buf_;
-
   // Allows callbacks on the SSL_CTX to set fields in this class.
   friend class Config;
 };
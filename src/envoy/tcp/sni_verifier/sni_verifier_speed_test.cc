@@ -0,0 +1,153 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "openssl/err.h"
+#include "openssl/ssl.h"
+#include "src/envoy/tcp/sni_verifier/client_hello_parser.h"
+#include "test/extensions/filters/listener/tls_inspector/tls_utility.h"
+
+namespace Envoy {
+namespace Tcp {
+namespace SniVerifier {
+namespace {
+
+constexpr size_t kMaxClientHelloSize = 64 * 1024;
+
+// A ClientHello with a long SNI, split into records of 64 bytes.
+std::vector<uint8_t> fragmentedClientHello() {
+  const auto hello =
+      Tls::Test::generateClientHello(std::string(200, 'a') + ".com", "");
+  std::vector<uint8_t> out;
+  const size_t length = (hello[3] << 8) | hello[4];
+  for (size_t offset = 0; offset < length; offset += 64) {
+    const size_t size = std::min<size_t>(64, length - offset);
+    out.insert(out.end(), hello.begin(), hello.begin() + 3);
+    out.push_back(static_cast<uint8_t>(size >> 8));
+    out.push_back(static_cast<uint8_t>(size));
+    out.insert(out.end(), hello.begin() + 5 + offset,
+               hello.begin() + 5 + offset + size);
+  }
+  return out;
+}
+
+// Replays what the filter used to do for every connection: allocate an SSL
+// object and a maximal buffer, and run the handshake on every read,
+// restarting it from the beginning after an error.
+class BoringSslSniExtractor {
+ public:
+  BoringSslSniExtractor() : ssl_ctx_(SSL_CTX_new(TLS_with_buffers_method())) {
+    SSL_CTX_set_tlsext_servername_callback(
+        ssl_ctx_.get(), [](SSL* ssl, int* out_alert, void*) -> int {
+          auto* found = static_cast<bool*>(SSL_get_app_data(ssl));
+          *found = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name) !=
+                   nullptr;
+          *out_alert = SSL_AD_USER_CANCELLED;
+          return SSL_TLSEXT_ERR_ALERT_FATAL;
+        });
+  }
+
+  bool extract(const std::vector<uint8_t>& data, size_t chunk_size) {
+    bssl::UniquePtr<SSL> ssl(SSL_new(ssl_ctx_.get()));
+    SSL_set_accept_state(ssl.get());
+    auto buf = std::make_unique<uint8_t[]>(kMaxClientHelloSize);
+    bool found = false;
+    bool restart = false;
+    size_t read = 0;
+    while (read < data.size()) {
+      const size_t len = std::min(chunk_size, data.size() - read);
+      memcpy(buf.get() + read, data.data() + read, len);
+      const uint8_t* start = restart ? buf.get() : buf.get() + read;
+      const size_t size = restart ? read + len : len;
+      read += len;
+
+      BIO* bio = BIO_new_mem_buf(start, size);
+      BIO_set_mem_eof_return(bio, -1);
+      SSL_set_bio(ssl.get(), bio, bio);
+      SSL_set_app_data(ssl.get(), &found);
+      restart = false;
+      const int ret = SSL_do_handshake(ssl.get());
+      const int err = SSL_get_error(ssl.get(), ret);
+      ERR_clear_error();
+      if (err == SSL_ERROR_SSL) {
+        if (found) {
+          return true;
+        }
+        SSL_shutdown(ssl.get());
+        SSL_clear(ssl.get());
+        restart = true;
+      } else if (err != SSL_ERROR_WANT_READ) {
+        return false;
+      }
+    }
+    return found;
+  }
+
+ private:
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+};
+
+}  // namespace
+
+static void BM_ClientHelloParser(benchmark::State& state) {
+  const auto data = fragmentedClientHello();
+  const size_t chunk_size = state.range(0);
+  for (auto _ : state) {
+    ClientHelloParser parser(kMaxClientHelloSize);
+    auto result = ClientHelloParser::Result::NeedMoreData;
+    for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+      result = parser.onData(data.data() + offset,
+                             std::min(chunk_size, data.size() - offset));
+    }
+    if (result != ClientHelloParser::Result::Done) {
+      state.SkipWithError("failed to parse the ClientHello");
+    }
+    benchmark::DoNotOptimize(parser.serverName());
+  }
+}
+BENCHMARK(BM_ClientHelloParser)->Arg(1)->Arg(16)->Arg(100)->Arg(100000);
+
+static void BM_BoringSslHandshake(benchmark::State& state) {
+  const auto data = fragmentedClientHello();
+  const size_t chunk_size = state.range(0);
+  BoringSslSniExtractor extractor;
+  for (auto _ : state) {
+    if (!extractor.extract(data, chunk_size)) {
+      state.SkipWithError("failed to parse the ClientHello");
+    }
+  }
+}
+BENCHMARK(BM_BoringSslHandshake)->Arg(1)->Arg(16)->Arg(100)->Arg(100000);
+
+}  // namespace SniVerifier
+}  // namespace Tcp
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
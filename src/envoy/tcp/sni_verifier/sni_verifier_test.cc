@@ -16,11 +16,13 @@
 #include "src/envoy/tcp/sni_verifier/sni_verifier.h"
 
 #include <climits>
+#include <random>
 #include <string>
 
 #include "common/buffer/buffer_impl.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "src/envoy/tcp/sni_verifier/client_hello_parser.h"
 #include "src/envoy/tcp/sni_verifier/config.h"
 #include "test/extensions/filters/listener/tls_inspector/tls_utility.h"
 #include "test/mocks/network/mocks.h"
@@ -229,6 +231,130 @@ TEST_F(SniVerifierFilterTest, NonTLS) {
   EXPECT_EQ(0, cfg_->stats().snis_do_not_match_.value());
 }
 
+TEST_F(SniVerifierFilterTest, SnisMatchSendDataInChunksOfOne) {
+  runTestForClientHello("example.com", "example.com",
+                        Network::FilterStatus::Continue, 1);
+  EXPECT_EQ(1, cfg_->stats().tls_found_.value());
+  EXPECT_EQ(1, cfg_->stats().inner_sni_found_.value());
+  EXPECT_EQ(0, cfg_->stats().snis_do_not_match_.value());
+  EXPECT_EQ(0, cfg_->stats().parser_fallback_.value());
+}
+
+TEST_F(SniVerifierFilterTest, FallbackToBoringSsl) {
+  auto client_hello = Tls::Test::generateClientHello("example.com", "");
+  // A ServerHello is not understood by the parser; BoringSSL rejects it too.
+  client_hello[5] = 2;
+  runTestForData("example.com", client_hello,
+                 Network::FilterStatus::StopIteration);
+  EXPECT_EQ(1, cfg_->stats().parser_fallback_.value());
+  EXPECT_EQ(0, cfg_->stats().tls_found_.value());
+  EXPECT_EQ(0, cfg_->stats().inner_sni_found_.value());
+}
+
+namespace {
+
+// Splits the handshake message of a single-record ClientHello into records of
+// at most record_size bytes.
+std::vector<uint8_t> splitIntoRecords(const std::vector<uint8_t>& hello,
+                                      size_t record_size) {
+  std::vector<uint8_t> out;
+  const size_t length = (hello[3] << 8) | hello[4];
+  for (size_t offset = 0; offset < length; offset += record_size) {
+    const size_t size = std::min(record_size, length - offset);
+    out.insert(out.end(), hello.begin(), hello.begin() + 3);
+    out.push_back(static_cast<uint8_t>(size >> 8));
+    out.push_back(static_cast<uint8_t>(size));
+    out.insert(out.end(), hello.begin() + 5 + offset,
+               hello.begin() + 5 + offset + size);
+  }
+  return out;
+}
+
+ClientHelloParser::Result parseInChunks(const std::vector<uint8_t>& data,
+                                        size_t chunk_size, size_t max_size,
+                                        std::string* server_name) {
+  ClientHelloParser parser(max_size);
+  auto result = ClientHelloParser::Result::NeedMoreData;
+  for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+    result = parser.onData(data.data() + offset,
+                           std::min(chunk_size, data.size() - offset));
+  }
+  *server_name = std::string(parser.serverName());
+  return result;
+}
+
+}  // namespace
+
+TEST(ClientHelloParserTest, Fragmented) {
+  const auto client_hello = Tls::Test::generateClientHello("example.com", "");
+  for (size_t record_size : {1, 7, 100, 16384}) {
+    const auto records = splitIntoRecords(client_hello, record_size);
+    for (size_t chunk_size : {1, 3, 10, 50, 100000}) {
+      std::string server_name;
+      EXPECT_EQ(ClientHelloParser::Result::Done,
+                parseInChunks(records, chunk_size, Config::TLS_MAX_CLIENT_HELLO,
+                              &server_name))
+          << record_size << " " << chunk_size;
+      EXPECT_EQ("example.com", server_name);
+    }
+  }
+}
+
+TEST(ClientHelloParserTest, NoServerName) {
+  std::string server_name;
+  EXPECT_EQ(ClientHelloParser::Result::Done,
+            parseInChunks(Tls::Test::generateClientHello("", ""), 10,
+                          Config::TLS_MAX_CLIENT_HELLO, &server_name));
+  EXPECT_EQ("", server_name);
+}
+
+TEST(ClientHelloParserTest, NotTls) {
+  std::string server_name;
+  EXPECT_EQ(ClientHelloParser::Result::NotTls,
+            parseInChunks({'G', 'E', 'T', ' '}, 1,
+                          Config::TLS_MAX_CLIENT_HELLO, &server_name));
+}
+
+TEST(ClientHelloParserTest, TooLarge) {
+  const auto client_hello = Tls::Test::generateClientHello("example.com", "");
+  std::string server_name;
+  // Known as soon as the handshake header arrives.
+  EXPECT_EQ(ClientHelloParser::Result::TooLarge,
+            parseInChunks({client_hello.begin(), client_hello.begin() + 9}, 1,
+                          client_hello.size() - 6, &server_name));
+  // Record headers are counted as well.
+  EXPECT_EQ(ClientHelloParser::Result::TooLarge,
+            parseInChunks(splitIntoRecords(client_hello, 10), 1,
+                          client_hello.size(), &server_name));
+}
+
+// Feeds randomly mutated, truncated and fragmented ClientHellos to the parser.
+// The result must never depend on how the data is fragmented.
+TEST(ClientHelloParserTest, Fuzz) {
+  const auto client_hello = Tls::Test::generateClientHello("example.com", "");
+  std::mt19937 rng(42);
+  for (int i = 0; i < 20000; i++) {
+    auto data = splitIntoRecords(client_hello, 1 + rng() % 400);
+    const int mutations = rng() % 4;
+    for (int j = 0; j < mutations; j++) {
+      data[rng() % data.size()] = static_cast<uint8_t>(rng());
+    }
+    if (rng() % 3 == 0) {
+      data.resize(rng() % data.size());
+    }
+
+    std::string want_server_name, got_server_name;
+    const auto want = parseInChunks(data, data.size() + 1,
+                                    Config::TLS_MAX_CLIENT_HELLO,
+                                    &want_server_name);
+    const auto got = parseInChunks(data, 1 + rng() % 64,
+                                   Config::TLS_MAX_CLIENT_HELLO,
+                                   &got_server_name);
+    ASSERT_EQ(want, got);
+    ASSERT_EQ(want_server_name, got_server_name);
+  }
+}
+
 }  // namespace SniVerifier
 }  // namespace Tcp
 }  // namespace Envoy
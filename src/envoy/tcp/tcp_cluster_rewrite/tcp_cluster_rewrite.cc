@@ -15,8 +15,10 @@
 
 #include "src/envoy/tcp/tcp_cluster_rewrite/tcp_cluster_rewrite.h"
 
+#include "absl/strings/ascii.h"
 #include "common/common/assert.h"
 #include "common/tcp_proxy/tcp_proxy.h"
+#include "envoy/common/exception.h"
 #include "envoy/network/connection.h"
 
 using namespace ::istio::envoy::config::filter::network::tcp_cluster_rewrite;
@@ -25,15 +27,99 @@ namespace Envoy {
 namespace Tcp {
 namespace TcpClusterRewrite {
 
+namespace {
+
+// Cluster names are matched byte by byte, as std::regex does.
+re2::RE2::Options regexOptions() {
+  re2::RE2::Options options(re2::RE2::Quiet);
+  options.set_encoding(re2::RE2::Options::EncodingLatin1);
+  return options;
+}
+
+}  // namespace
+
 TcpClusterRewriteFilterConfig::TcpClusterRewriteFilterConfig(
     const v2alpha1::TcpClusterRewrite& proto_config) {
-  if (!proto_config.cluster_pattern().empty()) {
-    should_rewrite_cluster_ = true;
-    cluster_pattern_ = std::regex(proto_config.cluster_pattern());
-    cluster_replacement_ = proto_config.cluster_replacement();
-  } else {
-    should_rewrite_cluster_ = false;
+  if (proto_config.cluster_pattern().empty()) {
+    return;
+  }
+  should_rewrite_cluster_ = true;
+  auto pattern = std::make_unique<re2::RE2>(proto_config.cluster_pattern(),
+                                            regexOptions());
+  std::string replacement;
+  std::string error;
+  if (pattern->ok() &&
+      toRe2Rewrite(proto_config.cluster_replacement(), &replacement) &&
+      pattern->CheckRewriteString(replacement, &error)) {
+    cluster_pattern_ = std::move(pattern);
+    cluster_replacement_ = std::move(replacement);
+    return;
+  }
+
+  // Patterns with lookarounds or back references, and replacements RE2 can
+  // not express, keep the std::regex semantics they were written for.
+  try {
+    std_cluster_pattern_ =
+        std::make_unique<std::regex>(proto_config.cluster_pattern());
+  } catch (const std::regex_error& e) {
+    throw EnvoyException(fmt::format("Invalid cluster pattern {}: {}",
+                                     proto_config.cluster_pattern(),
+                                     e.what()));
+  }
+  cluster_replacement_ = proto_config.cluster_replacement();
+}
+
+bool TcpClusterRewriteFilterConfig::toRe2Rewrite(absl::string_view format,
+                                                 std::string* rewrite) {
+  rewrite->clear();
+  for (size_t i = 0; i < format.size(); i++) {
+    const char c = format[i];
+    if (c == '\\') {
+      rewrite->append("\\\\");
+      continue;
+    }
+    if (c != '$' || i + 1 == format.size()) {
+      rewrite->push_back(c);
+      continue;
+    }
+    const char next = format[i + 1];
+    if (next == '$') {
+      rewrite->push_back('$');
+      i++;
+    } else if (next == '&') {
+      rewrite->append("\\0");
+      i++;
+    } else if (next == '`' || next == '\'') {
+      // The prefix and suffix of the match have no RE2 equivalent.
+      return false;
+    } else if (absl::ascii_isdigit(next)) {
+      // $n or $nn refers to a capture group; RE2 only supports \0 to \9.
+      if (i + 2 < format.size() && absl::ascii_isdigit(format[i + 2])) {
+        if (next != '0') {
+          return false;
+        }
+        i++;
+      }
+      rewrite->push_back('\\');
+      rewrite->push_back(format[i + 1]);
+      i++;
+    } else {
+      rewrite->push_back('$');
+    }
+  }
+  return true;
+}
+
+std::string TcpClusterRewriteFilterConfig::rewriteCluster(
+    absl::string_view cluster_name) const {
+  if (std_cluster_pattern_) {
+    return std::regex_replace(std::string(cluster_name),
+                              *std_cluster_pattern_, cluster_replacement_);
   }
+  std::string final_cluster_name(cluster_name);
+  re2::RE2::GlobalReplace(&final_cluster_name, *cluster_pattern_,
+                          cluster_replacement_);
+  return final_cluster_name;
 }
 
 Network::FilterStatus TcpClusterRewriteFilter::onNewConnection() {
@@ -55,10 +141,7 @@ Network::FilterStatus TcpClusterRewriteFilter::onNewConnection() {
                    read_callbacks_->connection(), cluster_name);
 
     // Rewrite the cluster name prior to setting the tcp_proxy cluster name.
-    std::string final_cluster_name(absl::StrCat(cluster_name));
-    final_cluster_name =
-        std::regex_replace(final_cluster_name, config_->clusterPattern(),
-                           config_->clusterReplacement());
+    std::string final_cluster_name = config_->rewriteCluster(cluster_name);
     ENVOY_CONN_LOG(trace,
                    "tcp_cluster_rewrite: final tcp proxy cluster name {}",
                    read_callbacks_->connection(), final_cluster_name);
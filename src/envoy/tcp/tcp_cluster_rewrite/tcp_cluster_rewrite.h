@@ -15,11 +15,15 @@
 
 #pragma once
 
+#include <memory>
 #include <regex>
+#include <string>
 
+#include "absl/strings/string_view.h"
 #include "common/common/logger.h"
 #include "envoy/config/filter/network/tcp_cluster_rewrite/v2alpha1/config.pb.h"
 #include "envoy/network/filter.h"
+#include "re2/re2.h"
 
 using namespace ::istio::envoy::config::filter::network::tcp_cluster_rewrite;
 
@@ -28,7 +32,10 @@ namespace Tcp {
 namespace TcpClusterRewrite {
 
 /**
- * Configuration for the TCP cluster rewrite filter.
+ * Configuration for the TCP cluster rewrite filter. The cluster pattern is
+ * compiled once and only read afterwards, so the configuration is shared by
+ * all workers without locking. It is compiled with RE2 when the pattern and
+ * replacement translate exactly, and with std::regex otherwise.
  */
 class TcpClusterRewriteFilterConfig {
  public:
@@ -36,12 +43,27 @@ class TcpClusterRewriteFilterConfig {
       const v2alpha1::TcpClusterRewrite& proto_config);
 
   bool shouldRewriteCluster() const { return should_rewrite_cluster_; }
-  std::regex clusterPattern() const { return cluster_pattern_; }
-  std::string clusterReplacement() const { return cluster_replacement_; }
+
+  /**
+   * Returns the cluster name with every match of the cluster pattern
+   * replaced by the cluster replacement.
+   */
+  std::string rewriteCluster(absl::string_view cluster_name) const;
+
+  /**
+   * Converts a std::regex_replace format string, which the cluster
+   * replacement has always been, to an RE2 rewrite string. Returns false if
+   * the format uses a feature RE2 does not support.
+   */
+  static bool toRe2Rewrite(absl::string_view format, std::string* rewrite);
 
  private:
-  bool should_rewrite_cluster_;
-  std::regex cluster_pattern_;
+  bool should_rewrite_cluster_{false};
+  // Exactly one of the patterns is set when the cluster is rewritten.
+  std::unique_ptr<re2::RE2> cluster_pattern_;
+  std::unique_ptr<std::regex> std_cluster_pattern_;
+  // The cluster replacement, in RE2 rewrite syntax for cluster_pattern_ and
+  // in std::regex_replace format for std_cluster_pattern_.
   std::string cluster_replacement_;
 };
 
@@ -0,0 +1,88 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "src/envoy/tcp/tcp_cluster_rewrite/tcp_cluster_rewrite.h"
+
+using namespace ::istio::envoy::config::filter::network::tcp_cluster_rewrite;
+
+namespace Envoy {
+namespace Tcp {
+namespace TcpClusterRewrite {
+namespace {
+
+constexpr char kPattern[] = "\\.global$";
+constexpr char kReplacement[] = ".svc.cluster.local";
+
+// Cluster names of count distinct services.
+std::vector<std::string> clusterNames(int count) {
+  std::vector<std::string> names;
+  for (int i = 0; i < count; i++) {
+    names.push_back(absl::StrCat("service", i, ".ns1.global"));
+  }
+  return names;
+}
+
+}  // namespace
+
+// What the filter used to do for every connection: copy the compiled regex
+// and the replacement out of the config, and run std::regex_replace.
+static void BM_StdRegexReplace(benchmark::State& state) {
+  const std::regex pattern(kPattern);
+  const std::string replacement(kReplacement);
+  const auto names = clusterNames(state.range(0));
+  size_t i = 0;
+  for (auto _ : state) {
+    const std::regex pattern_copy = pattern;
+    const std::string replacement_copy = replacement;
+    std::string name(names[i++ % names.size()]);
+    benchmark::DoNotOptimize(
+        std::regex_replace(name, pattern_copy, replacement_copy));
+  }
+}
+BENCHMARK(BM_StdRegexReplace)->Arg(1)->Arg(100)->Arg(10000);
+
+static void BM_RewriteCluster(benchmark::State& state) {
+  v2alpha1::TcpClusterRewrite proto_config;
+  proto_config.set_cluster_pattern(kPattern);
+  proto_config.set_cluster_replacement(kReplacement);
+  TcpClusterRewriteFilterConfig config(proto_config);
+  const auto names = clusterNames(state.range(0));
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.rewriteCluster(names[i++ % names.size()]));
+  }
+}
+BENCHMARK(BM_RewriteCluster)->Arg(1)->Arg(100)->Arg(10000);
+
+}  // namespace TcpClusterRewrite
+}  // namespace Tcp
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -15,7 +15,9 @@
 
 #include "src/envoy/tcp/tcp_cluster_rewrite/tcp_cluster_rewrite.h"
 
+#include "absl/strings/str_cat.h"
 #include "common/tcp_proxy/tcp_proxy.h"
+#include "envoy/common/exception.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "src/envoy/tcp/tcp_cluster_rewrite/config.h"
@@ -56,6 +58,16 @@ class TcpClusterRewriteFilterTest : public testing::Test {
   std::unique_ptr<TcpClusterRewriteFilter> filter_;
 };
 
+// Rewrites cluster_name with pattern and replacement through the filter.
+std::string rewrite(const std::string& pattern, const std::string& replacement,
+                    const std::string& cluster_name) {
+  v2alpha1::TcpClusterRewrite proto_config;
+  proto_config.set_cluster_pattern(pattern);
+  proto_config.set_cluster_replacement(replacement);
+  TcpClusterRewriteFilterConfig config(proto_config);
+  return config.rewriteCluster(cluster_name);
+}
+
 TEST_F(TcpClusterRewriteFilterTest, ClusterRewrite) {
   // no rewrite
   {
@@ -126,6 +138,56 @@ TEST_F(TcpClusterRewriteFilterTest, ClusterRewrite) {
   }
 }
 
+TEST(TcpClusterRewriteFilterConfigTest, RewriteSemantics) {
+  // Every match is replaced, as std::regex_replace did.
+  EXPECT_EQ(rewrite("\\.", "-", "hello.ns1.global"), "hello-ns1-global");
+  // No match leaves the cluster name as is.
+  EXPECT_EQ(rewrite("\\.local$", ".global", "hello.ns1.global"),
+            "hello.ns1.global");
+  // Capture groups in std::regex_replace format.
+  EXPECT_EQ(
+      rewrite("^(\\w+)\\.(\\w+)\\.global$", "$2.$1.svc", "hello.ns1.global"),
+      "ns1.hello.svc");
+  EXPECT_EQ(rewrite("^(\\w+)\\.", "$01-", "hello.ns1.global"),
+            "hello-ns1.global");
+  EXPECT_EQ(rewrite("ns1", "[$&]", "hello.ns1.global"), "hello.[ns1].global");
+  // $$ and a $ that is not a reference are literal dollars, backslashes are
+  // copied as is.
+  EXPECT_EQ(rewrite("ns1", "$$x$y\\1", "hello.ns1"), "hello.$x$y\\1");
+}
+
+TEST(TcpClusterRewriteFilterConfigTest, StdRegexFallback) {
+  // Back references and lookarounds are not supported by RE2.
+  EXPECT_EQ(rewrite("(\\w)\\1", "x", "hello.ns1"), "hexo.ns1");
+  EXPECT_EQ(rewrite("ns1(?=\\.)", "ns2", "hello.ns1.global"),
+            "hello.ns2.global");
+  // The prefix and suffix of the match.
+  EXPECT_EQ(rewrite("\\.ns1", "-$`-$'", "hello.ns1.global"),
+            "hello-hello-.global.global");
+  // A reference to a capture group the pattern does not have is empty.
+  EXPECT_EQ(rewrite("\\.global$", "$1", "hello.ns1.global"), "hello.ns1");
+}
+
+TEST(TcpClusterRewriteFilterConfigTest, InvalidConfig) {
+  v2alpha1::TcpClusterRewrite proto_config;
+  proto_config.set_cluster_pattern("(unbalanced");
+  EXPECT_THROW(TcpClusterRewriteFilterConfig config(proto_config),
+               EnvoyException);
+}
+
+TEST(TcpClusterRewriteFilterConfigTest, RewriteManyClusters) {
+  v2alpha1::TcpClusterRewrite proto_config;
+  proto_config.set_cluster_pattern("\\.global$");
+  proto_config.set_cluster_replacement(".svc.cluster.local");
+  const TcpClusterRewriteFilterConfig config(proto_config);
+
+  for (int i = 0; i < 100; i++) {
+    const std::string name = absl::StrCat("hello", i, ".ns1.global");
+    EXPECT_EQ(config.rewriteCluster(name),
+              absl::StrCat("hello", i, ".ns1.svc.cluster.local"));
+  }
+}
+
 }  // namespace TcpClusterRewrite
 }  // namespace Tcp
 }  // namespace Envoy
@@ -90,5 +90,28 @@ const ProtobufWkt::Struct* Authentication::GetResultFromMetadata(
   return &(iter->second);
 }
 
+void Authentication::SaveResultToFilterState(
+    istio::authn::Result&& result, StreamInfo::FilterState& filter_state) {
+  if (filter_state.hasDataWithName(Utils::IstioFilterName::kAuthentication)) {
+    return;
+  }
+  filter_state.setData(
+      Utils::IstioFilterName::kAuthentication,
+      std::make_unique<AuthenticationResult>(std::move(result)),
+      StreamInfo::FilterState::StateType::ReadOnly);
+}
+
+const istio::authn::Result* Authentication::GetResultFromFilterState(
+    const StreamInfo::FilterState& filter_state) {
+  if (!filter_state.hasData<AuthenticationResult>(
+          Utils::IstioFilterName::kAuthentication)) {
+    return nullptr;
+  }
+  return &filter_state
+              .getDataReadOnly<AuthenticationResult>(
+                  Utils::IstioFilterName::kAuthentication)
+              .result();
+}
+
 }  // namespace Utils
 }  // namespace Envoy
@@ -16,12 +16,27 @@
 #include "common/common/logger.h"
 #include "common/protobuf/protobuf.h"
 #include "envoy/api/v2/core/base.pb.h"
+#include "envoy/stream_info/filter_state.h"
 #include "google/protobuf/struct.pb.h"
 #include "src/istio/authn/context.pb.h"
 
 namespace Envoy {
 namespace Utils {
 
+// The authentication result of a request, shared through the filter state
+// with the filters that follow the authentication filter. They read it as
+// is, instead of the Struct copy saved in the dynamic metadata.
+class AuthenticationResult : public StreamInfo::FilterState::Object {
+ public:
+  AuthenticationResult(istio::authn::Result&& result)
+      : result_(std::move(result)) {}
+
+  const istio::authn::Result& result() const { return result_; }
+
+ private:
+  const istio::authn::Result result_;
+};
+
 class Authentication : public Logger::Loggable<Logger::Id::filter> {
  public:
   // Save authentication attributes into the data Struct.
@@ -34,6 +49,16 @@ class Authentication : public Logger::Loggable<Logger::Id::filter> {
   // Returns nullptr if there is no data for that filter.
   static const ProtobufWkt::Struct* GetResultFromMetadata(
       const envoy::api::v2::core::Metadata& metadata);
+
+  // Save the authentication result into the filter state, under the
+  // authentication filter name. Does nothing if a result is already saved.
+  static void SaveResultToFilterState(istio::authn::Result&& result,
+                                      StreamInfo::FilterState& filter_state);
+
+  // Returns a pointer to the authentication result from the filter state, or
+  // nullptr if there is none.
+  static const istio::authn::Result* GetResultFromFilterState(
+      const StreamInfo::FilterState& filter_state);
 };
 
 }  // namespace Utils
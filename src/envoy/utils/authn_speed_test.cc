@@ -0,0 +1,103 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "common/stream_info/filter_state_impl.h"
+#include "src/envoy/utils/authn.h"
+#include "src/envoy/utils/filter_names.h"
+#include "src/istio/utils/allocation_counter.h"
+
+namespace Envoy {
+namespace Utils {
+namespace {
+
+// The authentication result of a request with a peer identity and a JWT
+// with the given number of claims.
+istio::authn::Result authenticationResult(int claims) {
+  istio::authn::Result result;
+  result.set_principal("https://accounts.example.com/example-subject");
+  result.set_peer_user("cluster.local/ns/default/sa/productpage");
+  auto* origin = result.mutable_origin();
+  origin->set_user(result.principal());
+  origin->add_audiences("bookstore");
+  origin->set_presenter("example-presenter");
+  auto& fields = *origin->mutable_claims()->mutable_fields();
+  std::string raw_claims = "{";
+  for (int i = 0; i < claims; i++) {
+    const std::string name = "claim-" + std::to_string(i);
+    const std::string value = "value-" + std::to_string(i);
+    fields[name].mutable_list_value()->add_values()->set_string_value(value);
+    raw_claims += "\"" + name + "\":\"" + value + "\",";
+  }
+  raw_claims.back() = '}';
+  origin->set_raw_claims(raw_claims);
+  return result;
+}
+
+}  // namespace
+
+// What the authentication filter did for every request: copy the result
+// into a Struct, merged into the dynamic metadata.
+static void BM_SaveToDynamicMetadata(benchmark::State& state) {
+  const auto result = authenticationResult(state.range(0));
+  const uint64_t start = ::istio::utils::AllocationCount();
+  for (auto _ : state) {
+    istio::authn::Result request_result = result;
+    envoy::api::v2::core::Metadata metadata;
+    ProtobufWkt::Struct data;
+    Authentication::SaveAuthAttributesToStruct(request_result, data);
+    (*metadata.mutable_filter_metadata())[IstioFilterName::kAuthentication]
+        .MergeFrom(data);
+    benchmark::DoNotOptimize(
+        Authentication::GetResultFromMetadata(metadata));
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(::istio::utils::AllocationCount() - start,
+                         benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SaveToDynamicMetadata)->Arg(30);
+
+static void BM_SaveToFilterState(benchmark::State& state) {
+  const auto result = authenticationResult(state.range(0));
+  const uint64_t start = ::istio::utils::AllocationCount();
+  for (auto _ : state) {
+    istio::authn::Result request_result = result;
+    StreamInfo::FilterStateImpl filter_state;
+    Authentication::SaveResultToFilterState(std::move(request_result),
+                                            filter_state);
+    benchmark::DoNotOptimize(
+        Authentication::GetResultFromFilterState(filter_state));
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(::istio::utils::AllocationCount() - start,
+                         benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SaveToFilterState)->Arg(30);
+
+}  // namespace Utils
+}  // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs
+// them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
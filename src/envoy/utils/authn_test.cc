@@ -16,6 +16,7 @@
 #include "src/envoy/utils/authn.h"
 
 #include "common/protobuf/protobuf.h"
+#include "common/stream_info/filter_state_impl.h"
 #include "include/istio/utils/attribute_names.h"
 #include "src/istio/authn/context.pb.h"
 #include "test/test_common/utility.h"
@@ -107,5 +108,29 @@ TEST_F(AuthenticationTest, SaveAuthAttributesToStruct) {
             "rawclaim");
 }
 
+TEST_F(AuthenticationTest, SaveResultToFilterState) {
+  StreamInfo::FilterStateImpl filter_state;
+  EXPECT_EQ(nullptr, Authentication::GetResultFromFilterState(filter_state));
+
+  Result result = test_result_;
+  (*result.mutable_origin()->mutable_claims()->mutable_fields())["iss"]
+      .set_string_value("issuer");
+  Authentication::SaveResultToFilterState(std::move(result), filter_state);
+
+  const Result* saved = Authentication::GetResultFromFilterState(filter_state);
+  ASSERT_NE(nullptr, saved);
+  EXPECT_EQ("foo", saved->principal());
+  EXPECT_EQ("bar", saved->peer_user());
+  EXPECT_EQ("issuer",
+            saved->origin().claims().fields().at("iss").string_value());
+
+  // The first result is kept.
+  Result other;
+  other.set_principal("other");
+  Authentication::SaveResultToFilterState(std::move(other), filter_state);
+  EXPECT_EQ(saved, Authentication::GetResultFromFilterState(filter_state));
+  EXPECT_EQ("foo", saved->principal());
+}
+
 }  // namespace Utils
 }  // namespace Envoy
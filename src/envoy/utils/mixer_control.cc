@@ -15,6 +15,7 @@
 
 #include "src/envoy/utils/mixer_control.h"
 
+#include "absl/strings/numbers.h"
 #include "src/envoy/utils/grpc_transport.h"
 
 using ::istio::mixerclient::Statistics;
@@ -27,6 +28,8 @@ namespace Utils {
 
 const char kNodeUID[] = "NODE_UID";
 const char kNodeNamespace[] = "NODE_NAMESPACE";
+const char kCheckCacheRefreshAheadMs[] = "MIXER_CHECK_CACHE_REFRESH_AHEAD_MS";
+const char kCheckCacheMaxStaleMs[] = "MIXER_CHECK_CACHE_MAX_STALE_MS";
 
 namespace {
 
@@ -199,5 +202,38 @@ bool ExtractNodeInfo(const envoy::api::v2::core::Node &node, LocalNode *args) {
   return false;
 }
 
+namespace {
+
+void ExtractMilliseconds(const envoy::api::v2::core::Node &node,
+                         const char *key, uint32_t *ms) {
+  const auto &fields = node.metadata().fields();
+  const auto it = fields.find(key);
+  if (it == fields.end()) {
+    return;
+  }
+  const auto &value = it->second;
+  uint32_t parsed;
+  if (value.kind_case() == ProtobufWkt::Value::kNumberValue &&
+      value.number_value() >= 0 && value.number_value() <= UINT32_MAX) {
+    *ms = static_cast<uint32_t>(value.number_value());
+  } else if (value.kind_case() == ProtobufWkt::Value::kStringValue &&
+             absl::SimpleAtoi(value.string_value(), &parsed)) {
+    *ms = parsed;
+  } else {
+    auto &logger = Logger::Registry::getLog(Logger::Id::config);
+    ENVOY_LOG_TO_LOGGER(logger, warn, "Invalid node metadata {}: {}", key,
+                        value.DebugString());
+  }
+}
+
+}  // namespace
+
+void ExtractCheckCacheRefresh(const envoy::api::v2::core::Node &node,
+                              uint32_t *refresh_ahead_ms,
+                              uint32_t *max_stale_ms) {
+  ExtractMilliseconds(node, kCheckCacheRefreshAheadMs, refresh_ahead_ms);
+  ExtractMilliseconds(node, kCheckCacheMaxStaleMs, max_stale_ms);
+}
+
 }  // namespace Utils
 }  // namespace Envoy
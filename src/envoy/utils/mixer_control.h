@@ -46,5 +46,12 @@ Grpc::AsyncClientFactoryPtr GrpcClientFactoryForCluster(
 bool ExtractNodeInfo(const envoy::api::v2::core::Node &node,
                      ::istio::utils::LocalNode *args);
 
+// Reads the milliseconds of the MIXER_CHECK_CACHE_REFRESH_AHEAD_MS and
+// MIXER_CHECK_CACHE_MAX_STALE_MS node metadata, given as numbers or strings.
+// Missing or invalid values are left unchanged.
+void ExtractCheckCacheRefresh(const envoy::api::v2::core::Node &node,
+                              uint32_t *refresh_ahead_ms,
+                              uint32_t *max_stale_ms);
+
 }  // namespace Utils
 }  // namespace Envoy
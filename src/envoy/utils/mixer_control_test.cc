@@ -20,6 +20,7 @@
 #include "src/envoy/utils/utils.h"
 #include "test/test_common/utility.h"
 
+using Envoy::Utils::ExtractCheckCacheRefresh;
 using Envoy::Utils::ExtractNodeInfo;
 using Envoy::Utils::ParseJsonMessage;
 using ::istio::utils::AttributeName;
@@ -127,4 +128,27 @@ TEST(MixerControlTest, NoMetadata) {
   ASSERT_LOCAL_NODE(lexp, largs);
 }
 
+TEST(MixerControlTest, CheckCacheRefresh) {
+  envoy::api::v2::core::Node node;
+  uint32_t refresh_ahead_ms = 0;
+  uint32_t max_stale_ms = 0;
+  ExtractCheckCacheRefresh(node, &refresh_ahead_ms, &max_stale_ms);
+  EXPECT_EQ(refresh_ahead_ms, 0u);
+  EXPECT_EQ(max_stale_ms, 0u);
+
+  auto &fields = *node.mutable_metadata()->mutable_fields();
+  fields["MIXER_CHECK_CACHE_REFRESH_AHEAD_MS"].set_number_value(2000);
+  fields["MIXER_CHECK_CACHE_MAX_STALE_MS"].set_string_value("500");
+  ExtractCheckCacheRefresh(node, &refresh_ahead_ms, &max_stale_ms);
+  EXPECT_EQ(refresh_ahead_ms, 2000u);
+  EXPECT_EQ(max_stale_ms, 500u);
+
+  // Invalid values are ignored.
+  fields["MIXER_CHECK_CACHE_REFRESH_AHEAD_MS"].set_number_value(-1);
+  fields["MIXER_CHECK_CACHE_MAX_STALE_MS"].set_string_value("soon");
+  ExtractCheckCacheRefresh(node, &refresh_ahead_ms, &max_stale_ms);
+  EXPECT_EQ(refresh_ahead_ms, 2000u);
+  EXPECT_EQ(max_stale_ms, 500u);
+}
+
 }  // namespace
@@ -68,6 +68,7 @@ void MixerStatsObject::CheckAndUpdateStats(
   CHECK_AND_UPDATE_STATS(total_remote_check_calls_);
   CHECK_AND_UPDATE_STATS(total_remote_check_accepts_);
   CHECK_AND_UPDATE_STATS(total_remote_check_denies_);
+  CHECK_AND_UPDATE_STATS(total_remote_check_refresh_calls_);
   CHECK_AND_UPDATE_STATS(total_quota_calls_);
   CHECK_AND_UPDATE_STATS(total_quota_cache_hits_);
   CHECK_AND_UPDATE_STATS(total_quota_cache_misses_);
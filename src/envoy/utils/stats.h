@@ -36,6 +36,7 @@ namespace Utils {
   COUNTER(total_remote_check_calls)           \
   COUNTER(total_remote_check_accepts)         \
   COUNTER(total_remote_check_denies)          \
+  COUNTER(total_remote_check_refresh_calls)   \
   COUNTER(total_quota_calls)                  \
   COUNTER(total_quota_cache_hits)             \
   COUNTER(total_quota_cache_misses)           \
@@ -74,10 +74,11 @@ void ExtractHeaders(const Http::HeaderMap& header_map,
       [](const Http::HeaderEntry& header,
          void* context) -> Http::HeaderMap::Iterate {
         Context* ctx = static_cast<Context*>(context);
-        auto key = std::string(header.key().getStringView());
-        auto value = std::string(header.value().getStringView());
+        std::string key(header.key().getStringView());
+        // Only the values of the selected headers are copied.
         if (ctx->exclusives.count(key) == 0) {
-          ctx->headers[key] = value;
+          ctx->headers[std::move(key)] =
+              std::string(header.value().getStringView());
         }
         return Http::HeaderMap::Iterate::Continue;
       },
@@ -99,10 +100,11 @@ void FindHeaders(const Http::HeaderMap& header_map,
       [](const Http::HeaderEntry& header,
          void* context) -> Http::HeaderMap::Iterate {
         Context* ctx = static_cast<Context*>(context);
-        auto key = std::string(header.key().getStringView());
-        auto value = std::string(header.value().getStringView());
+        std::string key(header.key().getStringView());
+        // Only the values of the selected headers are copied.
         if (ctx->inclusives.count(key) != 0) {
-          ctx->headers[key] = value;
+          ctx->headers[std::move(key)] =
+              std::string(header.value().getStringView());
         }
         return Http::HeaderMap::Iterate::Continue;
       },
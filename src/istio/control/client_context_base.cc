@@ -114,10 +114,14 @@ ReportOptions GetReportOptions(const TransportConfig& config) {
 
 ClientContextBase::ClientContextBase(const TransportConfig& config,
                                      const Environment& env, bool outbound,
-                                     const LocalNode& local_node)
+                                     const LocalNode& local_node,
+                                     uint32_t check_cache_refresh_ahead_ms,
+                                     uint32_t check_cache_max_stale_ms)
     : outbound_(outbound) {
   MixerClientOptions options(GetCheckOptions(config), GetReportOptions(config),
                              GetQuotaOptions(config));
+  options.check_options.refresh_ahead_ms = check_cache_refresh_ahead_ms;
+  options.check_options.max_stale_ms = check_cache_max_stale_ms;
   options.env = env;
   mixer_client_ = ::istio::mixerclient::CreateMixerClient(options);
   CreateLocalAttributes(local_node, &local_attributes_);
@@ -34,7 +34,9 @@ class ClientContextBase {
   ClientContextBase(
       const ::istio::mixer::v1::config::client::TransportConfig& config,
       const ::istio::mixerclient::Environment& env, bool outbound,
-      const ::istio::utils::LocalNode& local_node);
+      const ::istio::utils::LocalNode& local_node,
+      uint32_t check_cache_refresh_ahead_ms = 0,
+      uint32_t check_cache_max_stale_ms = 0);
 
   // A constructor for unit-test to pass in a mock mixer_client
   ClientContextBase(
@@ -21,6 +21,7 @@
 #include "include/istio/utils/attribute_names.h"
 #include "include/istio/utils/attributes_builder.h"
 #include "include/istio/utils/status.h"
+#include "src/istio/utils/utils.h"
 
 using ::istio::mixer::v1::Attributes;
 using ::istio::mixer::v1::Attributes_StringMap;
@@ -33,11 +34,53 @@ namespace {
 const std::set<std::string> kGrpcContentTypes{
     "application/grpc", "application/grpc+proto", "application/grpc+json"};
 
+// Adds the same attributes as the dynamic metadata form of the
+// authentication result, see Utils::Authentication in src/envoy/utils.
+void AddAuthenticationResult(const ::istio::authn::Result &result,
+                             utils::AttributesBuilder *builder) {
+  if (!result.principal().empty()) {
+    builder->AddString(utils::AttributeName::kRequestAuthPrincipal,
+                       result.principal());
+  }
+  if (!result.peer_user().empty()) {
+    builder->AddString(utils::AttributeName::kSourceUser, result.peer_user());
+    builder->AddString(utils::AttributeName::kSourcePrincipal,
+                       result.peer_user());
+    std::string source_ns;
+    if (utils::GetSourceNamespace(result.peer_user(), &source_ns) &&
+        !source_ns.empty()) {
+      builder->AddString(utils::AttributeName::kSourceNamespace, source_ns);
+    }
+  }
+  if (result.has_origin()) {
+    const auto &origin = result.origin();
+    if (!origin.audiences().empty() && !origin.audiences(0).empty()) {
+      builder->AddString(utils::AttributeName::kRequestAuthAudiences,
+                         origin.audiences(0));
+    }
+    if (!origin.presenter().empty()) {
+      builder->AddString(utils::AttributeName::kRequestAuthPresenter,
+                         origin.presenter());
+    }
+    if (!origin.claims().fields().empty()) {
+      builder->AddProtoStructStringMap(
+          utils::AttributeName::kRequestAuthClaims, origin.claims());
+    }
+    if (!origin.raw_claims().empty()) {
+      builder->AddString(utils::AttributeName::kRequestAuthRawClaims,
+                         origin.raw_claims());
+    }
+  }
+}
+
 }  // namespace
 
 void AttributesBuilder::ExtractRequestHeaderAttributes(CheckData *check_data) {
   utils::AttributesBuilder builder(attributes_);
-  std::map<std::string, std::string> headers = check_data->GetRequestHeaders();
+  std::map<std::string, std::string> headers =
+      header_selection_ && !header_selection_->request_headers.empty()
+          ? check_data->GetRequestHeaders(header_selection_->request_headers)
+          : check_data->GetRequestHeaders();
   builder.AddStringMap(utils::AttributeName::kRequestHeaders, headers);
 
   struct TopLevelAttr {
@@ -87,6 +130,12 @@ void AttributesBuilder::ExtractAuthAttributes(CheckData *check_data) {
     builder.AddString(utils::AttributeName::kDestinationPrincipal,
                       destination_principal);
   }
+  const auto *authn_result_proto = check_data->GetAuthenticationResultProto();
+  if (authn_result_proto != nullptr) {
+    AddAuthenticationResult(*authn_result_proto, &builder);
+    return;
+  }
+
   static const std::set<std::string> kAuthenticationStringAttributes = {
       utils::AttributeName::kRequestAuthPrincipal,
       utils::AttributeName::kSourceUser,
@@ -223,7 +272,9 @@ void AttributesBuilder::ExtractReportAttributes(
   }
 
   std::map<std::string, std::string> headers =
-      report_data->GetResponseHeaders();
+      header_selection_ && !header_selection_->response_headers.empty()
+          ? report_data->GetResponseHeaders(header_selection_->response_headers)
+          : report_data->GetResponseHeaders();
   builder.AddStringMap(utils::AttributeName::kResponseHeaders, headers);
 
   std::map<std::string, std::string> tracing_headers;
@@ -17,6 +17,7 @@
 #define ISTIO_CONTROL_HTTP_ATTRIBUTES_BUILDER_H
 
 #include "include/istio/control/http/check_data.h"
+#include "include/istio/control/http/controller.h"
 #include "include/istio/control/http/report_data.h"
 #include "mixer/v1/attributes.pb.h"
 
@@ -27,8 +28,11 @@ namespace http {
 // The context for each HTTP request.
 class AttributesBuilder {
  public:
-  AttributesBuilder(istio::mixer::v1::Attributes* attributes)
-      : attributes_(attributes) {}
+  // If header_selection is nullptr, all the headers are extracted.
+  AttributesBuilder(
+      istio::mixer::v1::Attributes* attributes,
+      const Controller::HeaderSelection* header_selection = nullptr)
+      : attributes_(attributes), header_selection_(header_selection) {}
 
   // Extract forwarded attributes from HTTP header.
   void ExtractForwardedAttributes(CheckData* check_data);
@@ -55,6 +59,7 @@ class AttributesBuilder {
   void ExtractAuthAttributes(CheckData* check_data);
 
   istio::mixer::v1::Attributes* attributes_;
+  const Controller::HeaderSelection* header_selection_;
 };
 
 }  // namespace http
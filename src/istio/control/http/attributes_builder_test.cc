@@ -547,6 +547,62 @@ fields {
 }
 )";
 
+// The same authentication result as kAuthenticationResultStruct.
+constexpr char kAuthenticationResultProto[] = R"(
+principal: "thisisiss/thisissub"
+peer_user: "sa/test_user/ns/ns_ns/"
+origin {
+  user: "thisisiss/thisissub"
+  audiences: "thisisaud"
+  presenter: "thisisazp"
+  claims {
+    fields {
+      key: "iss"
+      value {
+        string_value: "thisisiss"
+      }
+    }
+    fields {
+      key: "sub"
+      value {
+        string_value: "thisissub"
+      }
+    }
+    fields {
+      key: "aud"
+      value {
+        string_value: "thisisaud"
+      }
+    }
+    fields {
+      key: "azp"
+      value {
+        string_value: "thisisazp"
+      }
+    }
+    fields {
+      key: "email"
+      value {
+        string_value: "thisisemail@email.com"
+      }
+    }
+    fields {
+      key: "iat"
+      value {
+        string_value: "1512754205"
+      }
+    }
+    fields {
+      key: "exp"
+      value {
+        string_value: "5112754205"
+      }
+    }
+  }
+  raw_claims: "test_raw_claims"
+}
+)";
+
 void ClearContextTime(const std::string &name,
                       istio::mixer::v1::Attributes *attributes) {
   // Override timestamp with -
@@ -561,6 +617,73 @@ void SetDestinationIp(istio::mixer::v1::Attributes *attributes,
   builder.AddBytes(utils::AttributeName::kDestinationIp, ip);
 }
 
+// A request or response with num_headers headers named header-0,
+// header-1 and so on.
+std::map<std::string, std::string> MakeHeaders(int num_headers) {
+  std::map<std::string, std::string> headers;
+  for (int i = 0; i < num_headers; i++) {
+    headers["header-" + std::to_string(i)] = std::string(32, 'a' + i % 26);
+  }
+  return headers;
+}
+
+std::map<std::string, std::string> SelectHeaders(
+    const std::map<std::string, std::string> &headers,
+    const std::set<std::string> &names) {
+  std::map<std::string, std::string> selected;
+  for (const auto &name : names) {
+    const auto it = headers.find(name);
+    if (it != headers.end()) {
+      selected.insert(*it);
+    }
+  }
+  return selected;
+}
+
+Attributes ExtractCheckAttributes(
+    const std::map<std::string, std::string> &headers,
+    const Controller::HeaderSelection *header_selection) {
+  ::testing::NiceMock<MockCheckData> mock_data;
+  ON_CALL(mock_data, GetRequestHeaders())
+      .WillByDefault(testing::Return(headers));
+  ON_CALL(mock_data, GetRequestHeaders(_))
+      .WillByDefault(Invoke([&headers](const std::set<std::string> &names) {
+        return SelectHeaders(headers, names);
+      }));
+  Attributes attributes;
+  AttributesBuilder builder(&attributes, header_selection);
+  builder.ExtractCheckAttributes(&mock_data);
+  ClearContextTime(utils::AttributeName::kRequestTime, &attributes);
+  return attributes;
+}
+
+Attributes ExtractReportAttributes(
+    const std::map<std::string, std::string> &headers,
+    const Controller::HeaderSelection *header_selection) {
+  ::testing::NiceMock<MockReportData> mock_data;
+  ::google::protobuf::Map<std::string, ::google::protobuf::Struct>
+      filter_metadata;
+  ON_CALL(mock_data, GetResponseHeaders())
+      .WillByDefault(testing::Return(headers));
+  ON_CALL(mock_data, GetResponseHeaders(_))
+      .WillByDefault(Invoke([&headers](const std::set<std::string> &names) {
+        return SelectHeaders(headers, names);
+      }));
+  ON_CALL(mock_data, GetDynamicFilterState())
+      .WillByDefault(ReturnRef(filter_metadata));
+  ON_CALL(mock_data, GetReportInfo(_))
+      .WillByDefault(Invoke([](ReportData::ReportInfo *info) {
+        *info = ReportData::ReportInfo();
+        info->response_code = 200;
+      }));
+  Attributes attributes;
+  AttributesBuilder builder(&attributes, header_selection);
+  builder.ExtractReportAttributes(::google::protobuf::util::Status::OK,
+                                  &mock_data);
+  ClearContextTime(utils::AttributeName::kResponseTime, &attributes);
+  return attributes;
+}
+
 TEST(AttributesBuilderTest, TestExtractForwardedAttributes) {
   Attributes attr;
   (*attr.mutable_attributes())["source.uid"].set_string_value("test_value");
@@ -641,6 +764,8 @@ TEST(AttributesBuilderTest, TestCheckAttributesWithoutAuthnFilter) {
             }
             return false;
           }));
+  EXPECT_CALL(mock_data, GetAuthenticationResultProto())
+      .WillOnce(testing::Return(nullptr));
   EXPECT_CALL(mock_data, GetAuthenticationResult())
       .WillOnce(testing::Return(nullptr));
 
@@ -716,6 +841,8 @@ TEST(AttributesBuilderTest, TestCheckAttributes) {
   ASSERT_TRUE(
       TextFormat::ParseFromString(kAuthenticationResultStruct, &authn_result));
 
+  EXPECT_CALL(mock_data, GetAuthenticationResultProto())
+      .WillOnce(testing::Return(nullptr));
   EXPECT_CALL(mock_data, GetAuthenticationResult())
       .WillOnce(testing::Return(&authn_result));
   EXPECT_CALL(mock_data, GetUrlPath(_))
@@ -742,6 +869,38 @@ TEST(AttributesBuilderTest, TestCheckAttributes) {
   EXPECT_THAT(attributes, EqualsAttribute(expected_attributes));
 }
 
+TEST(AttributesBuilderTest, TestCheckAttributesWithAuthenticationResultProto) {
+  google::protobuf::Struct authn_result_struct;
+  ASSERT_TRUE(TextFormat::ParseFromString(kAuthenticationResultStruct,
+                                          &authn_result_struct));
+  ::testing::NiceMock<MockCheckData> struct_data;
+  EXPECT_CALL(struct_data, GetAuthenticationResult())
+      .WillOnce(testing::Return(&authn_result_struct));
+  istio::mixer::v1::Attributes expected_attributes;
+  AttributesBuilder struct_builder(&expected_attributes);
+  struct_builder.ExtractCheckAttributes(&struct_data);
+  ClearContextTime(utils::AttributeName::kRequestTime, &expected_attributes);
+
+  ::istio::authn::Result authn_result;
+  ASSERT_TRUE(
+      TextFormat::ParseFromString(kAuthenticationResultProto, &authn_result));
+  ::testing::NiceMock<MockCheckData> mock_data;
+  EXPECT_CALL(mock_data, GetAuthenticationResultProto())
+      .WillOnce(testing::Return(&authn_result));
+  // The dynamic metadata is not read when the result is shared.
+  EXPECT_CALL(mock_data, GetAuthenticationResult()).Times(0);
+  istio::mixer::v1::Attributes attributes;
+  AttributesBuilder builder(&attributes);
+  builder.ExtractCheckAttributes(&mock_data);
+  ClearContextTime(utils::AttributeName::kRequestTime, &attributes);
+
+  EXPECT_THAT(attributes, EqualsAttribute(expected_attributes));
+  EXPECT_EQ(attributes.attributes()
+                .at(utils::AttributeName::kSourceNamespace)
+                .string_value(),
+            "ns_ns");
+}
+
 TEST(AttributesBuilderTest, TestReportAttributes) {
   ::testing::StrictMock<MockReportData> mock_data;
 
@@ -904,6 +1063,51 @@ TEST(AttributesBuilderTest, TestReportAttributesWithDestIP) {
   EXPECT_THAT(attributes, EqualsAttribute(expected_attributes));
 }
 
+TEST(AttributesBuilderTest, TestCheckAttributesWithSelectedHeaders) {
+  const auto headers = MakeHeaders(30);
+  const Attributes all = ExtractCheckAttributes(headers, nullptr);
+  // An empty selection keeps all the headers.
+  Controller::HeaderSelection header_selection;
+  EXPECT_THAT(ExtractCheckAttributes(headers, &header_selection),
+              EqualsAttribute(all));
+
+  header_selection.request_headers = {"header-3", "header-7", "missing"};
+  const Attributes selected =
+      ExtractCheckAttributes(headers, &header_selection);
+
+  // Only request.headers differs, and only has the selected headers.
+  Attributes expected = all;
+  auto *entries = (*expected.mutable_attributes())
+                      [utils::AttributeName::kRequestHeaders]
+                          .mutable_string_map_value()
+                          ->mutable_entries();
+  entries->clear();
+  (*entries)["header-3"] = headers.at("header-3");
+  (*entries)["header-7"] = headers.at("header-7");
+  EXPECT_THAT(selected, EqualsAttribute(expected));
+  EXPECT_LT(selected.ByteSizeLong() * 3, all.ByteSizeLong());
+}
+
+TEST(AttributesBuilderTest, TestReportAttributesWithSelectedHeaders) {
+  const auto headers = MakeHeaders(30);
+  const Attributes all = ExtractReportAttributes(headers, nullptr);
+
+  Controller::HeaderSelection header_selection;
+  header_selection.response_headers = {"header-0"};
+  const Attributes selected =
+      ExtractReportAttributes(headers, &header_selection);
+
+  Attributes expected = all;
+  auto *entries = (*expected.mutable_attributes())
+                      [utils::AttributeName::kResponseHeaders]
+                          .mutable_string_map_value()
+                          ->mutable_entries();
+  entries->clear();
+  (*entries)["header-0"] = headers.at("header-0");
+  EXPECT_THAT(selected, EqualsAttribute(expected));
+  EXPECT_LT(selected.ByteSizeLong() * 3, all.ByteSizeLong());
+}
+
 }  // namespace
 }  // namespace http
 }  // namespace control
@@ -29,18 +29,22 @@ ClientContext::ClientContext(const Controller::Options& data)
     : ClientContextBase(
           data.config.transport(), data.env,
           ::istio::utils::IsOutbound(data.config.mixer_attributes()),
-          data.local_node),
+          data.local_node, data.check_cache_refresh_ahead_ms,
+          data.check_cache_max_stale_ms),
       config_(data.config),
-      service_config_cache_size_(data.service_config_cache_size) {}
+      service_config_cache_size_(data.service_config_cache_size),
+      header_selection_(data.header_selection) {}
 
 ClientContext::ClientContext(
     std::unique_ptr<::istio::mixerclient::MixerClient> mixer_client,
     const ::istio::mixer::v1::config::client::HttpClientConfig& config,
     int service_config_cache_size,
-    ::istio::utils::LocalAttributes& local_attributes, bool outbound)
+    ::istio::utils::LocalAttributes& local_attributes, bool outbound,
+    const Controller::HeaderSelection& header_selection)
     : ClientContextBase(std::move(mixer_client), outbound, local_attributes),
       config_(config),
-      service_config_cache_size_(service_config_cache_size) {}
+      service_config_cache_size_(service_config_cache_size),
+      header_selection_(header_selection) {}
 
 const std::string& ClientContext::GetServiceName(
     const std::string& service_name) const {
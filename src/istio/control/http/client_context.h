@@ -36,7 +36,9 @@ class ClientContext : public ClientContextBase {
       std::unique_ptr<::istio::mixerclient::MixerClient> mixer_client,
       const ::istio::mixer::v1::config::client::HttpClientConfig& config,
       int service_config_cache_size,
-      ::istio::utils::LocalAttributes& local_attributes, bool outbound);
+      ::istio::utils::LocalAttributes& local_attributes, bool outbound,
+      const Controller::HeaderSelection& header_selection =
+          Controller::HeaderSelection());
 
   // Retrieve mixer client config.
   const ::istio::mixer::v1::config::client::HttpClientConfig& config() const {
@@ -55,12 +57,19 @@ class ClientContext : public ClientContextBase {
   // Get the service config cache size
   int service_config_cache_size() const { return service_config_cache_size_; }
 
+  // The headers sent in the request.headers and response.headers attributes.
+  const Controller::HeaderSelection& header_selection() const {
+    return header_selection_;
+  }
+
  private:
   // The http client config.
   const ::istio::mixer::v1::config::client::HttpClientConfig& config_;
 
   // The service config cache size
   int service_config_cache_size_;
+
+  const Controller::HeaderSelection header_selection_;
 };
 
 }  // namespace http
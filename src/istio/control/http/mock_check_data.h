@@ -32,6 +32,8 @@ class MockCheckData : public CheckData {
   MOCK_CONST_METHOD2(GetSourceIpPort, bool(std::string *ip, int *port));
   MOCK_CONST_METHOD2(GetPrincipal, bool(bool peer, std::string *user));
   MOCK_CONST_METHOD0(GetRequestHeaders, std::map<std::string, std::string>());
+  MOCK_CONST_METHOD1(GetRequestHeaders, std::map<std::string, std::string>(
+                                            const std::set<std::string> &));
   MOCK_CONST_METHOD2(FindHeaderByType,
                      bool(HeaderType header_type, std::string *value));
   MOCK_CONST_METHOD2(FindHeaderByName,
@@ -44,6 +46,8 @@ class MockCheckData : public CheckData {
                      bool(std::map<std::string, std::string> *payload));
   MOCK_CONST_METHOD0(GetAuthenticationResult,
                      const ::google::protobuf::Struct *());
+  MOCK_CONST_METHOD0(GetAuthenticationResultProto,
+                     const ::istio::authn::Result *());
   MOCK_CONST_METHOD0(IsMutualTLS, bool());
   MOCK_CONST_METHOD1(GetRequestedServerName, bool(std::string *name));
   MOCK_CONST_METHOD1(GetUrlPath, bool(std::string *));
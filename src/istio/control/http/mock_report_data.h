@@ -27,6 +27,8 @@ namespace http {
 class MockReportData : public ReportData {
  public:
   MOCK_CONST_METHOD0(GetResponseHeaders, std::map<std::string, std::string>());
+  MOCK_CONST_METHOD1(GetResponseHeaders, std::map<std::string, std::string>(
+                                             const std::set<std::string> &));
   MOCK_CONST_METHOD1(GetTracingHeaders,
                      void(std::map<std::string, std::string> &));
   MOCK_CONST_METHOD1(GetReportInfo, void(ReportInfo *info));
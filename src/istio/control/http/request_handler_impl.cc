@@ -59,7 +59,9 @@ void RequestHandlerImpl::AddCheckAttributes(CheckData* check_data) {
       service_context_->enable_mixer_report()) {
     service_context_->AddStaticAttributes(attributes_->attributes());
 
-    AttributesBuilder builder(attributes_->attributes());
+    AttributesBuilder builder(
+        attributes_->attributes(),
+        &service_context_->client_context()->header_selection());
     builder.ExtractCheckAttributes(check_data);
   }
 }
@@ -107,10 +109,15 @@ void RequestHandlerImpl::Report(CheckData* check_data,
     return;
   }
 
-  AddForwardAttributes(check_data);
-  AddCheckAttributes(check_data);
+  // After a Check() call, the check attributes are already extracted.
+  if (check_data != nullptr) {
+    AddForwardAttributes(check_data);
+    AddCheckAttributes(check_data);
+  }
 
-  AttributesBuilder builder(attributes_->attributes());
+  AttributesBuilder builder(
+      attributes_->attributes(),
+      &service_context_->client_context()->header_selection());
   builder.ExtractReportAttributes(check_context_->status(), report_data);
 
   service_context_->client_context()->SendReport(attributes_);
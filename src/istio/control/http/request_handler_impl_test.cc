@@ -451,6 +451,48 @@ TEST_F(RequestHandlerImplTest, TestHandlerReport) {
   handler->Report(&mock_check, &mock_report);
 }
 
+TEST_F(RequestHandlerImplTest, TestHandlerReportAfterCheck) {
+  ::testing::NiceMock<MockCheckData> mock_check;
+  ::testing::NiceMock<MockHeaderUpdate> mock_header;
+  ::testing::NiceMock<MockReportData> mock_report;
+  ::google::protobuf::Map<std::string, ::google::protobuf::Struct>
+      filter_metadata;
+  EXPECT_CALL(mock_check, GetSourceIpPort(_, _))
+      .Times(1)
+      .WillOnce(Invoke([](std::string *ip, int *port) -> bool {
+        *ip = "1.2.3.4";
+        *port = 8080;
+        return true;
+      }));
+  EXPECT_CALL(mock_report, GetResponseHeaders()).Times(1);
+  EXPECT_CALL(mock_report, GetReportInfo(_)).Times(1);
+  EXPECT_CALL(mock_report, GetDynamicFilterState())
+      .Times(1)
+      .WillOnce(ReturnRef(filter_metadata));
+
+  EXPECT_CALL(*mock_client_, Check(_, _, _)).Times(1);
+  // Report should be called with the attributes extracted by Check.
+  EXPECT_CALL(*mock_client_, Report(_))
+      .Times(1)
+      .WillOnce(Invoke(
+          [](const istio::mixerclient::SharedAttributesSharedPtr &attributes) {
+            const auto &map = attributes->attributes()->attributes();
+            ASSERT_TRUE(map.find(utils::AttributeName::kOriginIp) !=
+                        map.end());
+            EXPECT_EQ(map.at(utils::AttributeName::kOriginIp).bytes_value(),
+                      "1.2.3.4");
+          }));
+
+  ServiceConfig config;
+  Controller::PerRouteConfig per_route;
+  ApplyPerRouteConfig(config, &per_route);
+
+  auto handler = controller_->CreateRequestHandler(per_route);
+  handler->Check(&mock_check, &mock_header, nullptr, nullptr);
+  // The check data is not read again.
+  handler->Report(nullptr, &mock_report);
+}
+
 TEST_F(RequestHandlerImplTest, TestHandlerDisabledReport) {
   ::testing::NiceMock<MockCheckData> mock_check;
   ::testing::NiceMock<MockReportData> mock_report;
@@ -34,7 +34,8 @@ class ClientContext : public ClientContextBase {
       : ClientContextBase(
             data.config.transport(), data.env,
             ::istio::utils::IsOutbound(data.config.mixer_attributes()),
-            data.local_node),
+            data.local_node, data.check_cache_refresh_ahead_ms,
+            data.check_cache_max_stale_ms),
         config_(data.config) {
     BuildQuotaParser();
   }
@@ -29,8 +29,10 @@ namespace mixerclient {
 
 void CheckCache::CacheElem::CacheElem::SetResponse(
     const CheckResponse &response, Tick time_now) {
+  // Requests holding the previous result keep it unchanged.
+  auto result = std::make_shared<CachedResult>();
   if (response.has_precondition()) {
-    status_ = parent_.ConvertRpcStatus(response.precondition().status());
+    result->status = parent_.ConvertRpcStatus(response.precondition().status());
 
     if (response.precondition().has_valid_duration()) {
       expire_time_ = time_now + utils::ToMilliseonds(
@@ -40,31 +42,49 @@ void CheckCache::CacheElem::CacheElem::SetResponse(
       expire_time_ = time_point<system_clock>::max();
     }
     use_count_ = response.precondition().valid_use_count();
-    route_directive_ = response.precondition().route_directive();
+    result->route_directive = response.precondition().route_directive();
   } else {
-    status_ = Status(Code::INVALID_ARGUMENT,
-                     "CheckResponse doesn't have PreconditionResult");
+    result->status = Status(Code::INVALID_ARGUMENT,
+                            "CheckResponse doesn't have PreconditionResult");
     use_count_ = 0;           // 0 for not used this cache.
     expire_time_ = time_now;  // expired now.
   }
+  result_ = std::move(result);
+  refreshing_ = false;
 }
 
 // check if the item is expired.
 bool CheckCache::CacheElem::CacheElem::IsExpired(Tick time_now) {
-  if (time_now > expire_time_ || use_count_ == 0) {
+  if (use_count_ == 0) {
     return true;
   }
+  if (time_now > expire_time_) {
+    // If the refresh fails or never completes, the item expires max_stale_ms
+    // later and the next request makes a remote check.
+    const milliseconds max_stale(parent_.options_.max_stale_ms);
+    if (!refreshing_ || time_now > expire_time_ + max_stale) {
+      return true;
+    }
+  }
   if (use_count_ > 0) {
     --use_count_;
   }
   return false;
 }
 
+bool CheckCache::CacheElem::CacheElem::NeedsRefresh(Tick time_now) {
+  const milliseconds refresh_ahead(parent_.options_.refresh_ahead_ms);
+  if (refresh_ahead.count() == 0 || refreshing_ ||
+      time_now < expire_time_ - refresh_ahead) {
+    return false;
+  }
+  refreshing_ = true;
+  return true;
+}
+
 CheckCache::CheckResult::CheckResult() : status_(Code::UNAVAILABLE, "") {}
 
-bool CheckCache::CheckResult::IsCacheHit() const {
-  return status_.error_code() != Code::UNAVAILABLE;
-}
+bool CheckCache::CheckResult::IsCacheHit() const { return result_ != nullptr; }
 
 CheckCache::CheckCache(const CheckOptions &options) : options_(options) {
   if (options.num_entries > 0) {
@@ -78,32 +98,46 @@ CheckCache::~CheckCache() {
 }
 
 void CheckCache::Check(const Attributes &attributes, CheckResult *result) {
-  Status status = Check(attributes, system_clock::now(), result);
-  if (status.error_code() != Code::NOT_FOUND) {
-    result->status_ = status;
-  }
+  // A hit only references the cached result.
+  result->result_ = Lookup(attributes, system_clock::now(), result);
 
-  result->on_response_ = [this](const Status &status,
-                                const Attributes &attributes,
-                                const CheckResponse &response) -> Status {
+  result->on_response_ =
+      [this](const Status &status, const Attributes &attributes,
+             const CheckResponse &response) -> CachedResultConstSharedPtr {
     if (!status.ok()) {
       if (options_.network_fail_open) {
-        return Status::OK;
+        return MakeResult(Status::OK, response);
       } else {
-        return status;
+        return MakeResult(status, response);
       }
     } else {
-      return CacheResponse(attributes, response, system_clock::now());
+      return CacheResult(attributes, response, system_clock::now());
     }
   };
 }
 
 Status CheckCache::Check(const Attributes &attributes, Tick time_now,
                          CheckResult *result) {
-  if (!cache_) {
-    // By returning NOT_FOUND, caller will send request to server.
+  CachedResultConstSharedPtr cached = Lookup(attributes, time_now, result);
+  if (!cached) {
     return Status(Code::NOT_FOUND, "");
   }
+  if (result) {
+    result->result_ = cached;
+  }
+  return cached->status;
+}
+
+CheckCache::CachedResultConstSharedPtr CheckCache::Lookup(
+    const Attributes &attributes, Tick time_now, CheckResult *result) {
+  if (result) {
+    result->has_signature_ = false;
+    result->refresh_ = false;
+  }
+  if (!cache_) {
+    // By returning nullptr, caller will send request to server.
+    return nullptr;
+  }
 
   std::lock_guard<std::mutex> lock(cache_mutex_);
   for (const auto &it : referenced_map_) {
@@ -112,32 +146,57 @@ Status CheckCache::Check(const Attributes &attributes, Tick time_now,
     if (!reference.Signature(attributes, "", &signature)) {
       continue;
     }
+    if (result && !result->has_signature_) {
+      result->has_signature_ = true;
+      result->signature_ = signature;
+    }
 
     CheckLRUCache::ScopedLookup lookup(cache_.get(), signature);
     if (lookup.Found()) {
       CacheElem *elem = lookup.value();
       if (elem->IsExpired(time_now)) {
         cache_->Remove(signature);
-        return Status(Code::NOT_FOUND, "");
+        if (result) {
+          result->signature_ = signature;
+        }
+        return nullptr;
       }
       if (result) {
-        result->route_directive_ = elem->route_directive();
+        result->refresh_ = elem->NeedsRefresh(time_now);
       }
-      return elem->status();
+      return elem->result();
     }
   }
 
-  return Status(Code::NOT_FOUND, "");
+  return nullptr;
 }
 
 Status CheckCache::CacheResponse(const Attributes &attributes,
                                  const CheckResponse &response, Tick time_now) {
+  return CacheResult(attributes, response, time_now)->status;
+}
+
+CheckCache::CachedResultConstSharedPtr CheckCache::MakeResult(
+    const Status &status, const CheckResponse &response) const {
+  auto result = std::make_shared<CachedResult>();
+  result->status = status;
+  if (response.has_precondition()) {
+    result->route_directive = response.precondition().route_directive();
+  }
+  return result;
+}
+
+CheckCache::CachedResultConstSharedPtr CheckCache::CacheResult(
+    const Attributes &attributes, const CheckResponse &response,
+    Tick time_now) {
   if (!cache_ || !response.has_precondition()) {
     if (response.has_precondition()) {
-      return ConvertRpcStatus(response.precondition().status());
+      return MakeResult(ConvertRpcStatus(response.precondition().status()),
+                        response);
     } else {
-      return Status(Code::INVALID_ARGUMENT,
-                    "CheckResponse doesn't have PreconditionResult");
+      return MakeResult(Status(Code::INVALID_ARGUMENT,
+                               "CheckResponse doesn't have PreconditionResult"),
+                        response);
     }
   }
 
@@ -145,7 +204,8 @@ Status CheckCache::CacheResponse(const Attributes &attributes,
   if (!referenced.Fill(attributes,
                        response.precondition().referenced_attributes())) {
     // Failed to decode referenced_attributes, not to cache this result.
-    return ConvertRpcStatus(response.precondition().status());
+    return MakeResult(ConvertRpcStatus(response.precondition().status()),
+                      response);
   }
   utils::HashType signature;
   if (!referenced.Signature(attributes, "", &signature)) {
@@ -153,7 +213,8 @@ Status CheckCache::CacheResponse(const Attributes &attributes,
         "Response referenced does not match request.  Request attributes: "
         "%s.  Referenced attributes: %s",
         attributes.DebugString().c_str(), referenced.DebugString().c_str());
-    return ConvertRpcStatus(response.precondition().status());
+    return MakeResult(ConvertRpcStatus(response.precondition().status()),
+                      response);
   }
 
   std::lock_guard<std::mutex> lock(cache_mutex_);
@@ -167,12 +228,12 @@ Status CheckCache::CacheResponse(const Attributes &attributes,
   CheckLRUCache::ScopedLookup lookup(cache_.get(), signature);
   if (lookup.Found()) {
     lookup.value()->SetResponse(response, time_now);
-    return lookup.value()->status();
+    return lookup.value()->result();
   }
 
   CacheElem *cache_elem = new CacheElem(*this, response, time_now);
   cache_->Insert(signature, cache_elem, 1);
-  return cache_elem->status();
+  return cache_elem->result();
 }
 
 // Flush out aggregated check requests, clear all cache items.
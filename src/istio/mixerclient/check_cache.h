@@ -19,6 +19,7 @@
 #define ISTIO_MIXERCLIENT_CHECK_CACHE_H
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -41,6 +42,15 @@ class CheckCache {
 
   virtual ~CheckCache();
 
+  // The converted status and route directive of a check response. It is
+  // built once per response and shared, never modified, by the cache item
+  // and the requests that hit it.
+  struct CachedResult {
+    ::google::protobuf::util::Status status;
+    ::istio::mixer::v1::RouteDirective route_directive;
+  };
+  using CachedResultConstSharedPtr = std::shared_ptr<const CachedResult>;
+
   // A check cache result for a request. Its usage
   //   cache->Check(attributes, result);
   //   if (result->IsCacheHit()) return result->Status();
@@ -53,33 +63,58 @@ class CheckCache {
 
     bool IsCacheHit() const;
 
-    const ::google::protobuf::util::Status& status() const { return status_; }
+    // True if the caller should refresh the cache hit with a remote check in
+    // the background, passing the response to SetResponse().
+    bool NeedsRefresh() const { return refresh_; }
+
+    const ::google::protobuf::util::Status& status() const {
+      return result_ ? result_->status : status_;
+    }
 
     const ::istio::mixer::v1::RouteDirective& route_directive() const {
-      return route_directive_;
+      return result_ ? result_->route_directive
+                     : ::istio::mixer::v1::RouteDirective::default_instance();
     }
 
+    // The shared result status() and route_directive() refer to, or nullptr.
+    const CachedResultConstSharedPtr& result() const { return result_; }
+
     void SetResponse(const ::google::protobuf::util::Status& status,
                      const ::istio::mixer::v1::Attributes& attributes,
                      const ::istio::mixer::v1::CheckResponse& response) {
       if (on_response_) {
-        status_ = on_response_(status, attributes, response);
+        result_ = on_response_(status, attributes, response);
       }
-      if (response.has_precondition()) {
-        route_directive_ = response.precondition().route_directive();
+    }
+
+    // On a cache miss, returns true and sets the signature the response would
+    // be cached under, if referenced attributes from previous responses
+    // apply to the request. Misses with the same signature would get the
+    // same cached result.
+    bool signature(utils::HashType* signature) const {
+      if (has_signature_) {
+        *signature = signature_;
       }
+      return has_signature_;
     }
 
    private:
     friend class CheckCache;
-    // Check status.
+    // Check status until there is a result.
     ::google::protobuf::util::Status status_;
 
-    // Route directive
-    ::istio::mixer::v1::RouteDirective route_directive_;
+    // The signature of a missed request, see signature().
+    bool has_signature_{false};
+    utils::HashType signature_{0};
+
+    // The cache hit is close to expiration, see NeedsRefresh().
+    bool refresh_{false};
+
+    // The result from the cache or the check response.
+    CachedResultConstSharedPtr result_;
 
     // The function to set check response.
-    using OnResponseFunc = std::function<::google::protobuf::util::Status(
+    using OnResponseFunc = std::function<CachedResultConstSharedPtr(
         const ::google::protobuf::util::Status&,
         const ::istio::mixer::v1::Attributes& attributes,
         const ::istio::mixer::v1::CheckResponse&)>;
@@ -99,12 +134,29 @@ class CheckCache {
       const ::istio::mixer::v1::Attributes& request, Tick time_now,
       CheckResult* result);
 
+  // Returns the cached result for the request, or nullptr if the caller
+  // has to send the request to mixer. On a miss, the signature of the
+  // request is recorded in result if not nullptr.
+  CachedResultConstSharedPtr Lookup(
+      const ::istio::mixer::v1::Attributes& request, Tick time_now,
+      CheckResult* result);
+
   // Caches a response from a remote mixer call.
   // Return the converted status from response.
   ::google::protobuf::util::Status CacheResponse(
       const ::istio::mixer::v1::Attributes& attributes,
       const ::istio::mixer::v1::CheckResponse& response, Tick time_now);
 
+  // Caches a response from a remote mixer call and returns its result.
+  CachedResultConstSharedPtr CacheResult(
+      const ::istio::mixer::v1::Attributes& attributes,
+      const ::istio::mixer::v1::CheckResponse& response, Tick time_now);
+
+  // Builds a result that is not cached.
+  CachedResultConstSharedPtr MakeResult(
+      const ::google::protobuf::util::Status& status,
+      const ::istio::mixer::v1::CheckResponse& response) const;
+
   // Flushes out all cached check responses; clears all cache items.
   // Usually called at destructor.
   ::google::protobuf::util::Status FlushAll();
@@ -128,27 +180,27 @@ class CheckCache {
     // Check if the item is expired.
     bool IsExpired(Tick time_now);
 
-    // getter for converted status from response.
-    ::google::protobuf::util::Status status() const { return status_; }
+    // Returns true for the first hit close to expiration, which should
+    // refresh the item in the background.
+    bool NeedsRefresh(Tick time_now);
 
-    // getter for the route directive
-    ::istio::mixer::v1::RouteDirective route_directive() const {
-      return route_directive_;
-    }
+    // getter for the result of the last check request.
+    const CachedResultConstSharedPtr& result() const { return result_; }
 
    private:
     // To the parent cache object.
     const CheckCache& parent_;
-    // The check status for the last check request.
-    ::google::protobuf::util::Status status_;
-    // Route directive
-    ::istio::mixer::v1::RouteDirective route_directive_;
+    // The converted status and route directive of the last check request.
+    CachedResultConstSharedPtr result_;
     // Cache item should not be used after it is expired.
     std::chrono::time_point<std::chrono::system_clock> expire_time_;
     // if -1, not to check use_count.
     // if 0, cache item should not be used.
     // use_count is decreased by 1 for each request,
     int use_count_;
+    // A background refresh is in flight, the item may be used for up to
+    // max_stale_ms after it is expired.
+    bool refreshing_{false};
   };
 
   // Key is the signature of the Attributes. Value is the CacheElem.
@@ -20,6 +20,7 @@
 #include "include/istio/utils/attributes_builder.h"
 #include "include/istio/utils/protobuf.h"
 #include "src/istio/mixerclient/status_test_util.h"
+#include "src/istio/utils/allocation_counter.h"
 
 using namespace std::chrono;
 using ::google::protobuf::util::Status;
@@ -63,12 +64,72 @@ class CheckCacheTest : public ::testing::Test {
   Status Check(const Attributes& request, time_point<system_clock> time_now) {
     return cache_->Check(request, time_now, nullptr);
   }
+  // Checks the cache and sets whether a hit should be refreshed.
+  Status Check(const Attributes& request, time_point<system_clock> time_now,
+               bool* refresh) {
+    CheckCache::CheckResult result;
+    Status status = cache_->Check(request, time_now, &result);
+    *refresh = result.NeedsRefresh();
+    return status;
+  }
+
+  // Creates a cache refreshing 1 second ahead of expiration, with up to 500
+  // milliseconds of staleness.
+  void CreateRefreshAheadCache() {
+    CheckOptions options;
+    options.refresh_ahead_ms = 1000;
+    options.max_stale_ms = 500;
+    cache_.reset(new CheckCache(options));
+  }
+
+  // An OK response valid for 10 seconds.
+  CheckResponse ResponseValidFor10s() {
+    CheckResponse response;
+    response.mutable_precondition()->set_valid_use_count(1000);
+    *response.mutable_precondition()->mutable_valid_duration() =
+        utils::CreateDuration(duration_cast<nanoseconds>(seconds(10)));
+    return response;
+  }
+
   Status CacheResponse(const Attributes& attributes,
                        const ::istio::mixer::v1::CheckResponse& response,
                        time_point<system_clock> time_now) {
     return cache_->CacheResponse(attributes, response, time_now);
   }
 
+  // A response with num_operations request header operations.
+  CheckResponse ResponseWithHeaderOperations(int num_operations) {
+    CheckResponse response;
+    response.mutable_precondition()->set_valid_use_count(1000);
+    auto* directive =
+        response.mutable_precondition()->mutable_route_directive();
+    for (int i = 0; i < num_operations; ++i) {
+      auto* operation = directive->add_request_header_operations();
+      operation->set_name("x-header-" + std::to_string(i));
+      operation->set_value(std::string(100, 'v'));
+    }
+    return response;
+  }
+
+  // Returns the allocations made by a cache hit on a response with
+  // num_operations header operations.
+  uint64_t CacheHitAllocations(int num_operations) {
+    cache_.reset(new CheckCache(CheckOptions()));
+    EXPECT_OK(CacheResponse(attributes_,
+                            ResponseWithHeaderOperations(num_operations),
+                            FakeTime(0)));
+
+    CheckCache::CheckResult result;
+    const uint64_t start = utils::AllocationCount();
+    cache_->Check(attributes_, &result);
+    const uint64_t count = utils::AllocationCount() - start;
+
+    EXPECT_TRUE(result.IsCacheHit());
+    EXPECT_EQ(result.route_directive().request_header_operations_size(),
+              num_operations);
+    return count;
+  }
+
   Attributes attributes_;
   std::unique_ptr<CheckCache> cache_;
 };
@@ -127,6 +188,64 @@ TEST_F(CheckCacheTest, TestExpiredByDuration) {
   EXPECT_ERROR_CODE(Code::NOT_FOUND, Check(attributes_, FakeTime(11)));
 }
 
+TEST_F(CheckCacheTest, TestRefreshAhead) {
+  CreateRefreshAheadCache();
+  bool refresh;
+  EXPECT_ERROR_CODE(Code::NOT_FOUND, Check(attributes_, FakeTime(0), &refresh));
+  EXPECT_OK(CacheResponse(attributes_, ResponseValidFor10s(), FakeTime(0)));
+
+  EXPECT_OK(Check(attributes_, FakeTime(8000), &refresh));
+  EXPECT_FALSE(refresh);
+
+  // Only the first hit close to expiration refreshes.
+  EXPECT_OK(Check(attributes_, FakeTime(9000), &refresh));
+  EXPECT_TRUE(refresh);
+  EXPECT_OK(Check(attributes_, FakeTime(9500), &refresh));
+  EXPECT_FALSE(refresh);
+
+  // Used while the refresh is in flight, up to 500 milliseconds stale.
+  EXPECT_OK(Check(attributes_, FakeTime(10400), &refresh));
+  EXPECT_FALSE(refresh);
+  EXPECT_ERROR_CODE(Code::NOT_FOUND,
+                    Check(attributes_, FakeTime(10600), &refresh));
+}
+
+TEST_F(CheckCacheTest, TestRefreshAheadResponse) {
+  CreateRefreshAheadCache();
+  bool refresh;
+  EXPECT_ERROR_CODE(Code::NOT_FOUND, Check(attributes_, FakeTime(0), &refresh));
+  EXPECT_OK(CacheResponse(attributes_, ResponseValidFor10s(), FakeTime(0)));
+
+  EXPECT_OK(Check(attributes_, FakeTime(9500), &refresh));
+  EXPECT_TRUE(refresh);
+
+  // The refreshed response denies, and is refreshed again when it is close
+  // to expiration.
+  CheckResponse deny_response = ResponseValidFor10s();
+  deny_response.mutable_precondition()->mutable_status()->set_code(
+      Code::PERMISSION_DENIED);
+  EXPECT_ERROR_CODE(Code::PERMISSION_DENIED,
+                    CacheResponse(attributes_, deny_response, FakeTime(9600)));
+  EXPECT_ERROR_CODE(Code::PERMISSION_DENIED,
+                    Check(attributes_, FakeTime(11000), &refresh));
+  EXPECT_FALSE(refresh);
+  EXPECT_ERROR_CODE(Code::PERMISSION_DENIED,
+                    Check(attributes_, FakeTime(18700), &refresh));
+  EXPECT_TRUE(refresh);
+}
+
+TEST_F(CheckCacheTest, TestNoStaleWithoutRefresh) {
+  CreateRefreshAheadCache();
+  bool refresh;
+  EXPECT_ERROR_CODE(Code::NOT_FOUND, Check(attributes_, FakeTime(0), &refresh));
+  EXPECT_OK(CacheResponse(attributes_, ResponseValidFor10s(), FakeTime(0)));
+
+  // Without a hit close to expiration, there is no refresh in flight and the
+  // entry expires on time.
+  EXPECT_ERROR_CODE(Code::NOT_FOUND,
+                    Check(attributes_, FakeTime(10100), &refresh));
+}
+
 TEST_F(CheckCacheTest, TestCheckResult) {
   CheckCache::CheckResult result;
   cache_->Check(attributes_, &result);
@@ -149,6 +268,36 @@ TEST_F(CheckCacheTest, TestCheckResult) {
   }
 }
 
+TEST_F(CheckCacheTest, TestCacheHitSharesRouteDirective) {
+  // A hit references the cached route directive instead of copying it, so
+  // its cost does not depend on the size of the directive.
+  EXPECT_EQ(CacheHitAllocations(0), CacheHitAllocations(100));
+}
+
+TEST_F(CheckCacheTest, TestCacheHitKeepsResultAfterUpdate) {
+  EXPECT_OK(CacheResponse(attributes_, ResponseWithHeaderOperations(1),
+                          FakeTime(0)));
+  CheckCache::CheckResult result;
+  cache_->Check(attributes_, &result);
+  EXPECT_TRUE(result.IsCacheHit());
+
+  // A new response for the same request replaces the cached result, the
+  // request that hit the cache keeps the previous one.
+  EXPECT_OK(CacheResponse(attributes_, ResponseWithHeaderOperations(2),
+                          FakeTime(0)));
+  EXPECT_EQ(result.route_directive().request_header_operations_size(), 1);
+
+  CheckCache::CheckResult result2;
+  cache_->Check(attributes_, &result2);
+  EXPECT_EQ(result2.route_directive().request_header_operations_size(), 2);
+  EXPECT_NE(result.result(), result2.result());
+
+  // Hits on the same cached result share it.
+  CheckCache::CheckResult result3;
+  cache_->Check(attributes_, &result3);
+  EXPECT_EQ(result3.result(), result2.result());
+}
+
 TEST_F(CheckCacheTest, TestInvalidResult) {
   CheckCache::CheckResult result;
   cache_->Check(attributes_, &result);
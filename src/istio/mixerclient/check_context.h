@@ -73,6 +73,18 @@ class CheckContext : public CheckResponseInfo {
     policy_cache_hit_ = policy_cache_result_.IsCacheHit();
   }
 
+  // On a policy cache hit, the cached result should be refreshed with a
+  // remote check in the background.
+  bool policyCacheRefreshRequired() const {
+    return policy_cache_result_.NeedsRefresh();
+  }
+
+  // On a policy cache miss, the signature shared by identical checks, if it
+  // is known.
+  bool policyCacheSignature(utils::HashType* signature) const {
+    return policy_cache_result_.signature(signature);
+  }
+
   void updatePolicyCache(const google::protobuf::util::Status& status,
                          const istio::mixer::v1::CheckResponse& response) {
     policy_cache_result_.SetResponse(status, *shared_attributes_->attributes(),
@@ -197,6 +209,10 @@ class CheckContext : public CheckResponseInfo {
     return policy_cache_result_.route_directive();
   }
 
+  std::shared_ptr<const void> routeDirectiveOwner() const override {
+    return policy_cache_result_.result();
+  }
+
  private:
   CheckContext(const CheckContext&) = delete;
   void operator=(const CheckContext&) = delete;
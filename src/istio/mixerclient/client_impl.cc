@@ -96,6 +96,9 @@ void MixerClientImpl::Check(CheckContextSharedPtr &context,
       ++total_check_cache_hit_denies_;
       context->setFinalStatus(context->policyStatus());
       on_done(*context);
+      if (context->policyCacheRefreshRequired()) {
+        RefreshPolicyCache(context, transport);
+      }
       return;
     }
 
@@ -107,12 +110,28 @@ void MixerClientImpl::Check(CheckContextSharedPtr &context,
     if (!context->quotaCheckRequired()) {
       context->setFinalStatus(context->policyStatus());
       on_done(*context);
+      if (context->policyCacheRefreshRequired()) {
+        RefreshPolicyCache(context, transport);
+      }
       return;
     }
   } else {
     ++total_check_cache_misses_;
   }
 
+  //
+  // Identical policy cache misses share the response of one remote check.
+  // Quota is not shared, so checks that require it are sent on their own.
+  //
+  PendingCheckSharedPtr pending;
+  utils::HashType signature;
+  if (!context->policyCacheHit() && !context->quotaCheckRequired() &&
+      context->policyCacheSignature(&signature) &&
+      FollowPendingCheck(signature, context, transport, on_done, &pending)) {
+    MIXER_DEBUG("Policy check follows an identical in-flight check");
+    return;
+  }
+
   bool remote_quota_prefetch{false};
 
   if (context->quotaCheckRequired()) {
@@ -143,6 +162,9 @@ void MixerClientImpl::Check(CheckContextSharedPtr &context,
         on_done(*context);
         remote_quota_prefetch = context->remoteQuotaRequestRequired();
         if (!remote_quota_prefetch) {
+          if (context->policyCacheRefreshRequired()) {
+            RefreshPolicyCache(context, transport);
+          }
           return;
         }
       }
@@ -164,6 +186,10 @@ void MixerClientImpl::Check(CheckContextSharedPtr &context,
 
   if (!context->policyCacheHit()) {
     ++total_remote_check_calls_;
+  } else if (context->policyCacheRefreshRequired()) {
+    // The quota request refreshes the policy cache too.
+    ++total_remote_check_calls_;
+    ++total_remote_check_refresh_calls_;
   }
 
   if (context->remoteQuotaRequestRequired()) {
@@ -175,12 +201,121 @@ void MixerClientImpl::Check(CheckContextSharedPtr &context,
   }
 
   RemoteCheck(context, transport ? transport : options_.env.check_transport,
-              remote_quota_prefetch ? nullptr : on_done);
+              remote_quota_prefetch ? nullptr : on_done, pending);
+}
+
+void MixerClientImpl::SendRemoteCheck(CheckContextSharedPtr &context,
+                                      const TransportCheckFunc &transport,
+                                      const CheckDoneFunc &on_done,
+                                      const PendingCheckSharedPtr &pending) {
+  context->compressRequest(
+      compressor_,
+      deduplication_id_base_ + std::to_string(deduplication_id_.fetch_add(1)));
+  ++total_remote_calls_;
+  ++total_remote_check_calls_;
+  RemoteCheck(context, transport, on_done, pending);
+}
+
+void MixerClientImpl::RefreshPolicyCache(CheckContextSharedPtr &context,
+                                         const TransportCheckFunc &transport) {
+  ++total_remote_check_refresh_calls_;
+  SendRemoteCheck(context, transport ? transport : options_.env.check_transport,
+                  nullptr, nullptr);
+}
+
+bool MixerClientImpl::FollowPendingCheck(utils::HashType signature,
+                                         CheckContextSharedPtr &context,
+                                         const TransportCheckFunc &transport,
+                                         const CheckDoneFunc &on_done,
+                                         PendingCheckSharedPtr *leader) {
+  auto it = pending_checks_.find(signature);
+  if (it == pending_checks_.end()) {
+    *leader = std::make_shared<PendingCheck>();
+    (*leader)->signature = signature;
+    pending_checks_[signature] = *leader;
+    return false;
+  }
+
+  PendingCheckSharedPtr pending = it->second;
+  pending->followers.push_back(
+      {context, transport ? transport : options_.env.check_transport,
+       on_done});
+
+  // A cancelled follower only leaves the in-flight check. Neither capture
+  // owns the follower or the check, which own the context.
+  std::weak_ptr<PendingCheck> weak_pending = pending;
+  CheckContext *follower = context.get();
+  context->setCancel([weak_pending, follower]() {
+    PendingCheckSharedPtr pending = weak_pending.lock();
+    if (!pending) {
+      return;
+    }
+    auto &followers = pending->followers;
+    followers.erase(std::remove_if(followers.begin(), followers.end(),
+                                   [follower](const Follower &f) {
+                                     return f.context.get() == follower;
+                                   }),
+                    followers.end());
+  });
+  return true;
+}
+
+std::vector<MixerClientImpl::Follower> MixerClientImpl::TakeFollowers(
+    const PendingCheckSharedPtr &pending) {
+  auto it = pending_checks_.find(pending->signature);
+  if (it != pending_checks_.end() && it->second == pending) {
+    pending_checks_.erase(it);
+  }
+  std::vector<Follower> followers;
+  followers.swap(pending->followers);
+  return followers;
+}
+
+void MixerClientImpl::CompletePendingCheck(const PendingCheckSharedPtr &pending,
+                                           const Status &status) {
+  const bool success = TransportStatus(status) == TransportResult::SUCCESS;
+  for (auto &follower : TakeFollowers(pending)) {
+    CheckContextSharedPtr &context = follower.context;
+    context->resetCancel();
+
+    if (!success) {
+      // The leader has used up its retries, report its failure.
+      context->updatePolicyCache(status, *context->response());
+      context->setFinalStatus(context->networkFailOpen() ? Status::OK
+                                                         : status);
+      follower.on_done(*context);
+      continue;
+    }
+
+    context->checkPolicyCache(*check_cache_);
+    if (context->policyCacheHit()) {
+      context->setFinalStatus(context->policyStatus());
+      follower.on_done(*context);
+      if (context->policyCacheRefreshRequired()) {
+        RefreshPolicyCache(context, follower.transport);
+      }
+      continue;
+    }
+
+    // The response of the leader is not cached for this request, e.g. it
+    // referenced other attributes or its use count ran out.
+    SendRemoteCheck(context, follower.transport, follower.on_done, nullptr);
+  }
+}
+
+void MixerClientImpl::ReleasePendingCheck(
+    const PendingCheckSharedPtr &pending) {
+  for (auto &follower : TakeFollowers(pending)) {
+    follower.context->resetCancel();
+    SendRemoteCheck(follower.context, follower.transport, follower.on_done,
+                    nullptr);
+  }
 }
 
 void MixerClientImpl::RemoteCheck(CheckContextSharedPtr context,
                                   const TransportCheckFunc &transport,
-                                  const CheckDoneFunc &on_done) {
+                                  const CheckDoneFunc &on_done,
+                                  const PendingCheckSharedPtr &pending) {
   //
   // This lambda and any lambdas it creates for retry will inc the ref count
   // on the CheckContext shared pointer.
@@ -194,7 +329,7 @@ void MixerClientImpl::RemoteCheck(CheckContextSharedPtr context,
   //
   CancelFunc cancel_func = transport(
       context->request(), context->response(),
-      [this, context, transport, on_done](const Status &status) {
+      [this, context, transport, on_done, pending](const Status &status) {
         context->resetCancel();
 
         //
@@ -226,10 +361,18 @@ void MixerClientImpl::RemoteCheck(CheckContextSharedPtr context,
                       context->retryAttempt() + 1, retry_ms,
                       status.ToString().c_str());
 
-          context->retry(retry_ms,
-                         timer_create_([this, context, transport, on_done]() {
-                           RemoteCheck(context, transport, on_done);
-                         }));
+          context->retry(
+              retry_ms,
+              timer_create_([this, context, transport, on_done, pending]() {
+                RemoteCheck(context, transport, on_done, pending);
+              }));
+          if (pending) {
+            // Cancelling the leader while it waits to retry releases the
+            // followers.
+            context->setCancel([this, pending]() {
+              ReleasePendingCheck(pending);
+            });
+          }
 
           return;
         }
@@ -239,7 +382,8 @@ void MixerClientImpl::RemoteCheck(CheckContextSharedPtr context,
         // status, so track those too
         //
 
-        if (!context->policyCacheHit()) {
+        if (!context->policyCacheHit() ||
+            context->policyCacheRefreshRequired()) {
           context->updatePolicyCache(status, *context->response());
 
           if (context->policyStatus().ok()) {
@@ -294,15 +438,22 @@ void MixerClientImpl::RemoteCheck(CheckContextSharedPtr context,
           on_done(*context);
         }
 
+        if (pending) {
+          CompletePendingCheck(pending, status);
+        }
+
         if (utils::InvalidDictionaryStatus(status)) {
           // TODO(jblatt) verify this is threadsafe
           compressor_.ShrinkGlobalDictionary();
         }
       });
 
-  context->setCancel([this, cancel_func]() {
+  context->setCancel([this, cancel_func, pending]() {
     ++total_remote_call_cancellations_;
     cancel_func();
+    if (pending) {
+      ReleasePendingCheck(pending);
+    }
   });
 }
 
@@ -319,6 +470,7 @@ void MixerClientImpl::GetStatistics(Statistics *stat) const {
   stat->total_remote_check_calls_ = total_remote_check_calls_;
   stat->total_remote_check_accepts_ = total_remote_check_accepts_;
   stat->total_remote_check_denies_ = total_remote_check_denies_;
+  stat->total_remote_check_refresh_calls_ = total_remote_check_refresh_calls_;
   stat->total_quota_calls_ = total_quota_calls_;
   stat->total_quota_cache_hits_ = total_quota_cache_hits_;
   stat->total_quota_cache_misses_ = total_quota_cache_misses_;
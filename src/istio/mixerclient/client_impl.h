@@ -17,7 +17,10 @@
 #define ISTIO_MIXERCLIENT_CLIENT_IMPL_H
 
 #include <atomic>
+#include <memory>
 #include <random>
+#include <unordered_map>
+#include <vector>
 
 #include "include/istio/mixerclient/client.h"
 #include "src/istio/mixerclient/attribute_compressor.h"
@@ -48,9 +51,53 @@ class MixerClientImpl : public MixerClient {
   void GetStatistics(Statistics* stat) const override;
 
  private:
+  // A check waiting for the in-flight remote check of an identical request.
+  struct Follower {
+    CheckContextSharedPtr context;
+    TransportCheckFunc transport;
+    CheckDoneFunc on_done;
+  };
+
+  // An in-flight remote check for policy cache misses with the same
+  // signature. The first miss sends the remote check, the others follow it.
+  struct PendingCheck {
+    utils::HashType signature;
+    std::vector<Follower> followers;
+  };
+  using PendingCheckSharedPtr = std::shared_ptr<PendingCheck>;
+
   void RemoteCheck(CheckContextSharedPtr context,
                    const TransportCheckFunc& transport,
-                   const CheckDoneFunc& on_done);
+                   const CheckDoneFunc& on_done,
+                   const PendingCheckSharedPtr& pending);
+
+  // Sends the remote check of a policy cache miss.
+  void SendRemoteCheck(CheckContextSharedPtr& context,
+                       const TransportCheckFunc& transport,
+                       const CheckDoneFunc& on_done,
+                       const PendingCheckSharedPtr& pending);
+
+  // Refreshes the policy cache hit of the context in the background.
+  void RefreshPolicyCache(CheckContextSharedPtr& context,
+                          const TransportCheckFunc& transport);
+
+  // Returns true if the context follows the in-flight check with the same
+  // signature. Otherwise registers a new in-flight check in leader.
+  bool FollowPendingCheck(utils::HashType signature,
+                          CheckContextSharedPtr& context,
+                          const TransportCheckFunc& transport,
+                          const CheckDoneFunc& on_done,
+                          PendingCheckSharedPtr* leader);
+
+  // Unregisters the in-flight check and returns its followers.
+  std::vector<Follower> TakeFollowers(const PendingCheckSharedPtr& pending);
+
+  // Completes the followers with the transport status of the leader.
+  void CompletePendingCheck(const PendingCheckSharedPtr& pending,
+                            const ::google::protobuf::util::Status& status);
+
+  // The leader was cancelled, the followers send their own remote checks.
+  void ReleasePendingCheck(const PendingCheckSharedPtr& pending);
 
   uint32_t RetryDelay(uint32_t retry_attempt);
 
@@ -69,6 +116,11 @@ class MixerClientImpl : public MixerClient {
   // Cache for Quota call.
   std::unique_ptr<QuotaCache> quota_cache_;
 
+  // In-flight remote checks keyed by the policy cache signature. The client
+  // is per worker, and checks and their transport callbacks run on that
+  // worker, so no lock is needed.
+  std::unordered_map<utils::HashType, PendingCheckSharedPtr> pending_checks_;
+
   // RNG for retry jitter
   std::default_random_engine rand_;
 
@@ -81,20 +133,23 @@ class MixerClientImpl : public MixerClient {
   //
   // total_check_calls = total_check_hits + total_check_misses
   // total_check_hits = total_check_hit_accepts + total_check_hit_denies
-  // total_remote_check_calls = total_check_misses
+  // total_remote_check_calls <= total_check_misses +
+  // total_remote_check_refresh_calls
+  //    ^ concurrent identical misses share one remote check
   // total_remote_check_calls >= total_remote_check_accepts +
   // total_remote_check_denies
   //    ^ Transport errors are responsible for the >=
   //
 
-  std::atomic<uint64_t> total_check_calls_{0};              // 1.0
-  std::atomic<uint64_t> total_check_cache_hits_{0};         // 1.1
-  std::atomic<uint64_t> total_check_cache_misses_{0};       // 1.1
-  std::atomic<uint64_t> total_check_cache_hit_accepts_{0};  // 1.1
-  std::atomic<uint64_t> total_check_cache_hit_denies_{0};   // 1.1
-  std::atomic<uint64_t> total_remote_check_calls_{0};       // 1.0
-  std::atomic<uint64_t> total_remote_check_accepts_{0};     // 1.1
-  std::atomic<uint64_t> total_remote_check_denies_{0};      // 1.1
+  std::atomic<uint64_t> total_check_calls_{0};                 // 1.0
+  std::atomic<uint64_t> total_check_cache_hits_{0};            // 1.1
+  std::atomic<uint64_t> total_check_cache_misses_{0};          // 1.1
+  std::atomic<uint64_t> total_check_cache_hit_accepts_{0};     // 1.1
+  std::atomic<uint64_t> total_check_cache_hit_denies_{0};      // 1.1
+  std::atomic<uint64_t> total_remote_check_calls_{0};          // 1.0
+  std::atomic<uint64_t> total_remote_check_accepts_{0};        // 1.1
+  std::atomic<uint64_t> total_remote_check_denies_{0};         // 1.1
+  std::atomic<uint64_t> total_remote_check_refresh_calls_{0};  // 1.1
 
   //
   // Quota check counters
@@ -13,11 +13,15 @@
  * limitations under the License.
  */
 
+#include <deque>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "include/istio/mixerclient/check_response.h"
 #include "include/istio/mixerclient/client.h"
 #include "include/istio/utils/attributes_builder.h"
+#include "include/istio/utils/protobuf.h"
 #include "src/istio/mixerclient/status_test_util.h"
 #include "src/istio/utils/logger.h"
 
@@ -58,12 +62,14 @@ class MixerClientImplTest : public ::testing::Test {
   }
 
  protected:
-  void CreateClient(bool check_cache, bool quota_cache) {
+  void CreateClient(bool check_cache, bool quota_cache,
+                    uint32_t refresh_ahead_ms = 0) {
     MixerClientOptions options(CheckOptions(check_cache ? 1 : 0 /*entries */),
                                ReportOptions(1, 1000),
                                QuotaOptions(quota_cache ? 1 : 0 /* entries */,
                                             600000 /* expiration_ms */));
     options.check_options.network_fail_open = false;
+    options.check_options.refresh_ahead_ms = refresh_ahead_ms;
     options.env.check_transport = mock_check_transport_.GetFunc();
     client_ = CreateMixerClient(options);
   }
@@ -128,9 +134,9 @@ class MixerClientImplTest : public ::testing::Test {
                   stats.total_remote_call_other_errors_);
   }
 
-  CheckContextSharedPtr CreateContext(int quota_request) {
+  CheckContextSharedPtr CreateContext(int quota_request,
+                                      bool fail_open = false) {
     uint32_t retries{0};
-    bool fail_open{false};
     istio::mixerclient::SharedAttributesSharedPtr attributes{
         new SharedAttributes()};
     istio::mixerclient::CheckContextSharedPtr context{
@@ -141,7 +147,71 @@ class MixerClientImplTest : public ::testing::Test {
     return context;
   }
 
+  // Sends a check whose response expires immediately, so that later checks
+  // miss the policy cache with a known signature.
+  void SeedReferencedAttributes() {
+    EXPECT_CALL(mock_check_transport_, Check(_, _, _))
+        .WillOnce(Invoke([](const CheckRequest& request,
+                            CheckResponse* response, DoneFunc on_done) {
+          response->mutable_precondition()->set_valid_use_count(0);
+          on_done(Status::OK);
+        }))
+        .RetiresOnSaturation();
+    CheckContextSharedPtr context = CreateContext(0);
+    client_->Check(context, empty_transport_,
+                   [](const CheckResponseInfo& info) {});
+  }
+
+  // Caches an OK response valid for a minute, and returns the status of a
+  // check hitting it.
+  Status CacheResponseValidForAMinute() {
+    EXPECT_CALL(mock_check_transport_, Check(_, _, _))
+        .WillOnce(Invoke([](const CheckRequest& request,
+                            CheckResponse* response, DoneFunc on_done) {
+          response->mutable_precondition()->set_valid_use_count(1000);
+          *response->mutable_precondition()->mutable_valid_duration() =
+              utils::CreateDuration(std::chrono::minutes(1));
+          on_done(Status::OK);
+        }))
+        .RetiresOnSaturation();
+    CheckContextSharedPtr context = CreateContext(0);
+    Status status;
+    client_->Check(
+        context, empty_transport_,
+        [&status](const CheckResponseInfo& info) { status = info.status(); });
+    return status;
+  }
+
+  // Sends count identical checks at once. The remote checks complete when
+  // their DoneFuncs in remote_done_ are called.
+  void CheckConcurrently(int count, bool fail_open,
+                         const TransportCheckFunc& transport) {
+    for (int i = 0; i < count; i++) {
+      contexts_.push_back(CreateContext(0, fail_open));
+      statuses_.push_back(Status::UNKNOWN);
+      Status* status = &statuses_.back();
+      client_->Check(contexts_.back(), transport,
+                     [status](const CheckResponseInfo& info) {
+                       *status = info.status();
+                     });
+    }
+  }
+
+  // Remote checks that complete later.
+  TransportCheckFunc DeferredTransport() {
+    return [this](const CheckRequest& request, CheckResponse* response,
+                  DoneFunc on_done) -> CancelFunc {
+      response->mutable_precondition()->set_valid_use_count(1000);
+      remote_done_.push_back(on_done);
+      return [this]() { ++remote_cancels_; };
+    };
+  }
+
   std::unique_ptr<MixerClient> client_;
+  std::vector<CheckContextSharedPtr> contexts_;
+  std::deque<Status> statuses_;
+  std::vector<DoneFunc> remote_done_;
+  int remote_cancels_{0};
   MockCheckTransport mock_check_transport_;
   TransportCheckFunc empty_transport_;
 };
@@ -564,6 +634,176 @@ TEST_F(MixerClientImplTest, TestUnavailableQuotaBackend) {
   }
 }
 
+TEST_F(MixerClientImplTest, TestCoalesceIdenticalChecks) {
+  SeedReferencedAttributes();
+  CheckConcurrently(5, false, DeferredTransport());
+
+  // Only the first miss is sent, the others wait for its response.
+  ASSERT_EQ(remote_done_.size(), 1);
+  for (const auto& status : statuses_) {
+    EXPECT_ERROR_CODE(Code::UNKNOWN, status);
+  }
+
+  // A cancelled follower is not completed.
+  contexts_[4]->cancel();
+  remote_done_[0](Status::OK);
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_ERROR_CODE(Code::OK, statuses_[i]);
+  }
+  EXPECT_ERROR_CODE(Code::UNKNOWN, statuses_[4]);
+  EXPECT_EQ(remote_done_.size(), 1);
+  EXPECT_EQ(remote_cancels_, 0);
+
+  Statistics stat;
+  client_->GetStatistics(&stat);
+  EXPECT_EQ(stat.total_check_calls_, 6);
+  EXPECT_EQ(stat.total_check_cache_misses_, 6);
+  EXPECT_EQ(stat.total_remote_check_calls_, 2);
+  EXPECT_EQ(stat.total_remote_calls_, 2);
+  EXPECT_EQ(stat.total_remote_call_successes_, 2);
+
+  // The shared response is cached for later checks.
+  CheckConcurrently(1, false, DeferredTransport());
+  EXPECT_EQ(remote_done_.size(), 1);
+  EXPECT_ERROR_CODE(Code::OK, statuses_.back());
+}
+
+TEST_F(MixerClientImplTest, TestCoalescedCheckTimeout) {
+  SeedReferencedAttributes();
+  CheckConcurrently(3, false, DeferredTransport());
+  ASSERT_EQ(remote_done_.size(), 1);
+
+  remote_done_[0](Status(Code::UNAVAILABLE, "upstream request timeout"));
+  for (const auto& status : statuses_) {
+    EXPECT_ERROR_CODE(Code::UNAVAILABLE, status);
+  }
+
+  Statistics stat;
+  client_->GetStatistics(&stat);
+  EXPECT_EQ(stat.total_remote_check_calls_, 2);
+  EXPECT_EQ(stat.total_remote_call_timeouts_, 1);
+
+  // The failure is not cached, the next check is sent.
+  CheckConcurrently(1, false, DeferredTransport());
+  EXPECT_EQ(remote_done_.size(), 2);
+}
+
+TEST_F(MixerClientImplTest, TestCoalescedCheckFailOpen) {
+  SeedReferencedAttributes();
+  CheckConcurrently(3, true, DeferredTransport());
+  ASSERT_EQ(remote_done_.size(), 1);
+
+  remote_done_[0](Status(Code::INTERNAL, "failure"));
+  for (const auto& status : statuses_) {
+    EXPECT_ERROR_CODE(Code::OK, status);
+  }
+
+  Statistics stat;
+  client_->GetStatistics(&stat);
+  EXPECT_EQ(stat.total_remote_check_calls_, 2);
+  EXPECT_EQ(stat.total_remote_call_other_errors_, 1);
+}
+
+TEST_F(MixerClientImplTest, TestCancelCoalescedCheckLeader) {
+  SeedReferencedAttributes();
+  CheckConcurrently(3, false, DeferredTransport());
+  ASSERT_EQ(remote_done_.size(), 1);
+
+  // The followers send their own checks when the leader is cancelled.
+  contexts_[0]->cancel();
+  EXPECT_EQ(remote_cancels_, 1);
+  ASSERT_EQ(remote_done_.size(), 3);
+
+  remote_done_[1](Status::OK);
+  remote_done_[2](Status(Code::INTERNAL, "failure"));
+  EXPECT_ERROR_CODE(Code::UNKNOWN, statuses_[0]);
+  EXPECT_ERROR_CODE(Code::OK, statuses_[1]);
+  EXPECT_ERROR_CODE(Code::INTERNAL, statuses_[2]);
+
+  Statistics stat;
+  client_->GetStatistics(&stat);
+  EXPECT_EQ(stat.total_remote_check_calls_, 4);
+  EXPECT_EQ(stat.total_remote_call_cancellations_, 1);
+}
+
+TEST_F(MixerClientImplTest, TestNotCoalesceWithQuota) {
+  SeedReferencedAttributes();
+  for (int i = 0; i < 3; i++) {
+    CheckContextSharedPtr context = CreateContext(1);
+    client_->Check(context, DeferredTransport(),
+                   [](const CheckResponseInfo& info) {});
+  }
+  EXPECT_EQ(remote_done_.size(), 3);
+}
+
+TEST_F(MixerClientImplTest, TestRefreshAheadInBackground) {
+  // Any hit on a response valid for a minute is close to its expiration.
+  CreateClient(true, true, 120000 /* refresh_ahead_ms */);
+  EXPECT_OK(CacheResponseValidForAMinute());
+
+  // The hit is used while it is refreshed.
+  TransportCheckFunc deny_transport = [this](const CheckRequest& request,
+                                             CheckResponse* response,
+                                             DoneFunc on_done) -> CancelFunc {
+    response->mutable_precondition()->set_valid_use_count(1000);
+    response->mutable_precondition()->mutable_status()->set_code(
+        Code::PERMISSION_DENIED);
+    remote_done_.push_back(on_done);
+    return nullptr;
+  };
+  CheckConcurrently(2, false, deny_transport);
+  EXPECT_TRUE(contexts_[0]->policyCacheHit());
+  EXPECT_TRUE(contexts_[0]->policyCacheRefreshRequired());
+  EXPECT_ERROR_CODE(Code::OK, statuses_[0]);
+  EXPECT_TRUE(contexts_[1]->policyCacheHit());
+  EXPECT_FALSE(contexts_[1]->policyCacheRefreshRequired());
+  EXPECT_ERROR_CODE(Code::OK, statuses_[1]);
+  ASSERT_EQ(remote_done_.size(), 1);
+
+  // Later checks use the refreshed response.
+  remote_done_[0](Status::OK);
+  CheckConcurrently(1, false, deny_transport);
+  EXPECT_ERROR_CODE(Code::PERMISSION_DENIED, statuses_[2]);
+  EXPECT_EQ(remote_done_.size(), 1);
+
+  Statistics stat;
+  client_->GetStatistics(&stat);
+  EXPECT_EQ(stat.total_check_calls_, 4);
+  EXPECT_EQ(stat.total_check_cache_hits_, 3);
+  EXPECT_EQ(stat.total_remote_check_calls_, 2);
+  EXPECT_EQ(stat.total_remote_check_refresh_calls_, 1);
+  EXPECT_EQ(stat.total_remote_check_denies_, 1);
+}
+
+TEST_F(MixerClientImplTest, TestFailedRefreshKeepsCachedResult) {
+  CreateClient(true, true, 120000 /* refresh_ahead_ms */);
+  EXPECT_OK(CacheResponseValidForAMinute());
+
+  CheckConcurrently(1, false, DeferredTransport());
+  EXPECT_ERROR_CODE(Code::OK, statuses_[0]);
+  ASSERT_EQ(remote_done_.size(), 1);
+
+  // A failed refresh neither changes the cached result nor applies
+  // network_fail_open to it.
+  remote_done_[0](Status(Code::UNAVAILABLE, "upstream request timeout"));
+  CheckConcurrently(1, false, DeferredTransport());
+  EXPECT_ERROR_CODE(Code::OK, statuses_[1]);
+  EXPECT_EQ(remote_done_.size(), 1);
+
+  Statistics stat;
+  client_->GetStatistics(&stat);
+  EXPECT_EQ(stat.total_remote_check_refresh_calls_, 1);
+  EXPECT_EQ(stat.total_remote_call_timeouts_, 1);
+}
+
+TEST_F(MixerClientImplTest, TestNoRefreshAheadByDefault) {
+  EXPECT_OK(CacheResponseValidForAMinute());
+  CheckConcurrently(2, false, DeferredTransport());
+  EXPECT_ERROR_CODE(Code::OK, statuses_[0]);
+  EXPECT_ERROR_CODE(Code::OK, statuses_[1]);
+  EXPECT_EQ(remote_done_.size(), 0);
+}
+
 }  // namespace
 }  // namespace mixerclient
 }  // namespace istio
@@ -0,0 +1,63 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/istio/utils/allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef TCMALLOC
+#include "gperftools/malloc_hook.h"
+#endif
+
+namespace istio {
+namespace utils {
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+
+#ifdef TCMALLOC
+void CountAllocation(const void*, size_t) { allocations++; }
+#endif
+
+}  // namespace
+
+uint64_t AllocationCount() {
+#ifdef TCMALLOC
+  // tcmalloc owns operator new, so allocations are counted by its hook.
+  static const bool hooked = MallocHook::AddNewHook(&CountAllocation);
+  (void)hooked;
+#endif
+  return allocations;
+}
+
+}  // namespace utils
+}  // namespace istio
+
+#ifndef TCMALLOC
+// Without tcmalloc, operator new is replaced instead. This only affects the
+// test binaries that depend on this library.
+void* operator new(size_t size) {
+  istio::utils::allocations++;
+  void* p = std::malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+#endif
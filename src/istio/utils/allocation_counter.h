@@ -0,0 +1,29 @@
+/* Copyright 2019 Istio Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace istio {
+namespace utils {
+
+// Returns the number of heap allocations made so far. Tests and benchmarks
+// take the difference around the code they measure. Under tcmalloc only
+// allocations made after the first call are counted.
+uint64_t AllocationCount();
+
+}  // namespace utils
+}  // namespace istio